@@ -0,0 +1,438 @@
+/*
+csvBenchmark/main.cpp
+---------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+/* Usage: csvBenchmark [--rows N] [--columns N] [--quotes RATE] [--newlines RATE] [--seed N] [--repeat N]
+ *                     [--keep] [--output results.json]
+ *
+ * Generates a CSV file with CRandomizer, then reads it with CSV::parseFromFile(), QCsv in LineByLine mode,
+ * and QCsv in EntireFile mode.  Rows per second, MB per second, and peak resident memory are reported for
+ * each as JSON, to the output file if one is given or to stdout otherwise.
+ *
+ * - The same seed always generates the same file, so results from different builds can be compared.
+ * - --quotes is the proportion of text fields that are quoted because they contain a delimiter or a
+ *   quotation mark.  --newlines is the proportion of text fields that contain a line break (and so are
+ *   quoted as well).
+ * - Each run is made in a separate process, so that peak memory use isn't inflated by an earlier run.
+ *   Peak memory is reported in KB where the platform allows it, and as null otherwise.
+ */
+
+#include <QtCore>
+
+#if defined( Q_OS_UNIX ) && !defined( Q_OS_LINUX )
+  #include <sys/resource.h>
+#endif
+
+#include <ar_general_purpose/crandomizer.h>
+#include <ar_general_purpose/csv.h>
+#include <ar_general_purpose/csvrowbuffer.h>
+#include <ar_general_purpose/qcout.h>
+
+struct DataSettings {
+  int nRows;
+  int nColumns;
+  double quoteRate;
+  double newlineRate;
+  quint32 seed;
+};
+
+
+struct RunResult {
+  bool ok;
+  qint64 nRows;
+  qint64 msecs;
+  qint64 peakRssKb; // -1 if unknown
+  qint64 checksum; // Keeps the compiler from discarding the work
+};
+
+
+// Peak resident set size of this process, in KB
+static qint64 peakRssKb() {
+#if defined( Q_OS_LINUX )
+  QFile file( QStringLiteral( "/proc/self/status" ) );
+  if( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    return -1;
+
+  while( !file.atEnd() ) {
+    const QByteArray line = file.readLine();
+    if( line.startsWith( "VmHWM:" ) ) {
+      bool ok;
+      const qint64 result = line.mid( 6 ).trimmed().split( ' ' ).first().toLongLong( &ok );
+      return ( ok ? result : -1 );
+    }
+  }
+
+  return -1;
+#elif defined( Q_OS_UNIX )
+  struct rusage usage;
+  if( 0 != getrusage( RUSAGE_SELF, &usage ) )
+    return -1;
+
+  #if defined( Q_OS_DARWIN )
+    return qint64( usage.ru_maxrss ) / 1024; // Bytes
+  #else
+    return qint64( usage.ru_maxrss ); // KB
+  #endif
+#else
+  return -1;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// Data generation
+//-----------------------------------------------------------------------------
+static bool happens( CRandomizer& rand, const double rate ) {
+  return ( rand.randInt( 1000000 ) < int( rate * 1000000.0 ) );
+}
+
+
+static QByteArray textField( CRandomizer& rand, const QString& text, const DataSettings& settings ) {
+  QByteArray result = text.toUtf8();
+  bool mustQuote = false;
+
+  if( happens( rand, settings.quoteRate ) ) {
+    // Half of the quoted fields contain a delimiter, and half contain quotation marks.
+    if( 0 == rand.randInt( 2 ) )
+      result.append( ", " ).append( rand.color().toUtf8() );
+    else
+      result.prepend( "\"\"" ).append( "\"\"" );
+
+    mustQuote = true;
+  }
+
+  if( happens( rand, settings.newlineRate ) ) {
+    result.append( '\n' ).append( rand.food().toUtf8() );
+    mustQuote = true;
+  }
+
+  if( mustQuote )
+    result.prepend( '"' ).append( '"' );
+
+  return result;
+}
+
+
+static QByteArray generateField( CRandomizer& rand, const int column, const DataSettings& settings ) {
+  switch( column % 6 ) {
+    case 0: return QByteArray::number( rand.rantInt( 0, 1000000 ) );
+    case 1: return QByteArray::number( rand.randInt( 1000000 ) / 100.0, 'f', 2 );
+    case 2: return QDate( 2026, 1, 1 ).addDays( rand.randInt( 365 ) ).toString( Qt::ISODate ).toLatin1();
+    case 3: return textField( rand, rand.usCity(), settings );
+    case 4: return rand.alphanumeric( 8 ).toLatin1();
+    default: return textField( rand, rand.country(), settings );
+  }
+}
+
+
+static bool generateFile( const QString& fileName, const DataSettings& settings ) {
+  QFile file( fileName );
+  if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    return false;
+
+  CRandomizer rand( settings.seed );
+  QByteArray line;
+
+  for( int c = 0; c < settings.nColumns; ++c ) {
+    if( 0 < c )
+      line.append( ',' );
+    line.append( "field" ).append( QByteArray::number( c + 1 ) );
+  }
+  line.append( '\n' );
+
+  if( -1 == file.write( line ) )
+    return false;
+
+  for( int r = 0; r < settings.nRows; ++r ) {
+    line.resize( 0 );
+
+    for( int c = 0; c < settings.nColumns; ++c ) {
+      if( 0 < c )
+        line.append( ',' );
+      line.append( generateField( rand, c, settings ) );
+    }
+    line.append( '\n' );
+
+    if( -1 == file.write( line ) )
+      return false;
+  }
+
+  return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Scenarios
+//-----------------------------------------------------------------------------
+static RunResult runParseFromFile( const QString& fileName ) {
+  RunResult result = { false, 0, 0, -1, 0 };
+  QElapsedTimer timer;
+  timer.start();
+
+  const QList<QStringList> rows = CSV::parseFromFile( fileName, ',', QStringLiteral( "UTF-8" ) );
+
+  for( int r = 1; r < rows.count(); ++r ) { // Row 0 is the field list
+    const QStringList& row = rows.at(r);
+    for( int i = 0; i < row.count(); ++i )
+      result.checksum = result.checksum + row.at(i).length();
+    ++result.nRows;
+  }
+
+  result.msecs = timer.elapsed();
+  result.ok = !rows.isEmpty();
+
+  return result;
+}
+
+
+static RunResult runQCsv( const QString& fileName, const QCsv::QCsvMode mode ) {
+  RunResult result = { false, 0, 0, -1, 0 };
+  QElapsedTimer timer;
+  timer.start();
+
+  QCsv csv;
+  csv.setFilename( fileName );
+  csv.setContainsFieldList( true );
+  csv.setStringsContainDelimiters( true );
+  csv.setMode( mode );
+
+  if( !csv.open() ) {
+    cerr << "Could not open " << fileName << ": " << csv.errorMsg() << endl;
+    return result;
+  }
+
+  QCsvRowBuffer row;
+
+  while( -1 != csv.moveNext( row ) ) {
+    for( int i = 0; i < row.count(); ++i )
+      result.checksum = result.checksum + row.at(i).length();
+    ++result.nRows;
+  }
+
+  result.msecs = timer.elapsed();
+  result.ok = ( QCsv::ERROR_NONE == csv.error() );
+
+  return result;
+}
+
+
+static QStringList scenarios() {
+  return QStringList()
+    << QStringLiteral( "CSV::parseFromFile" )
+    << QStringLiteral( "QCsv LineByLine" )
+    << QStringLiteral( "QCsv EntireFile" )
+  ;
+}
+
+
+static RunResult runScenario( const QString& scenario, const QString& fileName ) {
+  RunResult result;
+
+  if( QStringLiteral( "CSV::parseFromFile" ) == scenario )
+    result = runParseFromFile( fileName );
+  else if( QStringLiteral( "QCsv LineByLine" ) == scenario )
+    result = runQCsv( fileName, QCsv::LineByLine );
+  else if( QStringLiteral( "QCsv EntireFile" ) == scenario )
+    result = runQCsv( fileName, QCsv::EntireFile );
+  else {
+    RunResult unknown = { false, 0, 0, -1, 0 };
+    result = unknown;
+  }
+
+  result.peakRssKb = peakRssKb();
+
+  return result;
+}
+
+
+// Runs one scenario in a child process (this program, with --run), so that each has its own peak memory use.
+static RunResult runInChild( const QString& scenario, const QString& fileName ) {
+  RunResult result = { false, 0, 0, -1, 0 };
+
+  QProcess process;
+  process.setProcessChannelMode( QProcess::ForwardedErrorChannel );
+  process.start( QCoreApplication::applicationFilePath(), QStringList() << QStringLiteral( "--run" ) << scenario << fileName );
+
+  if( !process.waitForFinished( -1 ) || ( QProcess::NormalExit != process.exitStatus() ) || ( 0 != process.exitCode() ) )
+    return result;
+
+  const QJsonObject obj = QJsonDocument::fromJson( process.readAllStandardOutput() ).object();
+
+  result.ok = obj.value( QStringLiteral( "ok" ) ).toBool();
+  result.nRows = qint64( obj.value( QStringLiteral( "rows" ) ).toDouble() );
+  result.msecs = qint64( obj.value( QStringLiteral( "msecs" ) ).toDouble() );
+  result.peakRssKb = qint64( obj.value( QStringLiteral( "peakRssKb" ) ).toDouble( -1 ) );
+  result.checksum = qint64( obj.value( QStringLiteral( "checksum" ) ).toDouble() );
+
+  return result;
+}
+
+
+//-----------------------------------------------------------------------------
+// Reporting
+//-----------------------------------------------------------------------------
+static QJsonObject scenarioResults( const QString& scenario, const QList<RunResult>& runs, const qint64 fileSize ) {
+  QJsonObject obj;
+  QJsonArray runTimes;
+  bool ok = !runs.isEmpty();
+  qint64 bestMsecs = -1;
+  qint64 maxRss = -1;
+  qint64 nRows = 0;
+  qint64 checksum = 0;
+
+  for( int i = 0; i < runs.count(); ++i ) {
+    const RunResult& run = runs.at(i);
+    ok = ok && run.ok;
+    runTimes.append( double( run.msecs ) );
+
+    if( ( -1 == bestMsecs ) || ( run.msecs < bestMsecs ) )
+      bestMsecs = run.msecs;
+
+    maxRss = qMax( maxRss, run.peakRssKb );
+    nRows = run.nRows;
+    checksum = run.checksum;
+  }
+
+  // Very fast runs are reported as taking a millisecond, rather than an infinite rate.
+  const double seconds = double( qMax( qint64( 1 ), bestMsecs ) ) / 1000.0;
+
+  obj.insert( QStringLiteral( "scenario" ), scenario );
+  obj.insert( QStringLiteral( "ok" ), ok );
+  obj.insert( QStringLiteral( "rows" ), double( nRows ) );
+  obj.insert( QStringLiteral( "msecs" ), runTimes );
+  obj.insert( QStringLiteral( "bestMsecs" ), double( bestMsecs ) );
+  obj.insert( QStringLiteral( "rowsPerSec" ), ok ? QJsonValue( double( nRows ) / seconds ) : QJsonValue() );
+  obj.insert( QStringLiteral( "mbPerSec" ), ok ? QJsonValue( double( fileSize ) / ( 1024.0 * 1024.0 ) / seconds ) : QJsonValue() );
+  obj.insert( QStringLiteral( "peakRssKb" ), ( -1 == maxRss ) ? QJsonValue() : QJsonValue( double( maxRss ) ) );
+  obj.insert( QStringLiteral( "checksum" ), double( checksum ) );
+
+  return obj;
+}
+
+
+static QString argumentValue( const QStringList& args, const QString& name, const QString& defaultValue ) {
+  const int idx = args.indexOf( name );
+
+  if( ( -1 == idx ) || ( idx + 1 >= args.count() ) )
+    return defaultValue;
+  else
+    return args.at( idx + 1 );
+}
+
+
+int main( int argc, char* argv[] ) {
+  QCoreApplication app( argc, argv );
+  const QStringList args = app.arguments();
+
+  // A single run, made by the parent process
+  if( ( 4 == args.count() ) && ( QStringLiteral( "--run" ) == args.at(1) ) ) {
+    const RunResult result = runScenario( args.at(2), args.at(3) );
+
+    QJsonObject obj;
+    obj.insert( QStringLiteral( "ok" ), result.ok );
+    obj.insert( QStringLiteral( "rows" ), double( result.nRows ) );
+    obj.insert( QStringLiteral( "msecs" ), double( result.msecs ) );
+    obj.insert( QStringLiteral( "peakRssKb" ), double( result.peakRssKb ) );
+    obj.insert( QStringLiteral( "checksum" ), double( result.checksum ) );
+
+    cout << QString::fromUtf8( QJsonDocument( obj ).toJson( QJsonDocument::Compact ) ) << endl;
+
+    return ( result.ok ? 0 : 1 );
+  }
+
+  DataSettings settings;
+  settings.nRows = argumentValue( args, QStringLiteral( "--rows" ), QStringLiteral( "500000" ) ).toInt();
+  settings.nColumns = qMax( 1, argumentValue( args, QStringLiteral( "--columns" ), QStringLiteral( "12" ) ).toInt() );
+  settings.quoteRate = qBound( 0.0, argumentValue( args, QStringLiteral( "--quotes" ), QStringLiteral( "0.05" ) ).toDouble(), 1.0 );
+  settings.newlineRate = qBound( 0.0, argumentValue( args, QStringLiteral( "--newlines" ), QStringLiteral( "0.001" ) ).toDouble(), 1.0 );
+  settings.seed = argumentValue( args, QStringLiteral( "--seed" ), QStringLiteral( "20261017" ) ).toUInt();
+
+  const int nRepeats = qMax( 1, argumentValue( args, QStringLiteral( "--repeat" ), QStringLiteral( "3" ) ).toInt() );
+  const QString outputFileName = argumentValue( args, QStringLiteral( "--output" ), QString() );
+  const bool keepFile = args.contains( QStringLiteral( "--keep" ) );
+
+  // CRandomizer treats a seed of 0 as "use the clock", which wouldn't be reproducible.
+  if( 0 == settings.seed )
+    settings.seed = 1;
+
+  const QString fileName = QDir::temp().filePath(
+    QStringLiteral( "csvBenchmark-%1-%2x%3.csv" ).arg( settings.seed ).arg( settings.nRows ).arg( settings.nColumns )
+  );
+
+  cerr << "Writing " << settings.nRows << " rows of " << settings.nColumns << " fields to " << fileName << endl;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  if( !generateFile( fileName, settings ) ) {
+    cerr << "Could not write " << fileName << endl;
+    return 1;
+  }
+
+  const qint64 generateMsecs = timer.elapsed();
+  const qint64 fileSize = QFileInfo( fileName ).size();
+
+  QJsonArray results;
+  const QStringList list = scenarios();
+
+  for( int i = 0; i < list.count(); ++i ) {
+    QList<RunResult> runs;
+
+    for( int j = 0; j < nRepeats; ++j ) {
+      cerr << "Running " << list.at(i) << " (" << ( j + 1 ) << " of " << nRepeats << ")" << endl;
+      runs.append( runInChild( list.at(i), fileName ) );
+    }
+
+    results.append( scenarioResults( list.at(i), runs, fileSize ) );
+  }
+
+  if( !keepFile )
+    QFile::remove( fileName );
+
+  QJsonObject data;
+  data.insert( QStringLiteral( "rows" ), settings.nRows );
+  data.insert( QStringLiteral( "columns" ), settings.nColumns );
+  data.insert( QStringLiteral( "quoteRate" ), settings.quoteRate );
+  data.insert( QStringLiteral( "newlineRate" ), settings.newlineRate );
+  data.insert( QStringLiteral( "seed" ), double( settings.seed ) );
+  data.insert( QStringLiteral( "bytes" ), double( fileSize ) );
+  data.insert( QStringLiteral( "generateMsecs" ), double( generateMsecs ) );
+
+  QJsonObject system;
+  system.insert( QStringLiteral( "qtVersion" ), QString::fromLatin1( qVersion() ) );
+  system.insert( QStringLiteral( "os" ), QSysInfo::prettyProductName() );
+  system.insert( QStringLiteral( "cpuArchitecture" ), QSysInfo::currentCpuArchitecture() );
+  system.insert( QStringLiteral( "idealThreadCount" ), QThread::idealThreadCount() );
+
+  QJsonObject report;
+  report.insert( QStringLiteral( "benchmark" ), QStringLiteral( "csvBenchmark" ) );
+  report.insert( QStringLiteral( "timestamp" ), QDateTime::currentDateTimeUtc().toString( Qt::ISODate ) );
+  report.insert( QStringLiteral( "repeat" ), nRepeats );
+  report.insert( QStringLiteral( "system" ), system );
+  report.insert( QStringLiteral( "data" ), data );
+  report.insert( QStringLiteral( "results" ), results );
+
+  const QByteArray json = QJsonDocument( report ).toJson( QJsonDocument::Indented );
+
+  if( outputFileName.isEmpty() ) {
+    cout << QString::fromUtf8( json ) << flush;
+  }
+  else {
+    QFile file( outputFileName );
+    if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) || ( -1 == file.write( json ) ) ) {
+      cerr << "Could not write " << outputFileName << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
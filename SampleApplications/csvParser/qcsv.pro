@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent
 
 CONFIG += console
 
@@ -20,11 +20,27 @@ SOURCES += \
   main.cpp \
   mainwindow.cpp \
     ../../../ar_general_purpose/csv.cpp \
+    ../../../ar_general_purpose/csvcache.cpp \
+    ../../../ar_general_purpose/csvcolumnstore.cpp \
+    ../../../ar_general_purpose/csvdialect.cpp \
+    ../../../ar_general_purpose/csvrowbuffer.cpp \
+    ../../../ar_general_purpose/csvrowindex.cpp \
+    ../../../ar_general_purpose/csvsidecar.cpp \
+    ../../../ar_general_purpose/csvwriter.cpp \
+    ../../../ar_general_purpose/compressedio.cpp \
     ../../../ar_general_purpose/strutils.cpp
 
 HEADERS  += \
   mainwindow.h \
     ../../../ar_general_purpose/csv.h \
+    ../../../ar_general_purpose/csvcache.h \
+    ../../../ar_general_purpose/csvcolumnstore.h \
+    ../../../ar_general_purpose/csvdialect.h \
+    ../../../ar_general_purpose/csvrowbuffer.h \
+    ../../../ar_general_purpose/csvrowindex.h \
+    ../../../ar_general_purpose/csvsidecar.h \
+    ../../../ar_general_purpose/csvwriter.h \
+    ../../../ar_general_purpose/compressedio.h \
     ../../../ar_general_purpose/strutils.h
 
 FORMS    += \
@@ -0,0 +1,45 @@
+#-------------------------------------------------
+#
+# Compares the cost of reading rows with QCsv::moveNext() and rowData()
+# to the cost of reading them with QCsv::moveNext( QCsvRowBuffer& ).
+#
+#-------------------------------------------------
+
+QT       += core concurrent
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = csvRowBuffer
+TEMPLATE = app
+
+INCLUDEPATH += \
+  ../../../
+
+SOURCES += \
+  main.cpp \
+    ../../../ar_general_purpose/csv.cpp \
+    ../../../ar_general_purpose/csvcache.cpp \
+    ../../../ar_general_purpose/csvcolumnstore.cpp \
+    ../../../ar_general_purpose/csvdialect.cpp \
+    ../../../ar_general_purpose/csvrowbuffer.cpp \
+    ../../../ar_general_purpose/csvrowindex.cpp \
+    ../../../ar_general_purpose/csvsidecar.cpp \
+    ../../../ar_general_purpose/csvwriter.cpp \
+    ../../../ar_general_purpose/compressedio.cpp \
+    ../../../ar_general_purpose/qcout.cpp \
+    ../../../ar_general_purpose/strutils.cpp
+
+HEADERS  += \
+    ../../../ar_general_purpose/csv.h \
+    ../../../ar_general_purpose/csvcache.h \
+    ../../../ar_general_purpose/csvcolumnstore.h \
+    ../../../ar_general_purpose/csvdialect.h \
+    ../../../ar_general_purpose/csvrowbuffer.h \
+    ../../../ar_general_purpose/csvrowindex.h \
+    ../../../ar_general_purpose/csvsidecar.h \
+    ../../../ar_general_purpose/csvwriter.h \
+    ../../../ar_general_purpose/compressedio.h \
+    ../../../ar_general_purpose/qcout.h \
+    ../../../ar_general_purpose/strutils.h
@@ -0,0 +1,202 @@
+/*
+csvRowBuffer/main.cpp
+---------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+/* Usage: csvRowBuffer [file.csv [nRows]]
+ *
+ * Reads a CSV file (by default, a generated one with a header and nRows rows) twice in each mode: once with
+ * moveNext() and rowData(), and once with moveNext( QCsvRowBuffer& ).  Reports the time taken and, where the
+ * C library allows it, the number of memory allocations per row.
+ */
+
+#include <cstdlib>
+
+#include <QtCore>
+
+#include <ar_general_purpose/csv.h>
+#include <ar_general_purpose/csvrowbuffer.h>
+#include <ar_general_purpose/qcout.h>
+
+// With glibc, every allocation (Qt's included) is counted by wrapping malloc() and friends.
+#if defined( __GLIBC__ )
+  #define COUNT_ALLOCATIONS
+
+  extern "C" {
+    void* __libc_malloc( size_t size );
+    void* __libc_calloc( size_t n, size_t size );
+    void* __libc_realloc( void* ptr, size_t size );
+    void __libc_free( void* ptr );
+  }
+
+  static QAtomicInteger<qint64> nAllocations( 0 );
+
+  extern "C" {
+    void* malloc( size_t size ) { nAllocations.ref(); return __libc_malloc( size ); }
+    void* calloc( size_t n, size_t size ) { nAllocations.ref(); return __libc_calloc( n, size ); }
+    void* realloc( void* ptr, size_t size ) { nAllocations.ref(); return __libc_realloc( ptr, size ); }
+    void free( void* ptr ) { __libc_free( ptr ); }
+  }
+
+  static qint64 allocationCount() { return nAllocations.load(); }
+#else
+  static qint64 allocationCount() { return 0; }
+#endif
+
+
+static bool writeTestFile( const QString& fileName, const int nRows ) {
+  QFile file( fileName );
+  if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    return false;
+
+  QTextStream stream( &file );
+  stream.setCodec( "UTF-8" );
+
+  stream << "id,name,herd,weight,date,status,notes\n";
+
+  for( int i = 0; i < nRows; ++i ) {
+    stream
+      << i << ','
+      << "animal" << ( i % 997 ) << ','
+      << "H" << ( i % 31 ) << ','
+      << ( 300.0 + ( i % 400 ) / 4.0 ) << ','
+      << "2026-" << ( 1 + ( i % 12 ) ) << '-' << ( 1 + ( i % 28 ) ) << ','
+      << ( 0 == ( i % 3 ) ? "active" : "sold" ) << ','
+      << ( 0 == ( i % 10 ) ? "\"weighed, then moved\"" : "none" )
+      << '\n'
+    ;
+  }
+
+  return ( QTextStream::Ok == stream.status() );
+}
+
+
+struct BenchResult {
+  qint64 nRows;
+  qint64 msecs;
+  qint64 allocations;
+  qint64 checksum; // Keeps the compiler from discarding the work
+};
+
+
+static bool openCsv( QCsv& csv, const QString& fileName, const QCsv::QCsvMode mode ) {
+  csv.setFilename( fileName );
+  csv.setContainsFieldList( true );
+  csv.setMode( mode );
+
+  if( !csv.open() ) {
+    cout << "Could not open " << fileName << ": " << csv.errorMsg() << endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+static BenchResult readWithRowData( const QString& fileName, const QCsv::QCsvMode mode ) {
+  BenchResult result = { 0, 0, 0, 0 };
+  QCsv csv;
+
+  if( !openCsv( csv, fileName, mode ) )
+    return result;
+
+  QElapsedTimer timer;
+  const qint64 startAllocations = allocationCount();
+  timer.start();
+
+  while( -1 != csv.moveNext() ) {
+    const QStringList row = csv.rowData();
+    for( int i = 0; i < row.count(); ++i )
+      result.checksum = result.checksum + row.at(i).length();
+    ++result.nRows;
+  }
+
+  result.msecs = timer.elapsed();
+  result.allocations = allocationCount() - startAllocations;
+
+  return result;
+}
+
+
+static BenchResult readWithRowBuffer( const QString& fileName, const QCsv::QCsvMode mode ) {
+  BenchResult result = { 0, 0, 0, 0 };
+  QCsv csv;
+
+  if( !openCsv( csv, fileName, mode ) )
+    return result;
+
+  QCsvRowBuffer row;
+  QElapsedTimer timer;
+  const qint64 startAllocations = allocationCount();
+  timer.start();
+
+  while( -1 != csv.moveNext( row ) ) {
+    for( int i = 0; i < row.count(); ++i )
+      result.checksum = result.checksum + row.at(i).length();
+    ++result.nRows;
+  }
+
+  result.msecs = timer.elapsed();
+  result.allocations = allocationCount() - startAllocations;
+
+  return result;
+}
+
+
+static void report( const QString& label, const BenchResult& result ) {
+  cout << label.leftJustified( 32 ) << result.nRows << " rows, " << result.msecs << " ms";
+
+#ifdef COUNT_ALLOCATIONS
+  const double perRow = ( 0 == result.nRows ? 0.0 : double( result.allocations ) / double( result.nRows ) );
+  cout << ", " << result.allocations << " allocations (" << QString::number( perRow, 'f', 2 ) << " per row)";
+#endif
+
+  cout << ", checksum " << result.checksum << endl;
+}
+
+
+int main( int argc, char* argv[] ) {
+  QCoreApplication app( argc, argv );
+
+  QString fileName;
+  int nRows = 1000000;
+
+  if( 1 < argc ) {
+    fileName = QString::fromLocal8Bit( argv[1] );
+    if( 2 < argc )
+      nRows = atoi( argv[2] );
+  }
+
+  if( fileName.isEmpty() || !QFileInfo::exists( fileName ) ) {
+    if( fileName.isEmpty() )
+      fileName = QDir::temp().filePath( QStringLiteral( "csvRowBuffer.csv" ) );
+
+    cout << "Writing " << nRows << " rows to " << fileName << endl;
+
+    if( !writeTestFile( fileName, nRows ) ) {
+      cout << "Could not write " << fileName << endl;
+      return 1;
+    }
+  }
+
+#ifndef COUNT_ALLOCATIONS
+  cout << "(Allocations are counted only with glibc)" << endl;
+#endif
+
+  report( QStringLiteral( "LineByLine, rowData():" ), readWithRowData( fileName, QCsv::LineByLine ) );
+  report( QStringLiteral( "LineByLine, QCsvRowBuffer:" ), readWithRowBuffer( fileName, QCsv::LineByLine ) );
+  report( QStringLiteral( "MemoryMapped, rowData():" ), readWithRowData( fileName, QCsv::MemoryMapped ) );
+  report( QStringLiteral( "MemoryMapped, QCsvRowBuffer:" ), readWithRowBuffer( fileName, QCsv::MemoryMapped ) );
+  report( QStringLiteral( "EntireFile, rowData():" ), readWithRowData( fileName, QCsv::EntireFile ) );
+  report( QStringLiteral( "EntireFile, QCsvRowBuffer:" ), readWithRowBuffer( fileName, QCsv::EntireFile ) );
+
+  return 0;
+}
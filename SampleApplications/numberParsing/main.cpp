@@ -0,0 +1,201 @@
+/*
+numberParsing/main.cpp
+----------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+/* Usage: numberParsing [nValues]
+ *
+ * Generates nValues numbers of several kinds (integers, decimals with a few places, decimals printed with
+ * full precision, scientific notation, and a few oddities) as text.  Each set is converted with
+ * QString::toLongLong() or QString::toDouble(), with fastStrToInt64() or fastStrToDouble(), and with
+ * bytesToInt64() or bytesToDouble() (see strutils.h).  Reports the time taken by each, and the number of
+ * results that differ from Qt's in any bit (which should always be 0).
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include <QtCore>
+
+#include <ar_general_purpose/qcout.h>
+#include <ar_general_purpose/strutils.h>
+
+struct TestSet {
+  QString name;
+  QStringList strings;
+  QList<QByteArray> bytes;
+};
+
+
+static void addValue( TestSet& set, const QString& str ) {
+  set.strings.append( str );
+  set.bytes.append( str.toLatin1() );
+}
+
+
+static QList<TestSet> generateSets( const int nValues ) {
+  QRandomGenerator rng( 20261017 );
+  QList<TestSet> result;
+
+  TestSet ints, decimals, precise, scientific, odd;
+  ints.name = QStringLiteral( "Integers" );
+  decimals.name = QStringLiteral( "Decimals (0-4 places)" );
+  precise.name = QStringLiteral( "Decimals (17 digits)" );
+  scientific.name = QStringLiteral( "Scientific notation" );
+  odd.name = QStringLiteral( "Oddities (left to Qt)" );
+
+  const QStringList oddities = QStringList()
+    << QStringLiteral( " 12" ) << QStringLiteral( "+3.5" ) << QStringLiteral( ".25" ) << QStringLiteral( "7." )
+    << QStringLiteral( "-0" ) << QStringLiteral( "inf" ) << QStringLiteral( "nan" ) << QStringLiteral( "1e400" )
+    << QStringLiteral( "12345678901234567890123" ) << QStringLiteral( "1,000" ) << QStringLiteral( "abc" ) << QString()
+  ;
+
+  for( int i = 0; i < nValues; ++i ) {
+    addValue( ints, QString::number( qint64( rng.generate64() >> ( rng.bounded( 64 ) ) ) - qint64( rng.bounded( 1000 ) ) ) );
+    addValue( decimals, QString::number( ( rng.generateDouble() - 0.5 ) * 200000.0, 'f', rng.bounded( 5 ) ) );
+    addValue( precise, QString::number( rng.generateDouble() * 1000.0, 'g', 17 ) );
+    addValue( scientific, QString::number( rng.generateDouble(), 'e', rng.bounded( 1, 12 ) ).replace( QStringLiteral( "e-01" ), QStringLiteral( "e-%1" ).arg( rng.bounded( 1, 30 ) ) ) );
+    addValue( odd, oddities.at( i % oddities.count() ) );
+  }
+
+  result << ints << decimals << precise << scientific << odd;
+
+  return result;
+}
+
+
+static bool identical( const double a, const double b ) {
+  return ( 0 == memcmp( &a, &b, sizeof( double ) ) );
+}
+
+
+static void report( const QString& label, const qint64 nsecs, const int nValues, const int nMismatches = -1 ) {
+  cout << "  " << label.leftJustified( 24 ) << QString::number( double( nsecs ) / double( qMax( 1, nValues ) ), 'f', 1 ).rightJustified( 8 ) << " ns per value";
+
+  if( -1 != nMismatches )
+    cout << ", " << nMismatches << " different from Qt";
+
+  cout << endl;
+}
+
+
+static void compareDoubles( const TestSet& set ) {
+  const int n = set.strings.count();
+  QVector<double> expected( n ), fast( n ), bytes( n );
+  QVector<bool> expectedOk( n ), fastOk( n ), bytesOk( n );
+  QElapsedTimer timer;
+  bool ok;
+
+  timer.start();
+  for( int i = 0; i < n; ++i ) {
+    expected[i] = set.strings.at(i).toDouble( &ok );
+    expectedOk[i] = ok;
+  }
+  const qint64 qtNsecs = timer.nsecsElapsed();
+
+  timer.restart();
+  for( int i = 0; i < n; ++i ) {
+    fast[i] = fastStrToDouble( set.strings.at(i), &ok );
+    fastOk[i] = ok;
+  }
+  const qint64 fastNsecs = timer.nsecsElapsed();
+
+  timer.restart();
+  for( int i = 0; i < n; ++i ) {
+    const QByteArray& b = set.bytes.at(i);
+    bytes[i] = bytesToDouble( b.constData(), b.size(), &ok );
+    bytesOk[i] = ok;
+  }
+  const qint64 bytesNsecs = timer.nsecsElapsed();
+
+  int fastMismatches = 0, bytesMismatches = 0;
+  for( int i = 0; i < n; ++i ) {
+    if( ( fastOk.at(i) != expectedOk.at(i) ) || !identical( fast.at(i), expected.at(i) ) )
+      ++fastMismatches;
+    if( ( bytesOk.at(i) != expectedOk.at(i) ) || !identical( bytes.at(i), expected.at(i) ) )
+      ++bytesMismatches;
+  }
+
+  report( QStringLiteral( "QString::toDouble():" ), qtNsecs, n );
+  report( QStringLiteral( "fastStrToDouble():" ), fastNsecs, n, fastMismatches );
+  report( QStringLiteral( "bytesToDouble():" ), bytesNsecs, n, bytesMismatches );
+}
+
+
+static void compareInts( const TestSet& set ) {
+  const int n = set.strings.count();
+  QVector<qint64> expected( n ), fast( n ), bytes( n );
+  QVector<bool> expectedOk( n ), fastOk( n ), bytesOk( n );
+  QElapsedTimer timer;
+  bool ok;
+
+  timer.start();
+  for( int i = 0; i < n; ++i ) {
+    expected[i] = set.strings.at(i).toLongLong( &ok );
+    expectedOk[i] = ok;
+  }
+  const qint64 qtNsecs = timer.nsecsElapsed();
+
+  timer.restart();
+  for( int i = 0; i < n; ++i ) {
+    fast[i] = fastStrToInt64( set.strings.at(i), &ok );
+    fastOk[i] = ok;
+  }
+  const qint64 fastNsecs = timer.nsecsElapsed();
+
+  timer.restart();
+  for( int i = 0; i < n; ++i ) {
+    const QByteArray& b = set.bytes.at(i);
+    bytes[i] = bytesToInt64( b.constData(), b.size(), &ok );
+    bytesOk[i] = ok;
+  }
+  const qint64 bytesNsecs = timer.nsecsElapsed();
+
+  int fastMismatches = 0, bytesMismatches = 0;
+  for( int i = 0; i < n; ++i ) {
+    if( ( fastOk.at(i) != expectedOk.at(i) ) || ( fast.at(i) != expected.at(i) ) )
+      ++fastMismatches;
+    if( ( bytesOk.at(i) != expectedOk.at(i) ) || ( bytes.at(i) != expected.at(i) ) )
+      ++bytesMismatches;
+  }
+
+  report( QStringLiteral( "QString::toLongLong():" ), qtNsecs, n );
+  report( QStringLiteral( "fastStrToInt64():" ), fastNsecs, n, fastMismatches );
+  report( QStringLiteral( "bytesToInt64():" ), bytesNsecs, n, bytesMismatches );
+}
+
+
+int main( int argc, char* argv[] ) {
+  QCoreApplication app( argc, argv );
+
+  const int nValues = ( 1 < argc ? qMax( 1, atoi( argv[1] ) ) : 1000000 );
+
+  cout << "Generating " << nValues << " values of each kind..." << endl;
+  const QList<TestSet> sets = generateSets( nValues );
+
+  for( int i = 0; i < sets.count(); ++i ) {
+    cout << endl << sets.at(i).name << endl;
+
+    if( 0 == i ) {
+      compareInts( sets.at(i) );
+      cout << endl;
+    }
+
+    compareDoubles( sets.at(i) );
+
+    if( ( sets.count() - 1 ) == i ) {
+      cout << endl;
+      compareInts( sets.at(i) );
+    }
+  }
+
+  return 0;
+}
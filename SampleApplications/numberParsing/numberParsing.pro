@@ -0,0 +1,28 @@
+#-------------------------------------------------
+#
+# Compares the fast, allocation-free number conversions
+# in strutils with QString::toDouble() and friends, and
+# checks that their results are identical.
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = numberParsing
+TEMPLATE = app
+
+INCLUDEPATH += \
+  ../../../
+
+SOURCES += \
+  main.cpp \
+    ../../../ar_general_purpose/qcout.cpp \
+    ../../../ar_general_purpose/strutils.cpp
+
+HEADERS  += \
+    ../../../ar_general_purpose/qcout.h \
+    ../../../ar_general_purpose/strutils.h
@@ -0,0 +1,103 @@
+/*
+twoDArraySort/main.cpp
+----------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+/* Usage: twoDArraySort
+ *
+ * Sorts a CTwoDArray with 3 columns and 7 rows on one and on two columns, in both directions, and checks
+ * that whole rows (and their names) moved together into the expected order.  Prints each result, and
+ * returns 1 if any check fails.
+ */
+
+#include <QtCore>
+
+#include <ar_general_purpose/ctwodarray.h>
+#include <ar_general_purpose/qcout.h>
+
+static CTwoDArray<QString> makeArray() {
+  // Column 0 holds numbers as text (so "10" must come after "9"), column 1 holds letters with ties,
+  // and column 2 holds a row ID, so that the position of every row can be checked.
+  const char* const rows[7][3] = {
+    { "10", "b", "r0" },
+    { "9",  "a", "r1" },
+    { "3",  "c", "r2" },
+    { "42", "a", "r3" },
+    { "",   "b", "r4" },
+    { "7",  "c", "r5" },
+    { "3",  "a", "r6" }
+  };
+
+  CTwoDArray<QString> result;
+  result.appendColumn( QStringLiteral( "number" ) );
+  result.appendColumn( QStringLiteral( "letter" ) );
+  result.appendColumn( QStringLiteral( "id" ) );
+
+  for( int r = 0; r < 7; ++r ) {
+    QVector<QString> values;
+    for( int c = 0; c < 3; ++c )
+      values.append( QString::fromLatin1( rows[r][c] ) );
+
+    result.appendRow( QStringLiteral( "row%1" ).arg( r ), values );
+  }
+
+  return result;
+}
+
+
+// Are the rows of arr in the order given by ids, with every cell of each row still together?
+static bool check( const QString& label, const CTwoDArray<QString>& arr, const QStringList& ids ) {
+  const CTwoDArray<QString> original = makeArray();
+  bool ok = ( ids.count() == arr.nRows() ) && ( 3 == arr.nCols() );
+
+  QStringList actual;
+  for( int r = 0; ok && ( r < arr.nRows() ); ++r ) {
+    actual.append( arr.value( 2, r ) );
+
+    const int src = arr.value( 2, r ).mid( 1 ).toInt();
+    for( int c = 0; c < 3; ++c )
+      ok = ok && ( arr.value( c, r ) == original.value( c, src ) );
+
+    ok = ok && ( arr.rowNames().at(r) == QStringLiteral( "row%1" ).arg( src ) );
+  }
+
+  ok = ok && ( actual == ids );
+
+  cout << ( ok ? "PASS  " : "FAIL  " ) << label << ": " << actual.join( QStringLiteral( " " ) ) << endl;
+
+  return ok;
+}
+
+
+int main( int argc, char* argv[] ) {
+  QCoreApplication app( argc, argv );
+
+  bool ok = true;
+
+  CTwoDArray<QString> arr = makeArray();
+  arr.sortOnColumn( 0 );
+  ok = check( QStringLiteral( "Numbers, ascending" ), arr, QStringList() << "r4" << "r2" << "r6" << "r5" << "r1" << "r0" << "r3" ) && ok;
+
+  arr = makeArray();
+  arr.sortOnColumn( QStringLiteral( "number" ), Qt::DescendingOrder );
+  ok = check( QStringLiteral( "Numbers, descending" ), arr, QStringList() << "r3" << "r0" << "r1" << "r5" << "r2" << "r6" << "r4" ) && ok;
+
+  arr = makeArray();
+  arr.sortOnColumns( QVector<int>() << 1 << 0, QVector<Qt::SortOrder>() << Qt::AscendingOrder << Qt::DescendingOrder );
+  ok = check( QStringLiteral( "Letters, then numbers descending" ), arr, QStringList() << "r3" << "r1" << "r6" << "r0" << "r4" << "r5" << "r2" ) && ok;
+
+  arr = makeArray();
+  const QVector<int> order = arr.sortOrder( QVector<int>() << 1 );
+  arr.applyRowOrder( order );
+  ok = check( QStringLiteral( "sortOrder() and applyRowOrder()" ), arr, QStringList() << "r1" << "r3" << "r6" << "r0" << "r4" << "r2" << "r5" ) && ok;
+
+  return ( ok ? 0 : 1 );
+}
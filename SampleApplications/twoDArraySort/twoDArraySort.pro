@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Checks that CTwoDArray sorts rows correctly,
+# including arrays with more rows than columns.
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = twoDArraySort
+TEMPLATE = app
+
+INCLUDEPATH += \
+  ../../../
+
+SOURCES += \
+  main.cpp \
+    ../../../ar_general_purpose/qcout.cpp
+
+HEADERS  += \
+    ../../../ar_general_purpose/ctwodarray.h \
+    ../../../ar_general_purpose/qcout.h
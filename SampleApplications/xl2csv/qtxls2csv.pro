@@ -1,4 +1,4 @@
-QT += core
+QT += core concurrent
 QT -= gui
 QT += xlsx
 
@@ -42,6 +42,14 @@ win32 {
 
 SOURCES += \
     ../../../ar_general_purpose/csv.cpp \
+    ../../../ar_general_purpose/csvcache.cpp \
+    ../../../ar_general_purpose/csvcolumnstore.cpp \
+    ../../../ar_general_purpose/csvdialect.cpp \
+    ../../../ar_general_purpose/csvrowbuffer.cpp \
+    ../../../ar_general_purpose/csvrowindex.cpp \
+    ../../../ar_general_purpose/csvsidecar.cpp \
+    ../../../ar_general_purpose/csvwriter.cpp \
+    ../../../ar_general_purpose/compressedio.cpp \
     ../../../ar_general_purpose/xlcsv.cpp \
     ../../../ar_general_purpose/xlutils.cpp \
     ../../../ar_general_purpose/strutils.cpp \
@@ -53,6 +61,14 @@ SOURCES += \
 
 HEADERS += \
     ../../../ar_general_purpose/csv.h \
+    ../../../ar_general_purpose/csvcache.h \
+    ../../../ar_general_purpose/csvcolumnstore.h \
+    ../../../ar_general_purpose/csvdialect.h \
+    ../../../ar_general_purpose/csvrowbuffer.h \
+    ../../../ar_general_purpose/csvrowindex.h \
+    ../../../ar_general_purpose/csvsidecar.h \
+    ../../../ar_general_purpose/csvwriter.h \
+    ../../../ar_general_purpose/compressedio.h \
     ../../../ar_general_purpose/xlcsv.h \
     ../../../ar_general_purpose/xlutils.h \
     ../../../ar_general_purpose/strutils.h \
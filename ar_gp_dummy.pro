@@ -34,6 +34,15 @@ INCLUDEPATH += \
 INCLUDEPATH += ../ \
                libnaadsm/include
 
+# The CSV parser (csv.cpp) uses SSE2 instructions on x86 and x86-64.  To use AVX2
+# instead, uncomment the following line, but only if all target machines support it.
+#QMAKE_CXXFLAGS += -mavx2
+
+# Reading and writing compressed CSV files (compressedio.cpp) needs zlib for gzip and/or
+# libzstd for zstd.  Uncomment whichever are available.
+#DEFINES += ZLIB_USED ZSTD_USED
+#LIBS += -lz -lzstd
+
 DEFINES += SRC_FILE_NAME=\\\"unamed_file\\\" # To make libods play nicely.
 DEFINES += SIMPLE_SPRNG
 
@@ -47,12 +56,23 @@ SOURCES += \
         cformstring.cpp \
         clookuptable.cpp \
         cmagic8ball.cpp \
+        compressedio.cpp \
         cqstring.cpp \
         cqstringlist.cpp \
         cquerytable.cpp \
         creverselookupmap.cpp \
         cspreadsheetarray.cpp \
         csv.cpp \
+        csvbatchloader.cpp \
+        csvcache.cpp \
+        csvcolumnstore.cpp \
+        csvdialect.cpp \
+        csvrowbuffer.cpp \
+        csvrowindex.cpp \
+        csvschema.cpp \
+        csvsidecar.cpp \
+        csvsorter.cpp \
+        csvwriter.cpp \
         cxmldom.cpp \
         datetimeutils.cpp \
         debugutils.cpp \
@@ -97,12 +117,24 @@ HEADERS += \
   clookuptable.h \
   clookuptable2.h \
   cmagic8ball.h \
+  compressedio.h \
   cqstring.h \
   cqstringlist.h \
   cquerytable.h \
   creverselookupmap.h \
   cspreadsheetarray.h \
   csv.h \
+  csvbatchloader.h \
+  csvcache.h \
+  csvcolumnstore.h \
+  csvdialect.h \
+  csvrowbuffer.h \
+  csvrowindex.h \
+  csvrowreader.h \
+  csvschema.h \
+  csvsidecar.h \
+  csvsorter.h \
+  csvwriter.h \
   ctwodarray.h \
   cxmldom.h \
   datetimeutils.h \
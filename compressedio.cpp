@@ -0,0 +1,563 @@
+/*
+compressedio.h/cpp
+------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "compressedio.h"
+
+#ifdef ZLIB_USED
+  #include <zlib.h>
+#endif
+
+#ifdef ZSTD_USED
+  #include <zstd.h>
+#endif
+
+namespace {
+  const int inputChunkSize = 256 * 1024;  // Compressed bytes read from the source at a time
+  const int blockSize = 256 * 1024;       // Size of each block of decompressed data
+  const int maxQueuedBlocks = 16;         // How far the decompressing thread may get ahead of the reader
+}
+
+
+CompressionFormat compressionFormat( const QByteArray& leadingBytes ) {
+  if( leadingBytes.startsWith( "\x1F\x8B" ) )
+    return GzipCompression;
+  else if( leadingBytes.startsWith( "\x28\xB5\x2F\xFD" ) )
+    return ZstdCompression;
+  else
+    return NoCompression;
+}
+
+
+CompressionFormat compressionFormatOfFile( const QString& fileName ) {
+  QFile file( fileName );
+
+  if( !file.open( QIODevice::ReadOnly ) )
+    return NoCompression;
+  else
+    return compressionFormat( file.read( 4 ) );
+}
+
+
+CompressionFormat compressionFormatForFileName( const QString& fileName ) {
+  const QString suffix = QFileInfo( fileName ).suffix().toLower();
+
+  if( ( QLatin1String("gz") == suffix ) || ( QLatin1String("gzip") == suffix ) )
+    return GzipCompression;
+  else if( ( QLatin1String("zst") == suffix ) || ( QLatin1String("zstd") == suffix ) )
+    return ZstdCompression;
+  else
+    return NoCompression;
+}
+
+
+bool compressionSupported( const CompressionFormat format ) {
+  switch( format ) {
+    case NoCompression:
+      return true;
+    case GzipCompression:
+      #ifdef ZLIB_USED
+        return true;
+      #else
+        return false;
+      #endif
+    case ZstdCompression:
+      #ifdef ZSTD_USED
+        return true;
+      #else
+        return false;
+      #endif
+    default:
+      return false;
+  }
+}
+
+
+QString compressionFormatName( const CompressionFormat format ) {
+  switch( format ) {
+    case NoCompression: return QStringLiteral("uncompressed");
+    case GzipCompression: return QStringLiteral("gzip");
+    case ZstdCompression: return QStringLiteral("zstd");
+    default: return QStringLiteral("unknown");
+  }
+}
+
+
+//---------------------------------------------------------------------------------------
+// QDecompressingReader
+//---------------------------------------------------------------------------------------
+QDecompressingReader::QDecompressingReader( QIODevice* source, const CompressionFormat format, QObject* parent /* = nullptr */ ) : QIODevice( parent ) {
+  _source = source;
+  _format = format;
+  _queuedBytes = 0;
+  _finished = false;
+  _stop = false;
+  _currentPos = 0;
+}
+
+
+QDecompressingReader::~QDecompressingReader() {
+  close();
+}
+
+
+bool QDecompressingReader::open( OpenMode mode ) {
+  if( isOpen() || ( mode & QIODevice::WriteOnly ) ) {
+    return false;
+  }
+  else if( ( nullptr == _source ) || !_source->isReadable() ) {
+    setErrorString( QStringLiteral("The compressed source is not open for reading.") );
+    return false;
+  }
+  else if( ( NoCompression == _format ) || !compressionSupported( _format ) ) {
+    setErrorString( QStringLiteral("Support for %1 compression is not available.").arg( compressionFormatName( _format ) ) );
+    return false;
+  }
+
+  _blocks.clear();
+  _queuedBytes = 0;
+  _finished = false;
+  _stop = false;
+  _decompressionError.clear();
+  _current.clear();
+  _currentPos = 0;
+
+  QIODevice::open( mode );
+
+  _future = QtConcurrent::run( this, &QDecompressingReader::decompress );
+
+  return true;
+}
+
+
+void QDecompressingReader::close() {
+  if( !isOpen() )
+    return;
+
+  // Stop the worker, if it's still running, and wait for it.
+  _mutex.lock();
+  _stop = true;
+  _notFull.wakeAll();
+  _mutex.unlock();
+
+  _future.waitForFinished();
+
+  _blocks.clear();
+  _queuedBytes = 0;
+  _current.clear();
+  _currentPos = 0;
+
+  QIODevice::close();
+}
+
+
+bool QDecompressingReader::atEnd() const {
+  if( !isOpen() )
+    return true;
+  else if( 0 < QIODevice::bytesAvailable() )
+    return false;
+  else
+    return !( const_cast<QDecompressingReader*>( this )->loadBlock() );
+}
+
+
+qint64 QDecompressingReader::bytesAvailable() const {
+  QMutexLocker locker( &_mutex );
+  return QIODevice::bytesAvailable() + ( _current.size() - _currentPos ) + _queuedBytes;
+}
+
+
+QString QDecompressingReader::decompressionError() const {
+  QMutexLocker locker( &_mutex );
+  return _decompressionError;
+}
+
+
+qint64 QDecompressingReader::readData( char* data, qint64 maxSize ) {
+  if( !loadBlock() )
+    return -1;
+
+  const qint64 n = qMin( maxSize, qint64( _current.size() - _currentPos ) );
+  memcpy( data, _current.constData() + _currentPos, size_t( n ) );
+  _currentPos = _currentPos + int( n );
+
+  return n;
+}
+
+
+bool QDecompressingReader::loadBlock() {
+  if( _currentPos < _current.size() )
+    return true;
+
+  QMutexLocker locker( &_mutex );
+
+  while( _blocks.isEmpty() && !_finished )
+    _notEmpty.wait( &_mutex );
+
+  if( _blocks.isEmpty() ) {
+    _current.clear();
+    _currentPos = 0;
+
+    if( !_decompressionError.isEmpty() )
+      setErrorString( _decompressionError );
+
+    return false;
+  }
+
+  _current = _blocks.dequeue();
+  _currentPos = 0;
+  _queuedBytes = _queuedBytes - _current.size();
+  _notFull.wakeAll();
+
+  return true;
+}
+
+
+bool QDecompressingReader::pushBlock( const QByteArray& block ) {
+  QMutexLocker locker( &_mutex );
+
+  while( ( maxQueuedBlocks <= _blocks.count() ) && !_stop )
+    _notFull.wait( &_mutex );
+
+  if( _stop )
+    return false;
+
+  _blocks.enqueue( block );
+  _queuedBytes = _queuedBytes + block.size();
+  _notEmpty.wakeAll();
+
+  return true;
+}
+
+
+void QDecompressingReader::finish( const QString& errorMessage /* = QString() */ ) {
+  QMutexLocker locker( &_mutex );
+  _finished = true;
+  _decompressionError = errorMessage;
+  _notEmpty.wakeAll();
+}
+
+
+void QDecompressingReader::decompress() {
+  switch( _format ) {
+    case GzipCompression:
+      decompressGzip();
+      break;
+    case ZstdCompression:
+      decompressZstd();
+      break;
+    default:
+      finish( QStringLiteral("Unsupported compression format.") );
+      break;
+  }
+}
+
+
+void QDecompressingReader::decompressGzip() {
+  #ifdef ZLIB_USED
+    z_stream strm;
+    memset( &strm, 0, sizeof( strm ) );
+
+    // 15 + 32: the largest window, with automatic detection of gzip or zlib headers
+    if( Z_OK != inflateInit2( &strm, 15 + 32 ) ) {
+      finish( QStringLiteral("Could not initialize gzip decompression.") );
+      return;
+    }
+
+    QByteArray in( inputChunkSize, Qt::Uninitialized );
+    QString errorMessage;
+    bool streamEnded = true; // Is the decompressor between gzip members (as it is at the start)?
+    bool stopped = false;
+
+    while( errorMessage.isEmpty() && !stopped ) {
+      const qint64 nRead = _source->read( in.data(), in.size() );
+
+      if( 0 > nRead ) {
+        errorMessage = QStringLiteral("Could not read compressed data: %1").arg( _source->errorString() );
+        break;
+      }
+      else if( 0 == nRead ) {
+        if( !streamEnded )
+          errorMessage = QStringLiteral("Compressed data are incomplete.");
+        break;
+      }
+
+      strm.next_in = reinterpret_cast<Bytef*>( in.data() );
+      strm.avail_in = uInt( nRead );
+
+      do {
+        QByteArray out( blockSize, Qt::Uninitialized );
+        strm.next_out = reinterpret_cast<Bytef*>( out.data() );
+        strm.avail_out = uInt( blockSize );
+
+        const int ret = inflate( &strm, Z_NO_FLUSH );
+
+        if( ( Z_OK != ret ) && ( Z_STREAM_END != ret ) && ( Z_BUF_ERROR != ret ) ) {
+          errorMessage = QStringLiteral("Compressed data are damaged: %1").arg( QString::fromLatin1( nullptr == strm.msg ? "unknown error" : strm.msg ) );
+          break;
+        }
+
+        const int produced = blockSize - int( strm.avail_out );
+        streamEnded = ( Z_STREAM_END == ret );
+
+        // Files may consist of several gzip members, one after the other.
+        if( streamEnded )
+          inflateReset( &strm );
+
+        if( 0 < produced ) {
+          out.resize( produced );
+          if( !pushBlock( out ) ) {
+            stopped = true;
+            break;
+          }
+        }
+        else if( ( Z_BUF_ERROR == ret ) && ( 0 == strm.avail_in ) ) {
+          break;
+        }
+      } while( ( 0 < strm.avail_in ) || ( 0 == strm.avail_out ) );
+    }
+
+    inflateEnd( &strm );
+    finish( errorMessage );
+  #else
+    finish( QStringLiteral("Support for gzip compression is not available.") );
+  #endif
+}
+
+
+void QDecompressingReader::decompressZstd() {
+  #ifdef ZSTD_USED
+    ZSTD_DStream* zds = ZSTD_createDStream();
+
+    if( ( nullptr == zds ) || ZSTD_isError( ZSTD_initDStream( zds ) ) ) {
+      ZSTD_freeDStream( zds );
+      finish( QStringLiteral("Could not initialize zstd decompression.") );
+      return;
+    }
+
+    QByteArray in( inputChunkSize, Qt::Uninitialized );
+    QString errorMessage;
+    size_t lastRet = 0; // Zero when a frame has been completely decoded
+    bool stopped = false;
+
+    while( errorMessage.isEmpty() && !stopped ) {
+      const qint64 nRead = _source->read( in.data(), in.size() );
+
+      if( 0 > nRead ) {
+        errorMessage = QStringLiteral("Could not read compressed data: %1").arg( _source->errorString() );
+        break;
+      }
+      else if( 0 == nRead ) {
+        if( 0 != lastRet )
+          errorMessage = QStringLiteral("Compressed data are incomplete.");
+        break;
+      }
+
+      ZSTD_inBuffer input = { in.constData(), size_t( nRead ), 0 };
+      bool outputFull;
+
+      do {
+        QByteArray out( blockSize, Qt::Uninitialized );
+        ZSTD_outBuffer output = { out.data(), size_t( blockSize ), 0 };
+
+        lastRet = ZSTD_decompressStream( zds, &output, &input );
+
+        if( ZSTD_isError( lastRet ) ) {
+          errorMessage = QStringLiteral("Compressed data are damaged: %1").arg( QString::fromLatin1( ZSTD_getErrorName( lastRet ) ) );
+          break;
+        }
+
+        outputFull = ( output.pos == output.size );
+
+        if( 0 < output.pos ) {
+          out.resize( int( output.pos ) );
+          if( !pushBlock( out ) ) {
+            stopped = true;
+            break;
+          }
+        }
+      } while( ( input.pos < input.size ) || outputFull );
+    }
+
+    ZSTD_freeDStream( zds );
+    finish( errorMessage );
+  #else
+    finish( QStringLiteral("Support for zstd compression is not available.") );
+  #endif
+}
+
+
+//---------------------------------------------------------------------------------------
+// QCompressingWriter
+//---------------------------------------------------------------------------------------
+QCompressingWriter::QCompressingWriter( QIODevice* destination, const CompressionFormat format, const int level /* = 0 */, QObject* parent /* = nullptr */ ) : QIODevice( parent ) {
+  _destination = destination;
+  _format = format;
+  _level = level;
+  _stream = nullptr;
+}
+
+
+QCompressingWriter::~QCompressingWriter() {
+  close();
+}
+
+
+bool QCompressingWriter::open( OpenMode mode ) {
+  if( isOpen() || ( mode & QIODevice::ReadOnly ) ) {
+    return false;
+  }
+  else if( ( nullptr == _destination ) || !_destination->isWritable() ) {
+    setErrorString( QStringLiteral("The destination is not open for writing.") );
+    return false;
+  }
+  else if( ( NoCompression == _format ) || !compressionSupported( _format ) ) {
+    setErrorString( QStringLiteral("Support for %1 compression is not available.").arg( compressionFormatName( _format ) ) );
+    return false;
+  }
+
+  bool ok = false;
+  _compressionError.clear();
+  _out.resize( blockSize );
+
+  if( GzipCompression == _format ) {
+    #ifdef ZLIB_USED
+      z_stream* strm = new z_stream;
+      memset( strm, 0, sizeof( z_stream ) );
+
+      // 15 + 16: the largest window, with a gzip header and trailer
+      ok = ( Z_OK == deflateInit2( strm, ( 0 == _level ? Z_DEFAULT_COMPRESSION : _level ), Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) );
+
+      if( ok )
+        _stream = strm;
+      else
+        delete strm;
+    #endif
+  }
+  else if( ZstdCompression == _format ) {
+    #ifdef ZSTD_USED
+      ZSTD_CStream* zcs = ZSTD_createCStream();
+      ok = ( ( nullptr != zcs ) && !ZSTD_isError( ZSTD_initCStream( zcs, ( 0 == _level ? ZSTD_CLEVEL_DEFAULT : _level ) ) ) );
+
+      if( ok )
+        _stream = zcs;
+      else
+        ZSTD_freeCStream( zcs );
+    #endif
+  }
+
+  if( !ok ) {
+    setErrorString( QStringLiteral("Could not initialize %1 compression.").arg( compressionFormatName( _format ) ) );
+    return false;
+  }
+
+  return QIODevice::open( mode );
+}
+
+
+void QCompressingWriter::close() {
+  if( !isOpen() )
+    return;
+
+  compress( nullptr, 0, true );
+
+  if( GzipCompression == _format ) {
+    #ifdef ZLIB_USED
+      z_stream* strm = static_cast<z_stream*>( _stream );
+      deflateEnd( strm );
+      delete strm;
+    #endif
+  }
+  else if( ZstdCompression == _format ) {
+    #ifdef ZSTD_USED
+      ZSTD_freeCStream( static_cast<ZSTD_CStream*>( _stream ) );
+    #endif
+  }
+
+  _stream = nullptr;
+
+  QIODevice::close();
+}
+
+
+qint64 QCompressingWriter::writeData( const char* data, qint64 maxSize ) {
+  if( compress( data, maxSize, false ) )
+    return maxSize;
+  else
+    return -1;
+}
+
+
+bool QCompressingWriter::compress( const char* data, const qint64 size, const bool finish ) {
+  if( !_compressionError.isEmpty() )
+    return false;
+
+  if( GzipCompression == _format ) {
+    #ifdef ZLIB_USED
+      z_stream* strm = static_cast<z_stream*>( _stream );
+      strm->next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data ) );
+      strm->avail_in = uInt( size );
+
+      int ret;
+      do {
+        strm->next_out = reinterpret_cast<Bytef*>( _out.data() );
+        strm->avail_out = uInt( _out.size() );
+
+        ret = deflate( strm, ( finish ? Z_FINISH : Z_NO_FLUSH ) );
+
+        if( Z_STREAM_ERROR == ret ) {
+          _compressionError = QStringLiteral("gzip compression failed.");
+          break;
+        }
+
+        const qint64 produced = _out.size() - qint64( strm->avail_out );
+        if( ( 0 < produced ) && ( produced != _destination->write( _out.constData(), produced ) ) ) {
+          _compressionError = QStringLiteral("Could not write compressed data: %1").arg( _destination->errorString() );
+          break;
+        }
+      } while( ( 0 == strm->avail_out ) || ( finish && ( Z_STREAM_END != ret ) ) );
+    #endif
+  }
+  else if( ZstdCompression == _format ) {
+    #ifdef ZSTD_USED
+      ZSTD_CStream* zcs = static_cast<ZSTD_CStream*>( _stream );
+      ZSTD_inBuffer input = { data, size_t( size ), 0 };
+      size_t remaining = 1;
+
+      while( ( input.pos < input.size ) || ( finish && ( 0 != remaining ) ) ) {
+        ZSTD_outBuffer output = { _out.data(), size_t( _out.size() ), 0 };
+
+        if( input.pos < input.size )
+          remaining = ZSTD_compressStream( zcs, &output, &input );
+        else
+          remaining = ZSTD_endStream( zcs, &output );
+
+        if( ZSTD_isError( remaining ) ) {
+          _compressionError = QStringLiteral("zstd compression failed: %1").arg( QString::fromLatin1( ZSTD_getErrorName( remaining ) ) );
+          break;
+        }
+
+        if( ( 0 < output.pos ) && ( qint64( output.pos ) != _destination->write( _out.constData(), qint64( output.pos ) ) ) ) {
+          _compressionError = QStringLiteral("Could not write compressed data: %1").arg( _destination->errorString() );
+          break;
+        }
+      }
+    #endif
+  }
+
+  if( !_compressionError.isEmpty() ) {
+    setErrorString( _compressionError );
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,141 @@
+/*
+compressedio.h/cpp
+------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef COMPRESSEDIO_H
+#define COMPRESSEDIO_H
+
+#include <QtCore>
+#include <QtConcurrent>
+
+/* Reading and writing gzip- and zstd-compressed data through QIODevice.
+ *
+ * Each format is supported only if ZLIB_USED or ZSTD_USED is defined, and zlib or libzstd is linked.
+ * Compressed data can be recognized either way, so that a sensible message can be given if support
+ * for a format is missing.
+ */
+
+enum CompressionFormat {
+  NoCompression,
+  GzipCompression,
+  ZstdCompression
+};
+
+// Recognizes compressed data by their first few bytes ("magic numbers").
+CompressionFormat compressionFormat( const QByteArray& leadingBytes );
+
+// As above, from the contents of a file.
+CompressionFormat compressionFormatOfFile( const QString& fileName );
+
+// From the extension of a file name: ".gz" or ".zst".  Used to decide how to write files.
+CompressionFormat compressionFormatForFileName( const QString& fileName );
+
+bool compressionSupported( const CompressionFormat format ); // Was support for this format compiled in?
+QString compressionFormatName( const CompressionFormat format );
+
+
+/* A sequential, read-only device that decompresses the contents of another device.
+ *
+ * Decompression runs on a separate thread, which reads and decompresses blocks of data ahead of the
+ * reader, up to a fixed number of blocks.  Reading from disk, decompressing, and whatever is done with
+ * the decompressed data (e.g. parsing) therefore all happen at the same time.
+ *
+ * The source device must already be open for reading.  It must outlast this object, and must not be
+ * used for anything else while this object is open.
+ */
+class QDecompressingReader : public QIODevice {
+  public:
+    QDecompressingReader( QIODevice* source, const CompressionFormat format, QObject* parent = nullptr );
+    virtual ~QDecompressingReader();
+
+    virtual bool open( OpenMode mode ) override; // ReadOnly, optionally with Text
+    virtual void close() override;
+    virtual bool isSequential() const override { return true; }
+    virtual bool atEnd() const override; // Waits, if necessary, for more data or for the end of the stream.
+    virtual qint64 bytesAvailable() const override;
+
+    // Set if the compressed data were damaged, truncated, or couldn't be read.  The data decompressed up
+    // to that point can still be read.
+    QString decompressionError() const;
+
+  protected:
+    virtual qint64 readData( char* data, qint64 maxSize ) override;
+    virtual qint64 writeData( const char* data, qint64 maxSize ) override { Q_UNUSED( data ); Q_UNUSED( maxSize ); return -1; }
+
+    // Run on the worker thread
+    void decompress();
+    void decompressGzip();
+    void decompressZstd();
+    bool pushBlock( const QByteArray& block ); // Waits while the queue is full.  Returns false if reading has stopped.
+    void finish( const QString& errorMessage = QString() );
+
+    // Run on the reading thread
+    bool loadBlock(); // Makes sure that _current has unread data, waiting if necessary.  Returns false at the end.
+
+    QIODevice* _source;
+    CompressionFormat _format;
+    QFuture<void> _future;
+
+    // Shared between threads
+    mutable QMutex _mutex;
+    QWaitCondition _notEmpty;
+    QWaitCondition _notFull;
+    QQueue<QByteArray> _blocks;
+    qint64 _queuedBytes;
+    bool _finished;
+    bool _stop;
+    QString _decompressionError;
+
+    // Used only by the reading thread
+    QByteArray _current;
+    int _currentPos;
+
+  private:
+    Q_DISABLE_COPY( QDecompressingReader )
+};
+
+
+/* A sequential, write-only device that compresses data and writes them to another device.
+ *
+ * The destination device must already be open for writing, and must outlast this object.  close()
+ * finishes the compressed stream, but does not close the destination.
+ */
+class QCompressingWriter : public QIODevice {
+  public:
+    // A level of 0 means the library's default (6 for gzip, 3 for zstd).
+    QCompressingWriter( QIODevice* destination, const CompressionFormat format, const int level = 0, QObject* parent = nullptr );
+    virtual ~QCompressingWriter();
+
+    virtual bool open( OpenMode mode ) override; // WriteOnly
+    virtual void close() override;
+    virtual bool isSequential() const override { return true; }
+
+    QString compressionError() const { return _compressionError; }
+
+  protected:
+    virtual qint64 readData( char* data, qint64 maxSize ) override { Q_UNUSED( data ); Q_UNUSED( maxSize ); return -1; }
+    virtual qint64 writeData( const char* data, qint64 maxSize ) override;
+
+    bool compress( const char* data, const qint64 size, const bool finish );
+
+    QIODevice* _destination;
+    CompressionFormat _format;
+    int _level;
+    void* _stream; // z_stream or ZSTD_CStream, so that library headers aren't needed here
+    QByteArray _out;
+    QString _compressionError;
+
+  private:
+    Q_DISABLE_COPY( QCompressingWriter )
+};
+
+#endif // COMPRESSEDIO_H
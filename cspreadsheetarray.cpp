@@ -16,10 +16,13 @@ Public License as published by the Free Software Foundation; either version 2 of
 
 #include <QDebug>
 
+#include <limits>
+
 #include <ar_general_purpose/strutils.h>
 #include <ar_general_purpose/qcout.h>
 #include <ar_general_purpose/filemagic.h>
 #include <ar_general_purpose/log.h>
+#include <ar_general_purpose/csvwriter.h>
 
 typedef uint16_t xlsWORD;
 
@@ -99,6 +102,47 @@ const QXlsx::CellRange CSpreadsheetCell::mergedRange( const int col, const int r
 }
 
 
+bool CSpreadsheetCell::setDataType( const QMetaType::Type type ) {
+  // Text is converted to numbers without QVariant's general conversion.  Values that the fast
+  // conversions turn down are left to QVariant, so results are the same either way.
+  if( QMetaType::QString == _value.userType() ) {
+    const QString str = _value.toString();
+    bool ok;
+
+    switch( type ) {
+      case QMetaType::Double: {
+          const double d = fastStrToDouble( str, &ok );
+          if( ok ) {
+            _value = QVariant( d );
+            return true;
+          }
+        }
+        break;
+      case QMetaType::LongLong: {
+          const qint64 i = fastStrToInt64( str, &ok );
+          if( ok ) {
+            _value = QVariant( i );
+            return true;
+          }
+        }
+        break;
+      case QMetaType::Int: {
+          const qint64 i = fastStrToInt64( str, &ok );
+          if( ok && ( std::numeric_limits<int>::min() <= i ) && ( std::numeric_limits<int>::max() >= i ) ) {
+            _value = QVariant( int( i ) );
+            return true;
+          }
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  return _value.convert( type );
+}
+
+
 bool CSpreadsheetCell::isNumeric() const {
   QVariant::Type type = this->value().type();
 
@@ -889,8 +933,52 @@ bool CSpreadsheet::writeCsv( const QString& fileName, const bool firstRowContain
     return false;
   }
   else {
-    QCsv csv = this->asCsv( firstRowContainsHeader, delimiter );
-    return csv.writeFile( fileName );
+    // Rows are written one at a time, rather than first copying the whole sheet into a QCsv object with asCsv().
+    // Values are quoted as QCsv::writeFile() quotes them (see QCsvWriter::setLegacyQuoting()).
+    int nCols;
+    if( this->hasColNames() )
+      nCols = this->colNames().count();
+    else
+      nCols = this->rowAsStringList( 0, true ).count();
+
+    const int firstDataRowIdx = ( firstRowContainsHeader ? 1 : 0 );
+
+    // Trailing empty rows are not written.
+    int lastRowIdxPlusOne = this->nRows();
+    while( ( lastRowIdxPlusOne > firstDataRowIdx ) && isEmptyStringList( this->rowAsStringList( lastRowIdxPlusOne - 1 ).mid( 0, nCols ) ) ) {
+      --lastRowIdxPlusOne;
+    }
+
+    QCsvWriter writer;
+    writer.setDelimiter( delimiter );
+    writer.setLegacyQuoting( true );
+
+    if( !writer.open( fileName ) ) {
+      _errMsg.append( writer.errorMsg() + "\n" );
+      return false;
+    }
+
+    if( this->hasColNames() ) {
+      for( int c = 0; c < nCols; ++c ) {
+        writer.writeField( this->colNames().at(c).trimmed() );
+      }
+      writer.endRow();
+    }
+
+    for( int r = firstDataRowIdx; r < lastRowIdxPlusOne; ++r ) {
+      const QStringList row = this->rowAsStringList( r );
+      for( int c = 0; ( c < nCols ) && ( c < row.count() ); ++c ) {
+        writer.writeField( row.at(c).trimmed() );
+      }
+      writer.endRow();
+    }
+
+    if( !writer.close() ) {
+      _errMsg.append( writer.errorMsg() + "\n" );
+      return false;
+    }
+
+    return true;
   }
 }
 
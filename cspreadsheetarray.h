@@ -120,7 +120,7 @@ class CSpreadsheetCell {
     void setValue( const QVariant& value ) { _value = value; }
     const QVariant value() const { return _value; }
 
-    bool setDataType( const QMetaType::Type type ) { return _value.convert( type ); }
+    bool setDataType( const QMetaType::Type type ); // As QVariant::convert(), but text is converted to numbers more quickly
     bool isNumeric() const;
 
     void debug( const int c = -1, const int r = -1 ) const;
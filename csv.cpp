@@ -23,9 +23,301 @@ Public License as published by the Free Software Foundation; either version 2 of
 #include <QTextCodec>
 #include <QRegExp>
 #include <QDebug>
+#include <QtConcurrent>
+
+#include <cctype>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+  #include <sys/inotify.h>
+  #include <poll.h>
+  #include <unistd.h>
+#endif
 
 #include <ar_general_purpose/strutils.h>
 #include <ar_general_purpose/qcout.h>
+#include <ar_general_purpose/csvwriter.h>
+#include <ar_general_purpose/compressedio.h>
+#include <ar_general_purpose/csvrowbuffer.h>
+
+// Use the widest vector instructions that the compiler has been told it may use.
+// Builds without SSE2 (or on other architectures) fall back on plain scalar loops.
+#if defined(__AVX2__)
+  #define CSV_SCAN_AVX2
+  #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && ( _M_IX86_FP >= 2 ) )
+  #define CSV_SCAN_SSE2
+  #include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+
+//---------------------------------------------------------------------------------------
+// Scanning kernels
+//
+// The parsers below spend nearly all of their time looking for the next "interesting"
+// character (a delimiter, a quote mark, or a line break).  These functions find it
+// 16 or 32 bytes at a time, so that the characters in between can be copied in bulk.
+//---------------------------------------------------------------------------------------
+namespace {
+  #if defined(CSV_SCAN_AVX2) || defined(CSV_SCAN_SSE2)
+  inline int countTrailingZeros( const quint32 v ) {
+    #if defined(_MSC_VER)
+      unsigned long idx;
+      _BitScanForward( &idx, v );
+      return int( idx );
+    #else
+      return __builtin_ctz( v );
+    #endif
+  }
+  #endif
+
+
+  // Returns the position of the first UTF-16 code unit in s[from, len) that is equal to a, b, or c,
+  // or len if there is no such code unit.
+  int findAny( const ushort* s, int from, const int len, const ushort a, const ushort b, const ushort c ) {
+    #if defined(CSV_SCAN_AVX2)
+      const __m256i va = _mm256_set1_epi16( short( a ) );
+      const __m256i vb = _mm256_set1_epi16( short( b ) );
+      const __m256i vc = _mm256_set1_epi16( short( c ) );
+
+      while( from + 16 <= len ) {
+        const __m256i chunk = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + from ) );
+        const __m256i hits = _mm256_or_si256(
+          _mm256_or_si256( _mm256_cmpeq_epi16( chunk, va ), _mm256_cmpeq_epi16( chunk, vb ) ),
+          _mm256_cmpeq_epi16( chunk, vc )
+        );
+        const quint32 mask = quint32( _mm256_movemask_epi8( hits ) );
+        if( 0 != mask )
+          return from + countTrailingZeros( mask )/2; // Each code unit contributes two bits to the mask
+        from += 16;
+      }
+    #elif defined(CSV_SCAN_SSE2)
+      const __m128i va = _mm_set1_epi16( short( a ) );
+      const __m128i vb = _mm_set1_epi16( short( b ) );
+      const __m128i vc = _mm_set1_epi16( short( c ) );
+
+      while( from + 8 <= len ) {
+        const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + from ) );
+        const __m128i hits = _mm_or_si128(
+          _mm_or_si128( _mm_cmpeq_epi16( chunk, va ), _mm_cmpeq_epi16( chunk, vb ) ),
+          _mm_cmpeq_epi16( chunk, vc )
+        );
+        const quint32 mask = quint32( _mm_movemask_epi8( hits ) );
+        if( 0 != mask )
+          return from + countTrailingZeros( mask )/2; // Each code unit contributes two bits to the mask
+        from += 8;
+      }
+    #endif
+
+    while( from < len ) {
+      const ushort u = s[from];
+      if( ( a == u ) || ( b == u ) || ( c == u ) )
+        return from;
+      ++from;
+    }
+
+    return len;
+  }
+
+
+  // Returns the position of the first byte in s[from, len) that is equal to any of a through e,
+  // or len if there is no such byte.  Callers that need fewer targets may simply repeat one.
+  qint64 findAny( const char* s, qint64 from, const qint64 len, const char a, const char b, const char c, const char d, const char e ) {
+    #if defined(CSV_SCAN_AVX2)
+      const __m256i va = _mm256_set1_epi8( a );
+      const __m256i vb = _mm256_set1_epi8( b );
+      const __m256i vc = _mm256_set1_epi8( c );
+      const __m256i vd = _mm256_set1_epi8( d );
+      const __m256i ve = _mm256_set1_epi8( e );
+
+      while( from + 32 <= len ) {
+        const __m256i chunk = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + from ) );
+        __m256i hits = _mm256_or_si256( _mm256_cmpeq_epi8( chunk, va ), _mm256_cmpeq_epi8( chunk, vb ) );
+        hits = _mm256_or_si256( hits, _mm256_cmpeq_epi8( chunk, vc ) );
+        hits = _mm256_or_si256( hits, _mm256_cmpeq_epi8( chunk, vd ) );
+        hits = _mm256_or_si256( hits, _mm256_cmpeq_epi8( chunk, ve ) );
+        const quint32 mask = quint32( _mm256_movemask_epi8( hits ) );
+        if( 0 != mask )
+          return from + countTrailingZeros( mask );
+        from += 32;
+      }
+    #elif defined(CSV_SCAN_SSE2)
+      const __m128i va = _mm_set1_epi8( a );
+      const __m128i vb = _mm_set1_epi8( b );
+      const __m128i vc = _mm_set1_epi8( c );
+      const __m128i vd = _mm_set1_epi8( d );
+      const __m128i ve = _mm_set1_epi8( e );
+
+      while( from + 16 <= len ) {
+        const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + from ) );
+        __m128i hits = _mm_or_si128( _mm_cmpeq_epi8( chunk, va ), _mm_cmpeq_epi8( chunk, vb ) );
+        hits = _mm_or_si128( hits, _mm_cmpeq_epi8( chunk, vc ) );
+        hits = _mm_or_si128( hits, _mm_cmpeq_epi8( chunk, vd ) );
+        hits = _mm_or_si128( hits, _mm_cmpeq_epi8( chunk, ve ) );
+        const quint32 mask = quint32( _mm_movemask_epi8( hits ) );
+        if( 0 != mask )
+          return from + countTrailingZeros( mask );
+        from += 16;
+      }
+    #endif
+
+    while( from < len ) {
+      const char ch = s[from];
+      if( ( a == ch ) || ( b == ch ) || ( c == ch ) || ( d == ch ) || ( e == ch ) )
+        return from;
+      ++from;
+    }
+
+    return len;
+  }
+
+
+  // Counts the quote marks in data[start, end).
+  int countQuotes( const char* data, const qint64 start, const qint64 end ) {
+    int result = 0;
+    qint64 i = start;
+
+    while( i < end ) {
+      i = findAny( data, i, end, '"', '"', '"', '"', '"' );
+      if( i < end ) {
+        ++result;
+        ++i;
+      }
+    }
+
+    return result;
+  }
+
+
+  // Does data[start, end) contain only 7-bit ASCII characters?  The high bit of each byte is tested 16 or 32 bytes at a time.
+  bool allAscii( const char* data, qint64 start, const qint64 end ) {
+    #if defined(CSV_SCAN_AVX2)
+      while( start + 32 <= end ) {
+        const __m256i chunk = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + start ) );
+        if( 0 != _mm256_movemask_epi8( chunk ) )
+          return false;
+        start += 32;
+      }
+    #elif defined(CSV_SCAN_SSE2)
+      while( start + 16 <= end ) {
+        const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + start ) );
+        if( 0 != _mm_movemask_epi8( chunk ) )
+          return false;
+        start += 16;
+      }
+    #endif
+
+    while( start < end ) {
+      if( 0 != ( data[start] & 0x80 ) )
+        return false;
+      ++start;
+    }
+
+    return true;
+  }
+
+
+  // Equivalent to QString( chars + start, end - start ).trimmed(), without the intermediate copy.
+  QString trimmedSlice( const QChar* chars, int start, int end ) {
+    while( ( start < end ) && chars[start].isSpace() )
+      ++start;
+    while( ( end > start ) && chars[end - 1].isSpace() )
+      --end;
+
+    return QString( chars + start, end - start );
+  }
+
+
+  // Rewrites str in the standard form for the given column format (see QCsv::setFieldFormat()).
+  // Empty strings are left alone.  Returns false, leaving str unchanged, if str can't be converted.
+  bool formatValue( QString& str, const QCsv::ColumnFormat columnFmt, const StrUtilsDateFormat dateFmt, const int defaultCentury ) {
+    bool ok = true;
+
+    if( str.isEmpty() )
+      return true;
+
+    switch( columnFmt ) {
+      case QCsv::DateFormat: {
+        const QDate date = guessDateFromString( str, dateFmt, defaultCentury );
+        ok = date.isValid();
+        if( ok )
+          str = date.toString( QStringLiteral("yyyy-MM-dd") );
+        break;
+      }
+      case QCsv::IntegerFormat: {
+        const qint64 i = fastStrToInt64( str, &ok );
+        if( ok )
+          str = QString::number( i );
+        break;
+      }
+      case QCsv::DoubleFormat: {
+        const double d = fastStrToDouble( str, &ok );
+        if( ok )
+          str = QString::number( d, 'g', QLocale::FloatingPointShortest );
+        break;
+      }
+      default:
+        ok = false;
+        break;
+    }
+
+    return ok;
+  }
+
+
+  // The values of one sort key, prepared for comparison: see QCsv::sortOrder().
+  struct SortColumn {
+    bool numeric;
+    bool descending;
+    QVector<double> numbers;
+    QStringList text;
+  };
+
+
+  // Used by QCsv::sortOrder() to compare rows, key by key.
+  class SortComparator {
+    public:
+      explicit SortComparator( const QVector<SortColumn>& columns ) : _columns( columns ) { /* Nothing else to do here */ }
+
+      bool operator()( const int a, const int b ) const {
+        for( int i = 0; i < _columns.count(); ++i ) {
+          const SortColumn& column = _columns.at(i);
+          int cmp;
+
+          if( column.numeric )
+            cmp = ( column.numbers.at(a) < column.numbers.at(b) ) ? -1 : ( ( column.numbers.at(b) < column.numbers.at(a) ) ? 1 : 0 );
+          else
+            cmp = column.text.at(a).compare( column.text.at(b) );
+
+          if( 0 != cmp )
+            return ( column.descending ? ( 0 < cmp ) : ( 0 > cmp ) );
+        }
+
+        return false;
+      }
+
+    protected:
+      const QVector<SortColumn>& _columns;
+  };
+
+
+  QString formatName( const QCsv::ColumnFormat columnFmt ) {
+    switch( columnFmt ) {
+      case QCsv::DateFormat: return QStringLiteral("DateFormat");
+      case QCsv::TimeFormat: return QStringLiteral("TimeFormat");
+      case QCsv::DateTimeFormat: return QStringLiteral("DateTimeFormat");
+      case QCsv::IntegerFormat: return QStringLiteral("IntegerFormat");
+      case QCsv::DoubleFormat: return QStringLiteral("DoubleFormat");
+      default: return QStringLiteral("(unknown format)");
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+
 
 QStringList CSV::parseLine( const QString& string, const QChar delimiter /* = ',' */ ) {
   enum State {Normal, Quote} state = Normal;
@@ -38,54 +330,76 @@ QStringList CSV::parseLine( const QString& string, const QChar delimiter /* = ',
   else
     temp = string;
 
-  for (int i = 0; i < temp.size(); i++) {
-    QChar current = temp.at(i);
+  const QChar* chars = temp.constData();
+  const ushort* units = temp.utf16();
+  const int len = temp.size();
+  const ushort delim = delimiter.unicode();
+  const ushort quote = '"';
+
+  // As long as no quote marks have been encountered in a field, it can be sliced
+  // directly out of temp.  Otherwise, it is assembled piece by piece in value.
+  bool simple = true;
+  int fieldStart = 0;
+  int i = 0;
 
+  for(;;) {
     // Normal state
-    if (state == Normal) {
-      // Delimiter encountered
-      if (current == delimiter ) {
-        // add line
-        line.append(value.trimmed());
-        value.clear();
+    if( Normal == state ) {
+      const int j = findAny( units, i, len, delim, quote, quote );
+
+      if( !simple )
+        value.append( chars + i, j - i );
+
+      // Delimiter or end of line encountered
+      if( ( len == j ) || ( delim == units[j] ) ) {
+        if( simple ) {
+          line.append( trimmedSlice( chars, fieldStart, j ) );
+        }
+        else {
+          line.append( value.trimmed() );
+          value.resize( 0 );
+        }
+
+        if( len == j )
+          break;
+
+        simple = true;
+        fieldStart = j + 1;
       }
       // One quote mark encountered.  Ignore delimiters until the matching quote mark is encountered.
-      else if (current == '"') {
-        state = Quote;
-      }
-      // other character encountered
       else {
-        value += current;
+        if( simple ) {
+          value.append( chars + fieldStart, j - fieldStart );
+          simple = false;
+        }
+        state = Quote;
       }
+
+      i = j + 1;
     }
     // Quote
-    else if (state == Quote) {
+    else {
+      const int j = findAny( units, i, len, quote, quote, quote );
+
+      value.append( chars + i, j - i );
+
+      // The closing quote mark is missing: keep whatever there is.
+      if( len == j ) {
+        line.append( value.trimmed() );
+        break;
+      }
       // double quote
-      if( current == '"' ) {
-        // If at the end of the line
-        if( i == temp.size() - 1 ) {
-          state = Normal;
-        }
-        else {
-          int index = i+1; // (i+1 < temp.size() - 1) ? i+1 : temp.size() - 1;
-          QChar next = temp.at(index);
-          if (next == '"') {
-            value += '"';
-            i++;
-          } else {
-            state = Normal;
-          }
-        }
+      else if( ( j + 1 < len ) && ( quote == units[j + 1] ) ) {
+        value.append( QLatin1Char( '"' ) );
+        i = j + 2;
       }
-      // other
       else {
-        value += current;
+        state = Normal;
+        i = j + 1;
       }
     }
   }
 
-  line.append(value.trimmed());
-
   return line;
 }
 
@@ -95,51 +409,64 @@ QList<QStringList> parse(const QString &string, const QChar delimiter /* = ',' *
   QStringList line;
   QString value;
 
-  for (int i = 0; i < string.size(); i++) {
-    QChar current = string.at(i);
+  const QChar* chars = string.constData();
+  const ushort* units = string.utf16();
+  const int len = string.size();
+  const ushort delim = delimiter.unicode();
+  const ushort quote = '"';
+  const ushort newline = '\n';
+
+  int i = 0;
 
+  while( i < len ) {
     // Normal
-    if (state == Normal) {
+    if( Normal == state ) {
+      const int j = findAny( units, i, len, delim, quote, newline );
+
+      value.append( chars + i, j - i );
+
+      if( len == j ) {
+        break;
+      }
       // newline
-      if (current == '\n') {
+      else if( newline == units[j] ) {
         // add value
-        line.append(value.trimmed());
-        value.clear();
+        line.append( value.trimmed() );
+        value.resize( 0 );
         // add line
-        data.append(line);
+        data.append( line );
         line.clear();
       }
       // comma
-      else if (current == delimiter) {
+      else if( delim == units[j] ) {
         // add line
-        line.append(value.trimmed());
-        value.clear();
+        line.append( value.trimmed() );
+        value.resize( 0 );
       }
       // double quote
-      else if (current == '"') {
-        state = Quote;
-      }
-      // character
       else {
-        value += current;
+        state = Quote;
       }
+
+      i = j + 1;
     }
     // Quote
-    else if (state == Quote) {
+    else {
+      const int j = findAny( units, i, len, quote, quote, quote );
+
+      value.append( chars + i, j - i );
+
+      if( len == j ) {
+        break;
+      }
       // double quote
-      if (current == '"') {
-        int index = (i+1 < string.size()) ? i+1 : string.size();
-        QChar next = string.at(index);
-        if (next == '"') {
-          value += '"';
-          i++;
-        } else {
-          state = Normal;
-        }
+      else if( ( j + 1 < len ) && ( quote == units[j + 1] ) ) {
+        value.append( QLatin1Char( '"' ) );
+        i = j + 2;
       }
-      // other
       else {
-        value += current;
+        state = Normal;
+        i = j + 1;
       }
     }
   }
@@ -168,11 +495,37 @@ QList<QStringList> CSV::parseFromFile( const QString &filename, const QChar deli
   QString string;
   QFile file(filename);
   if (file.open(QIODevice::ReadOnly)) {
-    QTextStream in(&file);
-    if( !codec.isEmpty() )
-      in.setCodec(QTextCodec::codecForName(codec.toLatin1()));
-    string = in.readAll();
+    QByteArray bytes;
+
+    // Compressed files are recognized by their contents, and decompressed on a separate thread as they are read.
+    const CompressionFormat compression = compressionFormat( file.peek( 4 ) );
+
+    if( NoCompression == compression ) {
+      bytes = file.readAll();
+    }
+    else {
+      QDecompressingReader reader( &file, compression );
+      if( reader.open( QIODevice::ReadOnly ) )
+        bytes = reader.readAll();
+    }
+
     file.close();
+
+    // UTF-8 (the usual case) is decoded in a single pass over the whole file, rather than through QTextStream.
+    // As with QTextStream, the locale's codec is used if none is given, and a byte order mark is respected.
+    const QTextCodec* textCodec = ( codec.isEmpty() ? QTextCodec::codecForLocale() : QTextCodec::codecForName( codec.toLatin1() ) );
+    const bool utf16Bom = ( bytes.startsWith( "\xFF\xFE" ) || bytes.startsWith( "\xFE\xFF" ) );
+
+    if( ( nullptr != textCodec ) && ( 106 == textCodec->mibEnum() ) && !utf16Bom ) {
+      const int bomLength = ( bytes.startsWith( "\xEF\xBB\xBF" ) ? 3 : 0 );
+      string = QString::fromUtf8( bytes.constData() + bomLength, bytes.size() - bomLength );
+    }
+    else {
+      QTextStream in( bytes );
+      if( !codec.isEmpty() )
+        in.setCodec(QTextCodec::codecForName(codec.toLatin1()));
+      string = in.readAll();
+    }
   }
   return parse(initString(string), delimiter );
 }
@@ -218,23 +571,162 @@ QString CSV::writeLine( const QStringList& elements, const QChar delimiter /* =
 
 
 bool CSV::write( const QList<QStringList>& data, const QString &filename, const QChar delimiter /* = ',' */, const QString& codec ) {
-  QFile file(filename);
-  if (!file.open( QFile::WriteOnly | QFile::Text )) {
+  QCsvWriter writer;
+  writer.setDelimiter( delimiter );
+  writer.setCodec( codec );
+  writer.setLegacyQuoting( true ); // Values are quoted as they are by writeLine()
+
+  if( !writer.open( filename, QFile::WriteOnly | QFile::Text ) ) {
     return false;
   }
 
-  QTextStream out(&file);
-  if( !codec.isEmpty() )
-    out.setCodec(codec.toLatin1());
-
   foreach (const QStringList &line, data) {
-    QString output = writeLine( line, delimiter, OriginalCase );
-    out << output << "\r\n";
+    writer.writeRow( line );
   }
 
-  file.close();
+  return writer.close();
+}
 
-  return true;
+
+qint64 CSV::findRecordEnd( const char* data, const qint64 length, const qint64 start ) {
+  int nQuotes = 0;
+  qint64 i = start;
+
+  while( i < length ) {
+    i = findAny( data, i, length, '"', '\n', '\n', '\n', '\n' );
+
+    if( length == i )
+      break;
+    else if( '"' == data[i] )
+      ++nQuotes;
+    else if( 0 == nQuotes%2 )
+      return i + 1;
+
+    ++i;
+  }
+
+  return length;
+}
+
+
+int CSV::splitRecord( const char* record, const int length, const char delimiter, QVector<FieldSpan>& spans, const bool quoteAware /* = true */, const int maxFields /* = -1 */ ) {
+  spans.clear();
+
+  bool inQuote = false;
+  FieldSpan span;
+  span.start = 0;
+  span.escaped = false;
+
+  int i = 0;
+
+  while( i < length ) {
+    i = int( findAny( record, i, length, delimiter, '"', '\n', '\r', '\0' ) );
+
+    if( length == i )
+      break;
+
+    const char c = record[i];
+
+    if( ( delimiter == c ) && !inQuote ) {
+      span.length = i - span.start;
+      spans.append( span );
+
+      if( maxFields == spans.count() )
+        return maxFields;
+
+      span.start = i + 1;
+      span.escaped = false;
+    }
+    else if( '"' == c ) {
+      span.escaped = true;
+      if( quoteAware )
+        inQuote = !inQuote;
+    }
+    else if( ( '\n' == c ) || ( '\r' == c ) || ( '\0' == c ) ) {
+      span.escaped = true;
+    }
+
+    ++i;
+  }
+
+  span.length = length - span.start;
+  spans.append( span );
+
+  return spans.count();
+}
+
+
+bool CSV::isAscii( const char* data, const qint64 length ) {
+  return allAscii( data, 0, length );
+}
+
+
+QString CSV::spanToString( const char* record, const FieldSpan& span, const QString& eolDelimiter /* = " " */, const bool isAscii /* = false */ ) {
+  const char* p = record + span.start;
+
+  // Most fields in most files need no special handling.
+  if( !span.escaped ) {
+    if( isAscii )
+      return QString::fromLatin1( p, span.length ).trimmed();
+    else
+      return QString::fromUtf8( p, span.length ).trimmed();
+  }
+
+  QByteArray value;
+  value.reserve( span.length );
+  unescapeSpan( record, span, eolDelimiter.toUtf8(), value );
+
+  return QString::fromUtf8( value ).trimmed();
+}
+
+
+// Follows the same rules as parseLine().  Embedded line breaks are handled in the same way as
+// QCsv::readLine(): each physical line is trimmed, and the lines are joined with eol.
+void CSV::unescapeSpan( const char* record, const FieldSpan& span, const QByteArray& eol, QByteArray& value ) {
+  const char* p = record + span.start;
+  bool inQuote = false;
+
+  value.resize( 0 );
+
+  for( int i = 0; i < span.length; ++i ) {
+    const char c = p[i];
+
+    if( '\0' == c ) {
+      continue;
+    }
+    else if( ( '\r' == c ) || ( '\n' == c ) ) {
+      while( !value.isEmpty() && ( ( ' ' == value.at( value.size() - 1 ) ) || ( '\t' == value.at( value.size() - 1 ) ) ) )
+        value.chop( 1 );
+
+      if( ( '\r' == c ) && ( i + 1 < span.length ) && ( '\n' == p[i+1] ) )
+        ++i;
+
+      value.append( eol );
+
+      while( ( i + 1 < span.length ) && ( ( ' ' == p[i+1] ) || ( '\t' == p[i+1] ) ) )
+        ++i;
+    }
+    else if( inQuote ) {
+      if( '"' == c ) {
+        if( ( i + 1 < span.length ) && ( '"' == p[i+1] ) ) {
+          value.append( '"' );
+          ++i;
+        }
+        else {
+          inQuote = false;
+        }
+      }
+      else {
+        value.append( c );
+      }
+    }
+    else if( '"' == c ) {
+      inQuote = true;
+    }
+    else {
+      value.append( c );
+    }
+  }
 }
 
 
@@ -288,7 +780,8 @@ void QCsv::processString(
     for( int i = 0; i < items.at(0).count(); ++i ) {
       str = items.at(0).at(i).trimmed();
       _fieldNames.append( str );
-      _fieldsLookup.insert( str.toLower(), i );
+      if( !_fieldsLookup.contains( str.toLower() ) )
+        _fieldsLookup.insert( str.toLower(), i );
     }
   }
 
@@ -402,8 +895,10 @@ bool QCsv::renameFields( const QStringList& newFieldNames ) {
 
     for( int i = 0; i < newFieldNames.count(); ++i ) {
       _fieldNames.append( newFieldNames.at(i).trimmed() );
-      _fieldsLookup.insert( newFieldNames.at(i).trimmed().toLower(), i );
+      if( !_fieldsLookup.contains( _fieldNames.last().toLower() ) )
+        _fieldsLookup.insert( _fieldNames.last().toLower(), i );
     }
+    _lookupCache.clear();
     return true;
   }
 }
@@ -418,9 +913,7 @@ bool QCsv::renameField( QString oldName, QString newName ) {
     int idx = fieldIndexOf( oldName.toLower() );
 
     _fieldNames.replace( idx, newName );
-    int hashVal = _fieldsLookup.value( oldName.toLower() );
-    _fieldsLookup.remove( oldName.toLower() );
-    _fieldsLookup.insert( newName.toLower(), hashVal );
+    rebuildFieldsLookup();
 
     return true;
   }
@@ -432,9 +925,7 @@ bool QCsv::renameField( QString oldName, QString newName ) {
     int idx = fieldIndexOf( oldName.toLower() );
 
     _fieldNames.replace( idx, newName );
-    int hashVal = _fieldsLookup.value( oldName.toLower() );
-    _fieldsLookup.remove( oldName.toLower() );
-    _fieldsLookup.insert( newName.toLower(), hashVal );
+    rebuildFieldsLookup();
 
     return true;
   }
@@ -449,14 +940,22 @@ void QCsv::setFieldNames( const QStringList& fieldNames ) {
   for( int i = 0; i < fieldNames.count(); ++i ) {
      str = fieldNames.at(i).trimmed();
     _fieldNames.append( str );
-    _fieldsLookup.insert( str.toLower(), i );
+    if( !_fieldsLookup.contains( str.toLower() ) )
+      _fieldsLookup.insert( str.toLower(), i );
   }
+  _lookupCache.clear();
 }
 
 
 void QCsv::initialize() {
   _srcFilename = QString();
   _srcFile = nullptr;
+  _srcDevice = nullptr;
+  _decompressor = nullptr;
+  _transcoder = nullptr;
+  _codec.clear();
+  _autoDetectDialect = false;
+  _dialect.clear();
   _isOpen = false;
 
   clearError();
@@ -473,6 +972,58 @@ void QCsv::initialize() {
 
   _linesToSkip = 0;
   _linesSkipped = 0;
+
+  _map = nullptr;
+  _mapSize = 0;
+  _mapPos = 0;
+  _dataStart = 0;
+  _dataStartRow = -1;
+  _rowOffset = 0;
+  _rowLength = 0;
+  _rowSpans.clear();
+
+  _byteRecords = false;
+  _spanRow = false;
+  _recordBytes.clear();
+  _recordIsAscii = false;
+  _recordComplete = true;
+
+  _follow = false;
+  _followOffset = 0;
+  _followScanned = 0;
+  _followWatch = -1;
+
+  _parallelLoad = false;
+  _useCache = false;
+  _loadedFromCache = false;
+  _cacheSaveError.clear();
+
+  _validator = nullptr;
+  _validationRow = nullptr;
+
+  _lookupCache.clear();
+
+  _columnarStorage = false;
+  _columnar = false;
+  _columns.clear();
+  _columns.setDictionaryLimit( 1024 );
+  _autoFieldTypes = false;
+
+  _indexedFields.clear();
+  _fieldIndexes.clear();
+
+  _rowIndex.clear();
+  _rowIndexSaveError.clear();
+
+  _selectedFieldNames.clear();
+  _selectedFieldIndexes.clear();
+  _projection.clear();
+  _sourceFieldCount = 0;
+
+  _rowFilters.clear();
+  _maxFilterField = -1;
+  _rowRejected = false;
+  _nRowsFiltered = 0;
 }
 
 
@@ -482,6 +1033,10 @@ QCsv::QCsv( const QCsv& other ) {
 
 
 QCsv& QCsv::operator=( const QCsv& other ) {
+  // Anything this object has open is released first: assign() starts the copy without a file of its own.
+  finishWithFile();
+
+  delete _validationRow; // See assign()
   assign( other );
 
   return *this;
@@ -490,7 +1045,16 @@ QCsv& QCsv::operator=( const QCsv& other ) {
 
 void QCsv::assign( const QCsv& other ) {
   _srcFilename = other._srcFilename;
+
+  // Files and devices aren't shared.  operator=() has already stopped this object's decompressor (whose
+  // worker would otherwise wait forever for its queue to empty) and closed its file: see finishWithFile().
   _srcFile = nullptr;
+  _srcDevice = nullptr;
+  _decompressor = nullptr;
+  _transcoder = nullptr;
+  _codec = other._codec;
+  _autoDetectDialect = other._autoDetectDialect;
+  _dialect = other._dialect;
   _isOpen = other._isOpen;
 
   _currentLine = other._currentLine;
@@ -507,13 +1071,68 @@ void QCsv::assign( const QCsv& other ) {
 
   _linesToSkip = other._linesToSkip;
   _linesSkipped = other._linesToSkip;
+  _parallelLoad = other._parallelLoad;
+  _useCache = other._useCache;
+  _loadedFromCache = other._loadedFromCache;
+  _cacheSaveError = other._cacheSaveError;
+
+  // A validator collects results from one object at a time.
+  _validator = nullptr;
+  _validationRow = nullptr;
 
   _fieldsLookup = other._fieldsLookup;
+  _lookupCache = other._lookupCache;
   _fieldNames = other._fieldNames;
   _fieldData = other._fieldData;
   _data = other._data;
 
-  if( other._isOpen && ( LineByLine == other._mode ) ) {
+  _columnarStorage = other._columnarStorage;
+  _columnar = other._columnar;
+  _columns = other._columns;
+  _autoFieldTypes = other._autoFieldTypes;
+  _indexedFields = other._indexedFields;
+  _fieldIndexes = other._fieldIndexes;
+
+  // A copy that reopens the file needs to load its own row index.
+  _rowIndex.clear();
+  _rowIndexSaveError.clear();
+
+  _selectedFieldNames = other._selectedFieldNames;
+  _selectedFieldIndexes = other._selectedFieldIndexes;
+  _projection = other._projection;
+  _sourceFieldCount = other._sourceFieldCount;
+
+  _rowFilters = other._rowFilters;
+  _maxFilterField = other._maxFilterField;
+  _rowRejected = false;
+  _nRowsFiltered = other._nRowsFiltered;
+
+  // A mapped file can't be shared: the copy will map the file for itself, if necessary.
+  // (operator=() has already unmapped any file mapped by this object.)
+  _map = nullptr;
+  _mapSize = 0;
+  _mapPos = 0;
+  _dataStart = 0;
+  _dataStartRow = -1;
+  _rowOffset = 0;
+  _rowLength = 0;
+  _rowSpans.clear();
+
+  // Nor can the buffer holding a record that was read as bytes.
+  _byteRecords = false;
+  _spanRow = false;
+  _recordBytes.clear();
+  _recordIsAscii = false;
+  _recordComplete = true;
+
+  // A followed file is reopened below, and is followed from the top.  Any watch set up by this object
+  // has already been closed by operator=().
+  _follow = other._follow;
+  _followOffset = 0;
+  _followScanned = 0;
+  _followWatch = -1;
+
+  if( other._isOpen && ( ( LineByLine == other._mode ) || ( MemoryMapped == other._mode ) ) ) {
     this->open();
   }
 }
@@ -527,6 +1146,8 @@ QCsv::~QCsv() {
     delete _srcFile;
     _srcFile = nullptr;
   }
+
+  delete _validationRow;
 }
 
 
@@ -542,14 +1163,14 @@ void QCsv::debug( int nLines /* = 0 */ ) {
   qDb() << this->fieldNames().join( _delimiter ).prepend( "  " );
 
   if( this->rowCount() > 0 ) {
-    if( LineByLine == _mode )
+    if( EntireFile != _mode )
       qDb() << "(There is nothing to display)";
     else {
-      if( (1 > nLines) || ( _data.count() < nLines ) )
-        nLines = _data.count();
+      if( (1 > nLines) || ( dataRowCount() < nLines ) )
+        nLines = dataRowCount();
 
       for( int i = 0; i < nLines; ++i ) {
-        qDb() << _data.at(i).join( _delimiter ).prepend( "  " );
+        qDb() << dataRow(i).join( _delimiter ).prepend( "  " );
       }
     }
   }
@@ -564,9 +1185,14 @@ QString QCsv::currentRow() {
   clearError();
   switch( _mode ) {
     case LineByLine:
-      return _currentLine;
+      if( _spanRow )
+        return QString::fromUtf8( currentRecord(), _rowLength ).trimmed();
+      else
+        return _currentLine;
     case EntireFile:
-      return CSV::writeLine( _data.at( _currentRowNumber ) );
+      return CSV::writeLine( dataRow( _currentRowNumber ) );
+    case MemoryMapped:
+      return QString::fromUtf8( currentRecord(), _rowLength ).trimmed();
     default:
       return QString();
   }
@@ -574,24 +1200,37 @@ QString QCsv::currentRow() {
 
 
 QStringList QCsv::rowData() {
-  if( LineByLine == _mode )
+  if( rowInSpans() ) {
+    QStringList result;
+    for( int i = 0; i < _rowSpans.count(); ++i ) {
+      result.append( spanField( i ) );
+    }
+    return result;
+  }
+  else if( LineByLine == _mode )
     return _fieldData;
   else
-    return _data.at( currentRowNumber() )
+    return dataRow( currentRowNumber() )
   ;
 }
 
 
 QStringList QCsv::rowData( const int idx ) {
-  Q_ASSERT( EntireFile == _mode );
+  Q_ASSERT( ( EntireFile == _mode ) || hasRowIndex() );
   clearError();
 
-  if( ( 0 > idx ) || ( _data.count() < idx ) ) {
+  if( ( EntireFile != _mode ) && hasRowIndex() ) {
+    if( seekToRow( idx ) && ( -1 != readNext() ) )
+      return rowData();
+    else
+      return QStringList();
+  }
+  else if( ( 0 > idx ) || ( dataRowCount() <= idx ) ) {
     _error = ERROR_INDEX_OUT_OF_RANGE;
     return QStringList();
   }
   else {
-    return _data.at( idx );
+    return dataRow( idx );
   }
 }
 
@@ -599,11 +1238,11 @@ QStringList QCsv::rowData( const int idx ) {
 QStringList QCsv::rowData( const int idx ) const {
   Q_ASSERT( EntireFile == _mode );
 
-  if( ( 0 > idx ) || ( _data.count() < idx ) ) {
+  if( ( 0 > idx ) || ( dataRowCount() <= idx ) ) {
     return QStringList();
   }
   else {
-    return _data.at( idx );
+    return dataRow( idx );
   }
 }
 
@@ -613,6 +1252,38 @@ QString QCsv::field( const int index ){
   QString ret_val;
   clearError();
 
+  if( rowInSpans() ) {
+    if( _rowSpans.isEmpty() ) {
+      _error = ERROR_LINE_EMPTY;
+      _errorMsg = "The current line, " + QString::number ( _currentRowNumber ) + " is empty.  Did you read a line first?";
+    }
+    else if( ( 0 > index ) || ( _rowSpans.count() <= index ) ) {
+      _error = ERROR_INDEX_OUT_OF_RANGE;
+      _errorMsg = "For File Linenumber: " + QString::number ( _currentRowNumber ) + ", Field index, " + QString::number ( index ) + ", out of range";
+    }
+    else {
+      ret_val = spanField( index );
+    }
+
+    return ret_val;
+  }
+
+  if( _columnar ) {
+    if( ( 0 > _currentRowNumber ) || ( _columns.nRows() <= _currentRowNumber ) ) {
+      _error = ERROR_LINE_EMPTY;
+      _errorMsg = "The current line, " + QString::number ( _currentRowNumber ) + " is empty.  Did you read a line first?";
+    }
+    else if( ( 0 > index ) || ( _columns.nCols() <= index ) ) {
+      _error = ERROR_INDEX_OUT_OF_RANGE;
+      _errorMsg = "For File Linenumber: " + QString::number ( _currentRowNumber ) + ", Field index, " + QString::number ( index ) + ", out of range";
+    }
+    else {
+      ret_val = _columns.value( index, _currentRowNumber ).trimmed();
+    }
+
+    return ret_val;
+  }
+
   if( LineByLine == _mode )
     dataList = &_fieldData;
   else
@@ -639,6 +1310,20 @@ QString QCsv::field( const int index ) const {
   const QStringList* dataList;
   QString ret_val;
 
+  if( rowInSpans() ) {
+    if( ( 0 <= index ) && ( _rowSpans.count() > index ) )
+      ret_val = spanField( index );
+
+    return ret_val;
+  }
+
+  if( _columnar ) {
+    if( ( 0 <= _currentRowNumber ) && ( _columns.nRows() > _currentRowNumber ) && ( 0 <= index ) && ( _columns.nCols() > index ) )
+      ret_val = _columns.value( index, _currentRowNumber ).trimmed();
+
+    return ret_val;
+  }
+
   if( LineByLine == _mode )
     dataList = &_fieldData;
   else
@@ -655,20 +1340,14 @@ QString QCsv::field( const int index ) const {
 
 
 QString QCsv::field( const QString& fieldName ){
-  QStringList* dataList;
   QString ret_val;
   clearError();
 
-  if( LineByLine == _mode )
-    dataList = &_fieldData;
-  else
-    dataList = &( _data[ _currentRowNumber ] );
-
   if ( _containsFieldList ){
-    if ( dataList->size() > 0 ){
-      if ( _fieldsLookup.contains( fieldName.trimmed().toLower() ) ){
-        int index = _fieldsLookup.value( fieldName.trimmed().toLower() );
+    if ( currentFieldCount() > 0 ){
+      const int index = fieldIndexOf( fieldName );
 
+      if ( -1 != index ){
         ret_val = field( index );
       }
       else{
@@ -691,16 +1370,10 @@ QString QCsv::field( const QString& fieldName ){
 
 
 QString QCsv::field( const QString& fieldName ) const {
-  const QStringList* dataList;
   QString ret_val;
 
-  if( LineByLine == _mode )
-    dataList = &_fieldData;
-  else
-    dataList = &( _data[ _currentRowNumber ] );
-
   if ( _containsFieldList ){
-    if ( dataList->size() > 0 ){
+    if ( currentFieldCount() > 0 ){
       if ( _fieldsLookup.contains( fieldName.trimmed().toLower() ) ){
         int index = _fieldsLookup.value( fieldName.trimmed().toLower() );
 
@@ -713,19 +1386,51 @@ QString QCsv::field( const QString& fieldName ) const {
 }
 
 
-bool QCsv::setField( const int index, const QString& val ) {
-  QStringList* dataList;
+QString QCsv::field( const FieldHandle& handle ) {
   clearError();
-  bool result = true; // until shown otherwise.
 
-  if( LineByLine == _mode )
-    dataList = &_fieldData;
-  else
-    dataList = &( _data[ _currentRowNumber ] );
+  if( !handle.isValid() ) {
+    _error = ERROR_INVALID_FIELD_NAME;
+    _errorMsg = "Invalid Field Name: " + handle.fieldName();
+    return QString();
+  }
 
-  if( 0 < dataList->size() ) {
-    if ( index < dataList->size() ) {
-      if( LineByLine == _mode ) {
+  return field( handle.index() );
+}
+
+
+QString QCsv::field( const FieldHandle& handle ) const {
+  if( !handle.isValid() )
+    return QString();
+
+  return field( handle.index() );
+}
+
+
+bool QCsv::setField( const int index, const QString& val ) {
+  QStringList* dataList;
+  clearError();
+  bool result = true; // until shown otherwise.
+
+  if( MemoryMapped == _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Fields cannot be changed in MemoryMapped mode.") );
+    return false;
+  }
+
+  if( _spanRow )
+    decodeSpanRow();
+
+  useRowStorage();
+  invalidateIndexes();
+
+  if( LineByLine == _mode )
+    dataList = &_fieldData;
+  else
+    dataList = &( _data[ _currentRowNumber ] );
+
+  if( 0 < dataList->size() ) {
+    if ( index < dataList->size() ) {
+      if( LineByLine == _mode ) {
         _fieldData[index] = val.trimmed();
         _currentLine = CSV::writeLine( _fieldData );
       }
@@ -750,21 +1455,15 @@ bool QCsv::setField( const int index, const QString& val ) {
 
 
 bool QCsv::setField( const QString& fieldName, const QString& val ) {
-  QStringList* dataList;
   clearError();
   bool result = true; // until shown otherwise.
 
-  if( LineByLine == _mode )
-    dataList = &_fieldData;
-  else
-    dataList = & (_data[ _currentRowNumber ] );
-
   if ( _containsFieldList ){
-    if ( dataList->size() > 0 ){
-      if ( _fieldsLookup.contains( fieldName.trimmed().toLower() ) ){
-        int index = _fieldsLookup.value( fieldName.trimmed().toLower() );
+    if ( currentFieldCount() > 0 ){
+      const int index = fieldIndexOf( fieldName );
 
-        setField( index, val );
+      if ( -1 != index ){
+        result = setField( index, val );
       }
       else{
         _error = ERROR_INVALID_FIELD_NAME;
@@ -794,11 +1493,11 @@ bool QCsv::setField( const int index, const int rowNumber, const QString& val )
   clearError();
   bool result = true; // until shown otherwise.
 
-  if( LineByLine == _mode ) {
+  if( EntireFile != _mode ) {
     setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
     result = false;
   }
-  else if( rowNumber > (_data.count() - 1) ) {
+  else if( rowNumber > (dataRowCount() - 1) ) {
     _error = ERROR_INDEX_OUT_OF_RANGE;
     _errorMsg = QStringLiteral( "There is no row %1" ).arg( rowNumber );
     result = false;
@@ -818,11 +1517,11 @@ bool QCsv::setField( const QString& fieldName, const int rowNumber, const QStrin
   clearError();
   bool result = true; // until shown otherwise.
 
-  if( LineByLine == _mode ) {
+  if( EntireFile != _mode ) {
     setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
     result = false;
   }
-  else if ( rowNumber > (_data.count() - 1) ) {
+  else if ( rowNumber > (dataRowCount() - 1) ) {
     _error = ERROR_INDEX_OUT_OF_RANGE;
     _errorMsg = QStringLiteral( "There is no row %1" ).arg( rowNumber );
     result = false;
@@ -836,15 +1535,21 @@ bool QCsv::setField( const QString& fieldName, const int rowNumber, const QStrin
 }
 
 QString QCsv::field( const int index, const int rowNumber ) {
-  // This function will not work with qCSV_LineByLine mode.
-  Q_ASSERT( EntireFile == _mode );
+  // In other modes, this function needs a row index.
+  Q_ASSERT( ( EntireFile == _mode ) || hasRowIndex() );
   clearError();
 
-  if( LineByLine == _mode ) {
-    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+  if( ( EntireFile != _mode ) && hasRowIndex() ) {
+    if( seekToRow( rowNumber ) && ( -1 != readNext() ) )
+      return field( index );
+    else
+      return QString();
+  }
+  else if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function, unless there is a row index.") );
     return QString();
   }
-  else if( rowNumber > (_data.count() - 1) ) {
+  else if( rowNumber > (dataRowCount() - 1) ) {
     _error = ERROR_INDEX_OUT_OF_RANGE;
     _errorMsg = QStringLiteral( "There is no row %1" ).arg( rowNumber );
     return QString();
@@ -856,15 +1561,21 @@ QString QCsv::field( const int index, const int rowNumber ) {
 }
 
 QString QCsv::field( const QString& fieldName, const int rowNumber ) {
-  // This function will not work with qCSV_LineByLine mode.
-  Q_ASSERT( EntireFile == _mode );
+  // In other modes, this function needs a row index.
+  Q_ASSERT( ( EntireFile == _mode ) || hasRowIndex() );
   clearError();
 
-  if( LineByLine == _mode ) {
-    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+  if( ( EntireFile != _mode ) && hasRowIndex() ) {
+    if( seekToRow( rowNumber ) && ( -1 != readNext() ) )
+      return field( fieldName );
+    else
+      return QString();
+  }
+  else if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function, unless there is a row index.") );
     return QString();
   }
-  else if( rowNumber > (_data.count() - 1) ) {
+  else if( rowNumber > (dataRowCount() - 1) ) {
     _error = ERROR_INDEX_OUT_OF_RANGE;
     _errorMsg = QStringLiteral( "There is no row %1" ).arg( rowNumber );
     return QString();
@@ -894,20 +1605,53 @@ QString QCsv::fieldName( const int index ) const {
 }
 
 
-int QCsv::fieldIndexOf( const QString& fieldName ) {
-  int result = -1;
+// Where names are duplicated, the first field with the name is the one that is found.
+void QCsv::rebuildFieldsLookup() {
+  _fieldsLookup.clear();
+  _lookupCache.clear();
 
   for( int i = 0; i < _fieldNames.count(); ++i ) {
-    if( 0 == fieldName.trimmed().compare( _fieldNames.at(i), Qt::CaseInsensitive ) ) {
-      result = i;
-      break;
-    }
+    if( !_fieldsLookup.contains( _fieldNames.at(i).toLower() ) )
+      _fieldsLookup.insert( _fieldNames.at(i).toLower(), i );
+  }
+}
+
+
+int QCsv::fieldIndexOf( const QString& fieldName ) {
+  QHash<QString, QPair<int, QString> >::const_iterator it = _lookupCache.constFind( fieldName );
+
+  if( ( _lookupCache.constEnd() != it ) && ( it.value().first < _fieldNames.count() ) && ( _fieldNames.at( it.value().first ) == it.value().second ) )
+    return it.value().first;
+
+  const int result = _fieldsLookup.value( fieldName.trimmed().toLower(), -1 );
+
+  if( ( -1 != result ) && ( result < _fieldNames.count() ) ) {
+    // Names that aren't fields aren't kept, so there is no need for much of a limit.
+    if( 256 <= _lookupCache.count() )
+      _lookupCache.clear();
+
+    _lookupCache.insert( fieldName, qMakePair( result, _fieldNames.at( result ) ) );
   }
 
   return result;
 }
 
 
+QCsv::FieldHandle QCsv::fieldHandle( const QString& fieldName ) {
+  clearError();
+
+  const int index = fieldIndexOf( fieldName );
+
+  if( -1 == index ) {
+    _error = ERROR_INVALID_FIELD_NAME;
+    _errorMsg = "Invalid Field Name: " + fieldName;
+    return FieldHandle();
+  }
+
+  return FieldHandle( _fieldNames.at( index ), index );
+}
+
+
 bool QCsv::containsFieldName( const QString& fieldName ) {
   return _fieldsLookup.contains( fieldName.trimmed().toLower() );
 }
@@ -918,14 +1662,16 @@ bool QCsv::appendField( const QString& fieldName ) {
   Q_ASSERT( EntireFile == _mode );
   clearError();
 
-  if( LineByLine == _mode ) {
+  if( EntireFile != _mode ) {
     setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
     return false;
   }
   else {
     _fieldNames.append( fieldName.trimmed() );
-    _fieldsLookup.insert( fieldName.trimmed().toLower(), _fieldNames.count() - 1 );
+    if( !_fieldsLookup.contains( fieldName.trimmed().toLower() ) )
+      _fieldsLookup.insert( fieldName.trimmed().toLower(), _fieldNames.count() - 1 );
 
+    useRowStorage();
     for( int i = 0; i < _data.count(); ++i ) {
       _data[i].append( QString() );
     }
@@ -940,7 +1686,7 @@ bool QCsv::removeField( const QString& fieldName ) {
   Q_ASSERT( EntireFile == _mode );
   clearError();
 
-  if( LineByLine == _mode ) {
+  if( EntireFile != _mode ) {
     setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
     return false;
   }
@@ -961,7 +1707,7 @@ bool QCsv::removeField( const int index ) {
   Q_ASSERT( EntireFile == _mode );
   clearError();
 
-  if( LineByLine == _mode ) {
+  if( EntireFile != _mode ) {
     setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
     return false;
   }
@@ -969,15 +1715,25 @@ bool QCsv::removeField( const int index ) {
     if( _containsFieldList ) {
       _fieldNames.removeAt( index );
 
-      QList<QString> keys = _fieldsLookup.keys( index );
-      for( int i = 0; i < keys.count(); ++i ) {
-        _fieldsLookup.remove( keys.at(i) );
-      }
+      // Fields after this one have moved, so the lookup is rebuilt.
+      rebuildFieldsLookup();
     }
 
+    useRowStorage();
     for( int i = 0; i < _data.count(); ++i ) {
       _data[i].removeAt( index );
     }
+
+    // Indexes on fields after this one now refer to different field numbers.
+    const QList<int> indexedFields = _indexedFields.values();
+    dropIndexes();
+    for( int i = 0; i < indexedFields.count(); ++i ) {
+      if( indexedFields.at(i) < index )
+        _indexedFields.insert( indexedFields.at(i) );
+      else if( indexedFields.at(i) > index )
+        _indexedFields.insert( indexedFields.at(i) - 1 );
+    }
+
     return true;
   }
   else {
@@ -993,17 +1749,17 @@ bool QCsv::append( const QStringList& values ) {
   Q_ASSERT( EntireFile == _mode );
   clearError();
 
-  if( LineByLine == _mode ) {
+  if( EntireFile != _mode ) {
     setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
     return false;
   }
-  else if( _data.isEmpty() || ( values.count() == fieldCount() ) ) {
+  else if( ( 0 == dataRowCount() ) || ( values.count() == fieldCount() ) ) {
     QStringList trimmedVals;
     for( int i = 0; i < values.count(); ++i ) {
       trimmedVals.append( values.at(i).trimmed() );
     }
 
-    _data.append( trimmedVals );
+    storeRow( trimmedVals );
     return true;
   }
   else {
@@ -1014,6 +1770,57 @@ bool QCsv::append( const QStringList& values ) {
 }
 
 
+// Called once the header (if any) has been read.  Every line read so far has been counted by _currentRowNumber.
+void QCsv::beginValidation() {
+  if( nullptr != _validator )
+    _validator->beginValidation( _fieldNames, ( _containsFieldList ? _currentRowNumber + 1 : -1 ) );
+}
+
+
+// Passes the row that was just read to the validator.  Fields that are still raw bytes are decoded into a
+// buffer that is reused from row to row, as they are by moveNext( QCsvRowBuffer& ).
+void QCsv::validateCurrentRow() {
+  if( nullptr == _validator )
+    return;
+
+  if( nullptr == _validationRow )
+    _validationRow = new QCsvRowBuffer();
+
+  QCsvRowBuffer& row = *_validationRow;
+  row.clear();
+
+  if( rowInSpans() ) {
+    const char* record = currentRecord();
+    for( int i = 0; i < _rowSpans.count(); ++i )
+      row.appendSpan( record, _rowSpans.at(i), _eolDelimiter, _recordIsAscii );
+  }
+  else {
+    for( int i = 0; i < _fieldData.count(); ++i )
+      row.appendRef( &_fieldData.at(i) );
+  }
+
+  _validator->validateRow( row, _currentRowNumber + 1 );
+}
+
+
+// As above, for a row that isn't the current row (i.e., one parsed by readAllInParallel()).
+void QCsv::validateRow( const QStringList& values ) {
+  if( nullptr == _validator )
+    return;
+
+  if( nullptr == _validationRow )
+    _validationRow = new QCsvRowBuffer();
+
+  QCsvRowBuffer& row = *_validationRow;
+  row.clear();
+
+  for( int i = 0; i < values.count(); ++i )
+    row.appendRef( &values.at(i) );
+
+  _validator->validateRow( row, _currentRowNumber + 1 );
+}
+
+
 bool QCsv::identicalFieldNames( const QStringList& otherNames ) {
   bool result = ( this->fieldCount() == otherNames.count() );
 
@@ -1071,8 +1878,8 @@ bool QCsv::merge( const QCsv& other ) {
   }
 
   QSet<QString> haystack;
-  foreach( QStringList myData, _data ) {
-    QString data = myData.join( '|' ) ;
+  for( int i = 0; i < dataRowCount(); ++i ) {
+    QString data = dataRow( i ).join( '|' ) ;
     haystack.insert( data );
   }
 
@@ -1117,7 +1924,7 @@ QStringList QCsv::fieldValues( const int index, const bool unique /* = false */
   QStringList result;
   clearError();
 
-  if( LineByLine == _mode ) {
+  if( EntireFile != _mode ) {
     result.append( this->field( index ) );
   }
   else {
@@ -1125,14 +1932,50 @@ QStringList QCsv::fieldValues( const int index, const bool unique /* = false */
       _error = ERROR_INDEX_OUT_OF_RANGE;
       _errorMsg = QStringLiteral( "There is no column %1" ).arg( index );
     }
-    else {
-      for( int i = 0; i < _data.count(); ++i ) {
-        if( unique ) {
-          if( !result.contains( _data.at( i ).at( index ) ) )
-            result.append( _data.at( i ).at( index ) );
+    else if( !unique ) {
+      if( _columnar ) {
+        result = _columns.column( index );
+      }
+      else {
+        for( int i = 0; i < dataRowCount(); ++i ) {
+          result.append( dataValue( index, i ) );
         }
-        else {
-          result.append( _data.at( i ).at( index ) );
+      }
+    }
+    else if( isDictionaryField( index ) ) {
+      // Codes are handed out in order of first appearance, so each distinct value is found without comparing any strings.
+      const int nCodes = _columns.dictionarySize( index );
+      QVector<bool> seen( nCodes );
+
+      for( int i = 0; ( i < dataRowCount() ) && ( result.count() < nCodes ); ++i ) {
+        const int code = _columns.code( index, i );
+        if( !seen.at( code ) ) {
+          seen[code] = true;
+          result.append( _columns.dictionaryValue( index, code ) );
+        }
+      }
+    }
+    else if( hasIndex( index ) ) {
+      // The first row in which each value appears, in order.
+      const FieldIndex& fi = fieldIndex( index );
+      QVector<int> rows;
+      rows.reserve( fi.count() );
+      for( FieldIndex::const_iterator it = fi.constBegin(); it != fi.constEnd(); ++it ) {
+        rows.append( it.value().first() );
+      }
+      std::sort( rows.begin(), rows.end() );
+
+      for( int i = 0; i < rows.count(); ++i ) {
+        result.append( dataValue( index, rows.at(i) ) );
+      }
+    }
+    else {
+      QSet<QString> found;
+      for( int i = 0; i < dataRowCount(); ++i ) {
+        const QString val = dataValue( index, i );
+        if( !found.contains( val ) ) {
+          found.insert( val );
+          result.append( val );
         }
       }
     }
@@ -1148,45 +1991,66 @@ QCsv QCsv::distinct() {
   clearError();
 
   QCsv result;
-  if( LineByLine == _mode ) {
+  if( EntireFile != _mode ) {
     setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
     result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
   }
   else {
     result = QCsv( this->fieldNames() );
+    result.setColumnarStorage( _columnarStorage );
 
-    QSet<QStringList> data;
-
-    for( int i = 0; i < _data.count(); ++i ) {
-      if( !data.contains( this->rowData( i ) ) ) {
-        data.insert( this->rowData( i ) );
-        result.append( _data.at(i) );
-      }
-    }
-  }
-
-  result.toFront();
-  return result;
-}
+    // With an index, only rows that share a value in the indexed field need to be compared.
+    const int indexed = ( _indexedFields.isEmpty() ? -1 : *_indexedFields.constBegin() );
 
+    if( -1 != indexed ) {
+      const FieldIndex& fi = fieldIndex( indexed );
+      QVector<int> rows;
 
+      for( FieldIndex::const_iterator it = fi.constBegin(); it != fi.constEnd(); ++it ) {
+        const QVector<int>& candidates = it.value();
 
-QCsv QCsv::filter( const int index, const QString& value, const Qt::CaseSensitivity cs /* = Qt::CaseSensitive */ ) {
-  // This function will not work with qCSV_LineByLine mode.
-  Q_ASSERT( EntireFile == _mode );
-  clearError();
+        if( 1 == candidates.count() ) {
+          rows.append( candidates.first() );
+        }
+        else {
+          QSet<QStringList> data;
+          for( int j = 0; j < candidates.count(); ++j ) {
+            const QStringList row = dataRow( candidates.at(j) );
+            if( !data.contains( row ) ) {
+              data.insert( row );
+              rows.append( candidates.at(j) );
+            }
+          }
+        }
+      }
 
-  QCsv result;
-  if( LineByLine == _mode ) {
-    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
-    result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
-  }
-  else {
-    result = QCsv( this->fieldNames() );
+      std::sort( rows.begin(), rows.end() );
+      for( int i = 0; i < rows.count(); ++i ) {
+        result.append( dataRow( rows.at(i) ) );
+      }
+    }
+    else if( _columnar ) {
+      // Rows are compared by their stored values (dictionary codes, numbers, etc.), without creating any strings.
+      QSet<QByteArray> keys;
+
+      for( int i = 0; i < dataRowCount(); ++i ) {
+        QByteArray key;
+        _columns.appendRowKey( i, key );
+        if( !keys.contains( key ) ) {
+          keys.insert( key );
+          result.append( dataRow( i ) );
+        }
+      }
+    }
+    else {
+      QSet<QStringList> data;
 
-    for( int i = 0; i < _data.count(); ++i ) {
-      if( 0 == value.compare( this->field( index, i ), cs ) ) {
-        result.append( _data.at(i) );
+      for( int i = 0; i < dataRowCount(); ++i ) {
+        const QStringList row = dataRow( i );
+        if( !data.contains( row ) ) {
+          data.insert( row );
+          result.append( row );
+        }
       }
     }
   }
@@ -1196,476 +2060,2616 @@ QCsv QCsv::filter( const int index, const QString& value, const Qt::CaseSensitiv
 }
 
 
-QCsv QCsv::filter( const QString& fieldName, const QString& value, const Qt::CaseSensitivity cs /* = Qt::CaseSensitive */ ) {
-  QCsv result;
 
-  // This function will not work with qCSV_LineByLine mode.
-  Q_ASSERT( EntireFile == _mode );
-  clearError();
+bool QCsv::fieldIndexes( const QStringList& fieldNames, QVector<int>& indexes ) {
+  indexes.clear();
 
-  if( LineByLine == _mode ) {
-    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
-    result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
-  }
-  else if( !_containsFieldList ) {
+  if( !_containsFieldList ) {
     _error = ERROR_NO_FIELDLIST;
     _errorMsg = QStringLiteral("The current settings do not include a field list.");
-    result.setError( _error, _errorMsg );
-  }
-  else if( !_fieldsLookup.contains( fieldName.trimmed().toLower() ) ) {
-    _error = ERROR_INVALID_FIELD_NAME;
-    _errorMsg = "Invalid Field Name: " + fieldName;
-     result.setError( _error, _errorMsg );
-  }
-  else {
-    result = filter( _fieldsLookup.value( fieldName.trimmed().toLower() ), value, cs );
+    return false;
   }
 
-  return result;
-}
-
-
-QCsv QCsv::sorted( const int index ) {
-  // This function will not work with qCSV_LineByLine mode.
-  Q_ASSERT( EntireFile == _mode );
-  clearError();
-
-  QCsv result;
-  if( LineByLine == _mode ) {
-    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
-    result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
-  }
-  else {
-    result = QCsv( this->fieldNames() );
+  for( int i = 0; i < fieldNames.count(); ++i ) {
+    const QString key = fieldNames.at(i).trimmed().toLower();
 
-    QStringList values = this->fieldValues( index, false );
-    QMultiHash<QString, int> mhash;
-    for( int i = 0; i < values.count(); ++i ) {
-      mhash.insert( values.at(i), i );
+    if( !_fieldsLookup.contains( key ) ) {
+      _error = ERROR_INVALID_FIELD_NAME;
+      _errorMsg = "Invalid Field Name: " + fieldNames.at(i);
+      return false;
     }
 
-    QStringList sortOrder = mhash.keys();
-    std::sort( sortOrder.begin(), sortOrder.end() );
-
-    for( int i = 0; i < sortOrder.count(); ++i ) {
-      QList<int> rows = mhash.values( sortOrder.at(i) );
-      std::sort( rows.begin(), rows.end() );
-      for( int j = 0; j < rows.count(); ++j ) {
-        result.append( _data.at( rows.at(j) ) );
-      }
-    }
+    indexes.append( _fieldsLookup.value( key ) );
   }
 
-  result.toFront();
-  return result;
+  return true;
 }
 
 
-QCsv QCsv::sorted( const QString& fieldName ) {
-  QCsv result;
-
-  // This function will not work with qCSV_LineByLine mode.
-  Q_ASSERT( EntireFile == _mode );
-  clearError();
-
-  if( LineByLine == _mode ) {
-    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
-    result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
-  }
-  else if( !_containsFieldList ) {
-    _error = ERROR_NO_FIELDLIST;
-    _errorMsg = QStringLiteral("The current settings do not include a field list.");
-    result.setError( _error, _errorMsg );
-  }
-  else if( !_fieldsLookup.contains( fieldName.trimmed().toLower() ) ) {
-    _error = ERROR_INVALID_FIELD_NAME;
-    _errorMsg = "Invalid Field Name: " + fieldName;
-     result.setError( _error, _errorMsg );
+bool QCsv::nextSourceRow( int& row ) {
+  if( EntireFile == _mode ) {
+    ++row;
+    return ( row < dataRowCount() );
   }
   else {
-    result = sorted( _fieldsLookup.value( fieldName.trimmed().toLower() ) );
+    return ( -1 != moveNext() );
   }
-
-  return result;
 }
 
 
-int QCsv::fieldCount() {
-  if( _containsFieldList )
-    return _fieldNames.count();
-  else if( LineByLine == _mode )
-    return _fieldData.count();
-  else if( 0 < rowCount() )
-    return _data.at(0).count();
+QString QCsv::sourceValue( const int col, const int row ) const {
+  if( EntireFile == _mode )
+    return dataValue( col, row );
   else
-    return 0;
+    return field( col );
 }
 
-int QCsv::rowCount() {
-  int result;
 
-  if( LineByLine == _mode ) {
-    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
-    result = -1;
-  }
-  else
-    result = _data.count();
+namespace {
+  // Values of several key fields, combined into a single hash key.
+  QString compositeKey( const QStringList& values ) {
+    if( 1 == values.count() )
+      return values.first();
+    else
+      return values.join( QChar( 0x1F ) );
+  }
+
+
+  // Running summary of one field for one group of rows.  See QCsv::groupBy().
+  class GroupAccumulator {
+    public:
+      GroupAccumulator( const QCsv::AggregateFunction function = QCsv::AggregateCount, const bool countRows = false ) {
+        _function = function;
+        _countRows = countRows;
+        _nRows = 0;
+        _nValues = 0;
+        _nNumbers = 0;
+        _sum = 0.0;
+        _numMin = 0.0;
+        _numMax = 0.0;
+        _hasText = false;
+      }
 
-  return result;
-}
+      void add( const QString& val ) {
+        ++_nRows;
 
+        if( val.isEmpty() )
+          return;
 
-int QCsv::nRows() const {
-  int result;
+        ++_nValues;
 
-  if( LineByLine == _mode )
-    result = -1;
-  else
-    result = _data.count();
+        if( QCsv::AggregateCount == _function )
+          return;
 
-  return result;
-}
+        bool ok;
+        const double d = fastStrToDouble( val, &ok );
+        ok = ( ok && qIsFinite( d ) );
 
+        if( ok ) {
+          if( ( 0 == _nNumbers ) || ( d < _numMin ) ) {
+            _numMin = d;
+            _numMinText = val;
+          }
+          if( ( 0 == _nNumbers ) || ( d > _numMax ) ) {
+            _numMax = d;
+            _numMaxText = val;
+          }
 
-bool QCsv::writeFile( const QString &filename, const QString &codec ) {
-  clearError();
+          _sum = _sum + d;
+          ++_nNumbers;
+        }
+        else {
+          _hasText = true;
+        }
 
-  QStringList output;
-  QStringList header;
+        if( ( QCsv::AggregateMin == _function ) || ( QCsv::AggregateMax == _function ) ) {
+          if( ( 1 == _nValues ) || ( val < _textMin ) )
+            _textMin = val;
+          if( ( 1 == _nValues ) || ( val > _textMax ) )
+            _textMax = val;
+        }
+      }
 
-  QFile file(filename);
-  if (!file.open(QIODevice::WriteOnly)) {
+      QString result() const {
+        switch( _function ) {
+          case QCsv::AggregateCount:
+            return QString::number( _countRows ? _nRows : _nValues );
+          case QCsv::AggregateSum:
+            return ( 0 == _nNumbers ? QString() : QString::number( _sum, 'g', QLocale::FloatingPointShortest ) );
+          case QCsv::AggregateMean:
+            return ( 0 == _nNumbers ? QString() : QString::number( _sum / double( _nNumbers ), 'g', QLocale::FloatingPointShortest ) );
+          case QCsv::AggregateMin:
+            return ( _hasText ? _textMin : _numMinText );
+          case QCsv::AggregateMax:
+            return ( _hasText ? _textMax : _numMaxText );
+          default:
+            Q_UNREACHABLE();
+            return QString();
+        }
+      }
+
+    protected:
+      QCsv::AggregateFunction _function;
+      bool _countRows;
+      qint64 _nRows;
+      qint64 _nValues;
+      qint64 _nNumbers;
+      double _sum;
+      double _numMin;
+      double _numMax;
+      QString _numMinText;
+      QString _numMaxText;
+      QString _textMin;
+      QString _textMax;
+      bool _hasText;
+  };
+}
+
+
+bool QCsv::joinRows( QCsv& other, const QStringList& keyFields, const QStringList& otherKeyFields, const JoinType joinType, QCsv* result, QCsvWriter* writer ) {
+  clearError();
+
+  if( EntireFile != other.mode() ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("The other object in a join must be in EntireFile mode.") );
+    return false;
+  }
+  else if( keyFields.isEmpty() || ( keyFields.count() != otherKeyFields.count() ) ) {
+    setError( ERROR_OTHER, QStringLiteral("A join needs the same number of key fields from each object.") );
     return false;
   }
 
-  QTextStream out(&file);
-  if( !codec.isEmpty() )
-    out.setCodec(codec.toLatin1());
+  QVector<int> keys, otherKeys;
 
-  // Write the header row first...
-  if( this->_containsFieldList ) {
-    for( int i = 0; i < _fieldNames.count(); ++i ) {
-      header.append( _fieldNames.at(i) );
-    }
-    output = CSV::csvStringList( header, this->delimiter(), CSV::OriginalCase );
-    out << output.join( this->delimiter() ) << "\r\n";
+  if( !fieldIndexes( keyFields, keys ) ) {
+    return false;
+  }
+  else if( !other.fieldIndexes( otherKeyFields, otherKeys ) ) {
+    setError( other.error(), other.errorMsg() );
+    return false;
   }
 
-  // Then write the data.
-  foreach (const QStringList &line, _data) {
-    output = CSV::csvStringList( line, this->delimiter(), CSV::OriginalCase );
-    out << output.join( this->delimiter() ) << "\r\n";
+  // Field names for the result
+  //---------------------------
+  const int nFields = _fieldNames.count();
+  QStringList names = _fieldNames;
+  QSet<QString> usedNames;
+  for( int i = 0; i < names.count(); ++i ) {
+    usedNames.insert( names.at(i).toLower() );
   }
 
+  QVector<int> otherCols;
+  for( int c = 0; c < other.fieldNames().count(); ++c ) {
+    if( otherKeys.contains( c ) )
+      continue;
 
-  file.close();
+    QString name = other.fieldNames().at(c);
+    for( int n = 2; usedNames.contains( name.toLower() ); ++n ) {
+      name = QStringLiteral( "%1_%2" ).arg( other.fieldNames().at(c) ).arg( n );
+    }
 
-  return true;
-}
+    usedNames.insert( name.toLower() );
+    names.append( name );
+    otherCols.append( c );
+  }
 
+  // Rows of the other object, by key
+  //---------------------------------
+  FieldIndex built;
+  const FieldIndex* lookup;
 
-bool QCsv::displayTable( QTextStream* stream ) {
-  QList<QStringList> rows;
+  if( ( 1 == otherKeys.count() ) && other.hasIndex( otherKeys.first() ) ) {
+    lookup = &( other.fieldIndex( otherKeys.first() ) );
+  }
+  else {
+    QStringList keyValues;
+    for( int r = 0; r < other.dataRowCount(); ++r ) {
+      keyValues.clear();
+      for( int k = 0; k < otherKeys.count(); ++k ) {
+        keyValues.append( other.dataValue( otherKeys.at(k), r ).trimmed() );
+      }
+      built[ compositeKey( keyValues ) ].append( r );
+    }
+    lookup = &built;
+  }
 
-  if( containsFieldList() ) {
-    rows.append( this->fieldNames() );
-    rows.append( _data );
-    stringListListAsTable( rows, stream, true );
+  // Probe with each row of this object
+  //-----------------------------------
+  if( nullptr != result ) {
+    *result = QCsv( names );
+    result->setColumnarStorage( _columnarStorage );
   }
   else {
-    stringListListAsTable( _data, stream, false );
+    writer->writeRow( names );
   }
 
-  return true;
+  QStringList keyValues;
+  QStringList values;
+  int row = -1;
+
+  while( nextSourceRow( row ) ) {
+    values.clear();
+    for( int c = 0; c < nFields; ++c ) {
+      values.append( sourceValue( c, row ) );
+    }
+
+    keyValues.clear();
+    for( int k = 0; k < keys.count(); ++k ) {
+      keyValues.append( values.at( keys.at(k) ) );
+    }
+
+    const FieldIndex::const_iterator it = lookup->constFind( compositeKey( keyValues ) );
+
+    if( lookup->constEnd() == it ) {
+      if( LeftJoin == joinType ) {
+        for( int c = 0; c < otherCols.count(); ++c ) {
+          values.append( QString() );
+        }
+
+        if( nullptr != result )
+          result->append( values );
+        else
+          writer->writeRow( values );
+      }
+    }
+    else {
+      const QVector<int>& matches = it.value();
+
+      for( int m = 0; m < matches.count(); ++m ) {
+        QStringList joined = values;
+        for( int c = 0; c < otherCols.count(); ++c ) {
+          joined.append( other.dataValue( otherCols.at(c), matches.at(m) ) );
+        }
+
+        if( nullptr != result )
+          result->append( joined );
+        else
+          writer->writeRow( joined );
+      }
+    }
+
+    if( ( nullptr != writer ) && ( ERROR_NONE != writer->error() ) ) {
+      setError( writer->error(), writer->errorMsg() );
+      return false;
+    }
+  }
+
+  return ( ERROR_NONE == _error );
 }
 
 
-//  Mutators
-void QCsv::setContainsFieldList ( const bool setVal ){
-  clearError();
-  _containsFieldList = setVal;
+QCsv QCsv::join( QCsv& other, const QStringList& keyFields, const JoinType joinType /* = InnerJoin */ ) {
+  return join( other, keyFields, keyFields, joinType );
 }
 
 
-bool QCsv::setLinesToSkip( const int val ) {
-  if( 0 > val ) {
-    setError( ERROR_INDEX_OUT_OF_RANGE, QStringLiteral("Number of lines to skip must be 0 or more.") );
+QCsv QCsv::join( QCsv& other, const QStringList& keyFields, const QStringList& otherKeyFields, const JoinType joinType /* = InnerJoin */ ) {
+  QCsv result;
+
+  if( joinRows( other, keyFields, otherKeyFields, joinType, &result, nullptr ) )
+    result.toFront();
+  else
+    result.setError( _error, _errorMsg );
+
+  return result;
+}
+
+
+bool QCsv::join( QCsv& other, const QStringList& keyFields, const QStringList& otherKeyFields, const JoinType joinType, QCsvWriter* writer ) {
+  if( ( nullptr == writer ) || !writer->isOpen() ) {
+    clearError();
+    setError( ERROR_OTHER, QStringLiteral("The writer is not open.") );
     return false;
   }
-  else {
-    _linesToSkip = val;
-    return true;
-  }
+
+  return joinRows( other, keyFields, otherKeyFields, joinType, nullptr, writer );
 }
 
 
-void QCsv::setFilename( const QString& filename ){
+QCsv QCsv::groupBy( const QStringList& keyFields, const QList<Aggregate>& aggregates ) {
   clearError();
-  if( nullptr != _srcFile ) {
-    _srcFile->close();
-    _isOpen = false;
-    delete _srcFile;
-    _srcFile = nullptr;
-  }
 
-  _srcFilename = filename;
-}
+  QCsv result;
+  QVector<int> keys;
 
+  if( !fieldIndexes( keyFields, keys ) ) {
+    result.setError( _error, _errorMsg );
+    return result;
+  }
 
-bool QCsv::open() {
-  if( EntireFile != mode() ) {
-    _isOpen = openFileAndReadHeader();
+  // Field names for the result, and the fields to summarize
+  //--------------------------------------------------------
+  QStringList names;
+  for( int k = 0; k < keys.count(); ++k ) {
+    names.append( _fieldNames.at( keys.at(k) ) );
   }
-  else if( this->_containsFieldList &&  !( this->_fieldNames.isEmpty() && this->_data.isEmpty() ) ) {
-    _isOpen = true;
+
+  QVector<int> aggFields;
+  for( int a = 0; a < aggregates.count(); ++a ) {
+    const Aggregate& agg = aggregates.at(a);
+    QString name = agg.outputName;
+
+    if( agg.fieldName.isEmpty() ) {
+      if( AggregateCount != agg.function ) {
+        setError( ERROR_INVALID_FIELD_NAME, QStringLiteral("Only a count may be calculated without a field.") );
+        result.setError( _error, _errorMsg );
+        return result;
+      }
+      aggFields.append( -1 );
+    }
+    else {
+      QVector<int> idx;
+      if( !fieldIndexes( QStringList() << agg.fieldName, idx ) ) {
+        result.setError( _error, _errorMsg );
+        return result;
+      }
+      aggFields.append( idx.first() );
+    }
+
+    if( name.isEmpty() ) {
+      switch( agg.function ) {
+        case AggregateCount: name = QStringLiteral("count"); break;
+        case AggregateSum: name = QStringLiteral("sum"); break;
+        case AggregateMin: name = QStringLiteral("min"); break;
+        case AggregateMax: name = QStringLiteral("max"); break;
+        case AggregateMean: name = QStringLiteral("mean"); break;
+      }
+
+      if( -1 != aggFields.last() )
+        name = name + "_" + _fieldNames.at( aggFields.last() );
+    }
+
+    names.append( name );
   }
-  else if( !this->_containsFieldList && !this->_data.isEmpty() ) {
-    _isOpen = true;
+
+  // Summarize each group
+  //---------------------
+  QHash<QString, int> groupLookup;
+  QList<QStringList> groupKeys;
+  QVector<QVector<GroupAccumulator> > groups;
+
+  QVector<GroupAccumulator> emptyGroup;
+  for( int a = 0; a < aggregates.count(); ++a ) {
+    emptyGroup.append( GroupAccumulator( aggregates.at(a).function, ( -1 == aggFields.at(a) ) ) );
   }
-  else if( !isOpen() ) {
-    if( openFileAndReadHeader() ) {
-      int fieldsRead = 0;
-      while( -1 != fieldsRead ) {
-        fieldsRead = readNext();
-      }
 
-      this->finishWithFile();
+  QStringList keyValues;
+  int row = -1;
 
-      this->toFront();
+  while( nextSourceRow( row ) ) {
+    keyValues.clear();
+    for( int k = 0; k < keys.count(); ++k ) {
+      keyValues.append( sourceValue( keys.at(k), row ) );
+    }
 
-      _isOpen = true;
+    const QString key = compositeKey( keyValues );
+    QHash<QString, int>::const_iterator it = groupLookup.constFind( key );
+
+    if( groupLookup.constEnd() == it ) {
+      it = groupLookup.insert( key, groups.count() );
+      groupKeys.append( keyValues );
+      groups.append( emptyGroup );
     }
-    else {
-      _isOpen = false;
+
+    QVector<GroupAccumulator>& group = groups[ it.value() ];
+    for( int a = 0; a < group.count(); ++a ) {
+      group[a].add( ( -1 == aggFields.at(a) ) ? QString() : sourceValue( aggFields.at(a), row ) );
     }
   }
-  else {
-    // The object is aleady open, so there is no need to do anything else.
+
+  if( ERROR_NONE != _error ) {
+    result.setError( _error, _errorMsg );
+    return result;
   }
 
-  return _isOpen;
+  result = QCsv( names );
+  result.setColumnarStorage( _columnarStorage );
+
+  for( int g = 0; g < groups.count(); ++g ) {
+    QStringList values = groupKeys.at(g);
+    for( int a = 0; a < groups.at(g).count(); ++a ) {
+      values.append( groups.at(g).at(a).result() );
+    }
+    result.append( values );
+  }
+
+  result.toFront();
+  return result;
 }
 
 
-bool QCsv::openFileAndReadHeader() {
+QCsv QCsv::filter( const int index, const QString& value, const Qt::CaseSensitivity cs /* = Qt::CaseSensitive */ ) {
+  // This function will not work with qCSV_LineByLine mode.
+  Q_ASSERT( EntireFile == _mode );
   clearError();
 
-  if( nullptr != _srcFile ) {
-    delete _srcFile;
+  QCsv result;
+  if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+    result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
   }
+  else {
+    result = QCsv( this->fieldNames() );
+    result.setColumnarStorage( _columnarStorage );
 
-  _srcFile = new QFile( _srcFilename );
+    if( hasIndex( index ) ) {
+      const FieldIndex& fi = fieldIndex( index );
+      QVector<int> rows;
 
-  bool result = _srcFile->open( QIODevice::ReadOnly | QIODevice::Text );
+      if( Qt::CaseSensitive == cs ) {
+        rows = fi.value( value );
+      }
+      else {
+        for( FieldIndex::const_iterator it = fi.constBegin(); it != fi.constEnd(); ++it ) {
+          if( 0 == value.compare( it.key(), cs ) )
+            rows += it.value();
+        }
+        std::sort( rows.begin(), rows.end() );
+      }
 
-  if( !result ) {
-    _error = ERROR_OPEN;
-    _errorMsg = QStringLiteral("Can not open the source file");
-    delete _srcFile;
-    _srcFile = nullptr;
-  }
-  else if( _containsFieldList ) {
-    readHeader();
+      for( int i = 0; i < rows.count(); ++i ) {
+        result.append( dataRow( rows.at(i) ) );
+      }
+    }
+    else if( isDictionaryField( index ) ) {
+      // Each distinct value is compared once, and rows are then picked out by their codes.
+      const int nCodes = _columns.dictionarySize( index );
+      QVector<bool> matches( nCodes );
+      for( int code = 0; code < nCodes; ++code )
+        matches[code] = ( 0 == value.compare( _columns.dictionaryValue( index, code ), cs ) );
+
+      for( int i = 0; i < dataRowCount(); ++i ) {
+        if( matches.at( _columns.code( index, i ) ) )
+          result.append( dataRow( i ) );
+      }
+    }
+    else {
+      for( int i = 0; i < dataRowCount(); ++i ) {
+        if( 0 == value.compare( this->field( index, i ), cs ) ) {
+          result.append( dataRow( i ) );
+        }
+      }
+    }
   }
 
+  result.toFront();
   return result;
 }
 
 
-void QCsv::finishWithFile() {
-  if( nullptr != _srcFile ) {
-    _srcFile->close();
-    delete _srcFile;
-    _srcFile = nullptr;
+QCsv QCsv::filter( const QString& fieldName, const QString& value, const Qt::CaseSensitivity cs /* = Qt::CaseSensitive */ ) {
+  QCsv result;
+
+  // This function will not work with qCSV_LineByLine mode.
+  Q_ASSERT( EntireFile == _mode );
+  clearError();
+
+  if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+    result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
+  }
+  else if( !_containsFieldList ) {
+    _error = ERROR_NO_FIELDLIST;
+    _errorMsg = QStringLiteral("The current settings do not include a field list.");
+    result.setError( _error, _errorMsg );
+  }
+  else if( !_fieldsLookup.contains( fieldName.trimmed().toLower() ) ) {
+    _error = ERROR_INVALID_FIELD_NAME;
+    _errorMsg = "Invalid Field Name: " + fieldName;
+     result.setError( _error, _errorMsg );
+  }
+  else {
+    result = filter( _fieldsLookup.value( fieldName.trimmed().toLower() ), value, cs );
   }
+
+  return result;
 }
 
 
-void QCsv::close(){
-  clearError();
-  finishWithFile();
-  _isOpen = false;
+QCsv QCsv::sorted( const int index, const Qt::SortOrder order /* = Qt::AscendingOrder */ ) {
+  return sorted( QList<SortKey>() << SortKey( index, order ) );
 }
 
 
-bool QCsv::toFront() {
+QCsv QCsv::sorted( const QList<SortKey>& keys ) {
   // This function will not work with qCSV_LineByLine mode.
   Q_ASSERT( EntireFile == _mode );
   clearError();
 
-  if( LineByLine == _mode ) {
+  QCsv result;
+  if( EntireFile != _mode ) {
     setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
-    return false;
+    result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
   }
   else {
-    _currentRowNumber = -1;
-    return true;
+    const QVector<int> rows = sortOrder( keys );
+
+    if( ERROR_NONE != _error ) {
+      result.setError( _error, _errorMsg );
+    }
+    else {
+      result = QCsv( this->fieldNames() );
+      result.setColumnarStorage( _columnarStorage );
+
+      for( int i = 0; i < rows.count(); ++i ) {
+        result.append( dataRow( rows.at(i) ) );
+      }
+
+      // Native columns stay native.
+      if( _columnar && result._columnar && ( result._columns.nCols() == _columns.nCols() ) ) {
+        for( int c = 0; c < _columns.nCols(); ++c ) {
+          if( !_columns.isTextColumn( c ) )
+            result._columns.setColumnType( c, _columns.columnType( c ) );
+        }
+      }
+    }
+  }
+
+  result.toFront();
+  return result;
+}
+
+
+QVector<int> QCsv::sortOrder( const QList<SortKey>& keys ) {
+  // This function will not work with qCSV_LineByLine mode.
+  Q_ASSERT( EntireFile == _mode );
+  clearError();
+
+  if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+    return QVector<int>();
+  }
+
+  QVector<SortColumn> columns( keys.count() );
+
+  for( int k = 0; k < keys.count(); ++k ) {
+    const int index = keys.at(k).field;
+    SortColumn& column = columns[k];
+
+    if( ( 0 > index ) || ( fieldCount() <= index ) ) {
+      _error = ERROR_INDEX_OUT_OF_RANGE;
+      _errorMsg = QStringLiteral( "There is no column %1" ).arg( index );
+      return QVector<int>();
+    }
+
+    column.descending = ( Qt::DescendingOrder == keys.at(k).order );
+    column.numeric = sortNumbers( index, column.numbers );
+
+    if( !column.numeric )
+      column.text = fieldValues( index, false );
+  }
+
+  const int n = dataRowCount();
+  QVector<int> result( n );
+  for( int r = 0; r < n; ++r ) {
+    result[r] = r;
   }
+
+  std::stable_sort( result.begin(), result.end(), SortComparator( columns ) );
+
+  return result;
 }
 
 
-//  Returns the number of fields in the row, or -1 at the end of the file.
-int QCsv::moveNext() {
-  clearError();
+// Used by sortOrder(): if every value in a field is a number (or is empty), fills 'numbers'
+// with values for comparison and returns true.  Empty values come before all others.
+bool QCsv::sortNumbers( const int index, QVector<double>& numbers ) {
+  const int n = dataRowCount();
+  numbers.resize( n );
+
+  if( _columnar && !_columns.isTextColumn( index ) ) {
+    for( int r = 0; r < n; ++r ) {
+      if( _columns.isNull( index, r ) ) {
+        numbers[r] = -qInf();
+        continue;
+      }
+
+      switch( _columns.columnType( index ) ) {
+        case QCsvColumnStore::IntegerColumn: numbers[r] = double( _columns.intValue( index, r ) ); break;
+        case QCsvColumnStore::DoubleColumn: numbers[r] = _columns.doubleValue( index, r ); break;
+        case QCsvColumnStore::DateColumn: numbers[r] = double( _columns.dateValue( index, r ).toJulianDay() ); break;
+        case QCsvColumnStore::BoolColumn: numbers[r] = ( _columns.boolValue( index, r ) ? 1.0 : 0.0 ); break;
+        default: Q_UNREACHABLE(); break;
+      }
+    }
+
+    return true;
+  }
+
+  for( int r = 0; r < n; ++r ) {
+    const QString val = dataValue( index, r );
+    bool ok = true;
+
+    if( val.isEmpty() )
+      numbers[r] = -qInf();
+    else
+      numbers[r] = fastStrToDouble( val, &ok );
+
+    if( !ok || qIsNaN( numbers.at(r) ) )
+      return false;
+  }
+
+  return true;
+}
+
+
+QCsv QCsv::sorted( const QString& fieldName, const Qt::SortOrder order /* = Qt::AscendingOrder */ ) {
+  QCsv result;
+
+  // This function will not work with qCSV_LineByLine mode.
+  Q_ASSERT( EntireFile == _mode );
+  clearError();
+
+  if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+    result.setError( ERROR_WRONG_MODE, QStringLiteral("Filtered CSVs can only be created from CSVs in EntireFile mode.") );
+  }
+  else if( !_containsFieldList ) {
+    _error = ERROR_NO_FIELDLIST;
+    _errorMsg = QStringLiteral("The current settings do not include a field list.");
+    result.setError( _error, _errorMsg );
+  }
+  else if( !_fieldsLookup.contains( fieldName.trimmed().toLower() ) ) {
+    _error = ERROR_INVALID_FIELD_NAME;
+    _errorMsg = "Invalid Field Name: " + fieldName;
+     result.setError( _error, _errorMsg );
+  }
+  else {
+    result = sorted( _fieldsLookup.value( fieldName.trimmed().toLower() ), order );
+  }
+
+  return result;
+}
+
+
+bool QCsv::createIndex( const int index ) {
+  // This function will not work with qCSV_LineByLine mode.
+  Q_ASSERT( EntireFile == _mode );
+  clearError();
+
+  if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+    return false;
+  }
+  else if( ( 0 > index ) || ( fieldCount() <= index ) ) {
+    _error = ERROR_INDEX_OUT_OF_RANGE;
+    _errorMsg = QStringLiteral( "There is no column %1" ).arg( index );
+    return false;
+  }
+  else {
+    _indexedFields.insert( index );
+    return true;
+  }
+}
+
+
+bool QCsv::createIndex( const QString& fieldName ) {
+  clearError();
+
+  if( !_fieldsLookup.contains( fieldName.trimmed().toLower() ) ) {
+    _error = ERROR_INVALID_FIELD_NAME;
+    _errorMsg = "Invalid Field Name: " + fieldName;
+    return false;
+  }
+  else {
+    return createIndex( _fieldsLookup.value( fieldName.trimmed().toLower() ) );
+  }
+}
+
+
+const QCsv::FieldIndex& QCsv::fieldIndex( const int index ) {
+  Q_ASSERT( _indexedFields.contains( index ) );
+
+  if( !_fieldIndexes.contains( index ) ) {
+    FieldIndex& fi = _fieldIndexes[index];
+    const int nRows = dataRowCount();
+
+    for( int row = 0; row < nRows; ++row ) {
+      fi[ dataValue( index, row ).trimmed() ].append( row );
+    }
+  }
+
+  return _fieldIndexes[index];
+}
+
+
+int QCsv::fieldCount() {
+  if( _containsFieldList )
+    return _fieldNames.count();
+  else if( rowInSpans() )
+    return _rowSpans.count();
+  else if( LineByLine == _mode )
+    return _fieldData.count();
+  else if( 0 < rowCount() )
+    return ( _columnar ? _columns.nCols() : _data.at(0).count() );
+  else
+    return 0;
+}
+
+int QCsv::rowCount() {
+  int result;
+
+  if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+    result = -1;
+  }
+  else
+    result = dataRowCount();
+
+  return result;
+}
+
+
+int QCsv::nRows() const {
+  int result;
+
+  if( EntireFile != _mode )
+    result = -1;
+  else
+    result = dataRowCount();
+
+  return result;
+}
+
+
+bool QCsv::writeFile( const QString &filename, const QString &codec ) {
+  clearError();
+
+  QCsvWriter writer;
+  writer.setDelimiter( this->delimiter() );
+  writer.setCodec( codec );
+  writer.setLegacyQuoting( true ); // Values are quoted as they are by CSV::csvStringList()
+
+  if( !writer.open( filename ) ) {
+    return false;
+  }
+
+  // Write the header row first...
+  if( this->_containsFieldList ) {
+    writer.writeRow( _fieldNames );
+  }
+
+  // Then write the data.
+  for( int i = 0; i < dataRowCount(); ++i ) {
+    writer.writeRow( dataRow( i ) );
+  }
+
+  return writer.close();
+}
+
+
+bool QCsv::displayTable( QTextStream* stream ) {
+  QList<QStringList> rows;
+  const QList<QStringList> data = ( _columnar ? _columns.toRows() : _data );
+
+  if( containsFieldList() ) {
+    rows.append( this->fieldNames() );
+    rows.append( data );
+    stringListListAsTable( rows, stream, true );
+  }
+  else {
+    stringListListAsTable( data, stream, false );
+  }
+
+  return true;
+}
+
+
+//  Mutators
+void QCsv::setContainsFieldList ( const bool setVal ){
+  clearError();
+  _containsFieldList = setVal;
+}
+
+
+bool QCsv::setLinesToSkip( const int val ) {
+  if( 0 > val ) {
+    setError( ERROR_INDEX_OUT_OF_RANGE, QStringLiteral("Number of lines to skip must be 0 or more.") );
+    return false;
+  }
+  else {
+    _linesToSkip = val;
+    return true;
+  }
+}
+
+
+void QCsv::setFilename( const QString& filename ){
+  clearError();
+  if( nullptr != _srcFile ) {
+    finishWithFile();
+    _isOpen = false;
+  }
+
+  _srcFilename = filename;
+}
+
+
+bool QCsv::open() {
+  if( EntireFile != mode() ) {
+    _isOpen = openFileAndReadHeader();
+
+    if( _isOpen )
+      beginValidation();
+  }
+  else if( this->_containsFieldList &&  !( this->_fieldNames.isEmpty() && ( 0 == this->dataRowCount() ) ) ) {
+    _isOpen = true;
+  }
+  else if( !this->_containsFieldList && ( 0 < this->dataRowCount() ) ) {
+    _isOpen = true;
+  }
+  else if( !isOpen() ) {
+    // Rows are added straight to the columns as they are read, if that's where they will be kept.
+    _columnar = _columnarStorage;
+    _loadedFromCache = false;
+    _cacheSaveError.clear();
+
+    if( _useCache && ( nullptr == _validator ) && loadCache() ) {
+      _isOpen = true;
+    }
+    else if( openFileAndReadHeader() ) {
+      beginValidation();
+
+      if( _parallelLoad ) {
+        readAllInParallel();
+      }
+      else {
+        int fieldsRead = 0;
+        while( -1 != fieldsRead ) {
+          fieldsRead = readNext();
+
+          if( -1 != fieldsRead )
+            validateCurrentRow();
+        }
+      }
+
+      this->finishWithFile();
+
+      if( _autoFieldTypes )
+        this->inferFieldTypes();
+
+      this->toFront();
+
+      _isOpen = true;
+
+      if( _useCache && ( ERROR_NONE == _error ) )
+        saveCache();
+    }
+    else {
+      _isOpen = false;
+    }
+  }
+  else {
+    // The object is aleady open, so there is no need to do anything else.
+  }
+
+  return _isOpen;
+}
+
+
+bool QCsv::openFileAndReadHeader() {
+  clearError();
+
+  finishWithFile();
+  _rowIndex.clear();
+  _rowIndexSaveError.clear();
+
+  if( _autoDetectDialect && !detectDialect() )
+    return false;
+
+  // Files that aren't UTF-8 are converted as they are read.
+  QTextCodec* textCodec = nullptr;
+
+  if( !_codec.isEmpty() ) {
+    textCodec = QTextCodec::codecForName( _codec.toLatin1() );
+
+    if( nullptr == textCodec ) {
+      _error = ERROR_OPEN;
+      _errorMsg = QStringLiteral("Unknown encoding: %1").arg( _codec );
+      return false;
+    }
+    else if( 106 == textCodec->mibEnum() ) {
+      textCodec = nullptr;
+    }
+  }
+
+  _srcFile = new QFile( _srcFilename );
+
+  // Mapped files are read as raw bytes: line endings are dealt with by the parser.
+  // Text mode is turned on below for other files, once it's known how they will be read.
+  bool result = _srcFile->open( QIODevice::ReadOnly );
+
+  // Compressed files are recognized by their contents, and decompressed on the fly.
+  const CompressionFormat compression = ( result ? compressionFormat( _srcFile->peek( 4 ) ) : NoCompression );
+
+  if( !result ) {
+    _error = ERROR_OPEN;
+    _errorMsg = QStringLiteral("Can not open the source file");
+    delete _srcFile;
+    _srcFile = nullptr;
+  }
+  else if( ( NoCompression != compression ) && ( MemoryMapped == _mode ) ) {
+    _error = ERROR_OPEN;
+    _errorMsg = QStringLiteral("Compressed files can't be used in MemoryMapped mode.");
+    finishWithFile();
+    result = false;
+  }
+  else if( ( MemoryMapped == _mode ) && ( 0x7F < _delimiter.unicode() ) ) {
+    _error = ERROR_OPEN;
+    _errorMsg = QStringLiteral("MemoryMapped mode requires an ASCII delimiter.");
+    finishWithFile();
+    result = false;
+  }
+  else if( ( MemoryMapped == _mode ) && ( ( nullptr != textCodec ) || hasUtf16Bom( _srcFile->peek( 2 ) ) ) ) {
+    _error = ERROR_OPEN;
+    _errorMsg = QStringLiteral("MemoryMapped mode requires a UTF-8 file.");
+    finishWithFile();
+    result = false;
+  }
+  else if( _follow && ( ( LineByLine != _mode ) || ( NoCompression != compression ) || ( nullptr != textCodec ) || hasUtf16Bom( _srcFile->peek( 2 ) ) ) ) {
+    _error = ERROR_OPEN;
+    _errorMsg = QStringLiteral("Only uncompressed UTF-8 files in LineByLine mode can be followed.");
+    finishWithFile();
+    result = false;
+  }
+  else if( ( MemoryMapped == _mode ) && !mapSourceFile() ) {
+    _error = ERROR_OPEN;
+    _errorMsg = QStringLiteral("Can not map the source file into memory");
+    finishWithFile();
+    result = false;
+  }
+  else {
+    if( NoCompression == compression ) {
+      _srcDevice = _srcFile;
+    }
+    else {
+      _decompressor = new QDecompressingReader( _srcFile, compression );
+      result = _decompressor->open( QIODevice::ReadOnly );
+
+      if( result ) {
+        _srcDevice = _decompressor;
+      }
+      else {
+        _error = ERROR_OPEN;
+        _errorMsg = _decompressor->errorString();
+        finishWithFile();
+      }
+    }
+
+    // Line endings are converted by the last device in the chain.  Anything before a transcoder is read as
+    // binary, since converting line endings in, e.g., UTF-16 would damage it.
+    if( result && ( MemoryMapped != _mode ) ) {
+      if( ( nullptr == textCodec ) && hasUtf16Bom( _srcDevice->peek( 2 ) ) )
+        textCodec = QTextCodec::codecForName( "UTF-16" );
+
+      if( nullptr == textCodec ) {
+        _srcDevice->setTextModeEnabled( true );
+      }
+      else {
+        _transcoder = new QTranscodingReader( _srcDevice, textCodec );
+        _transcoder->open( QIODevice::ReadOnly | QIODevice::Text );
+        _srcDevice = _transcoder;
+      }
+
+      // A UTF-8 byte order mark isn't part of the data.
+      if( "\xEF\xBB\xBF" == _srcDevice->peek( 3 ) )
+        _srcDevice->read( 3 );
+    }
+
+    if( result && _containsFieldList ) {
+      // Names from any previous opening (or from a copied object) are replaced by the header.
+      _fieldNames.clear();
+      _fieldsLookup.clear();
+      readHeader();
+    }
+
+    if( result && !( setUpRowFilters() && setUpProjection() ) ) {
+      finishWithFile();
+      result = false;
+    }
+
+    if( result && _follow ) {
+      if( !_recordComplete ) {
+        _error = ERROR_NO_FIELDLIST;
+        _errorMsg = QStringLiteral("The header of the followed file has not been completely written.");
+        finishWithFile();
+        result = false;
+      }
+      else {
+        _followOffset = _srcFile->pos();
+        _followScanned = _followOffset;
+      }
+    }
+  }
+
+  // Files are UTF-8, so (with the usual settings) rows can be split on raw bytes without first decoding them.
+  // The header and any comments are still read by readLine() above.
+  _byteRecords = ( result && ( MemoryMapped != _mode ) && _stringsContainDelimiters && ( 0x7F >= _delimiter.unicode() ) && !_delimiter.isSpace() );
+  _spanRow = false;
+
+  if( result && ( MemoryMapped == _mode ) ) {
+    _dataStart = _mapPos;
+    _dataStartRow = _currentRowNumber;
+  }
+  else if( result && ( nullptr == _decompressor ) && ( nullptr == _transcoder ) ) {
+    _dataStart = _srcFile->pos();
+    _dataStartRow = _currentRowNumber;
+  }
+
+  return result;
+}
+
+
+// Returns false if there's no usable cache, in which case the file should be parsed as usual.
+bool QCsv::loadCache() {
+  // The dialect of the file has to be known before the settings can be compared.
+  if( _autoDetectDialect && !detectDialect() )
+    return false;
+
+  QCsvCache cache;
+  cache.setDictionaryLimit( _columns.dictionaryLimit() );
+  if( !cache.load( _srcFilename, cacheSettings() ) )
+    return false;
+
+  _fieldNames.clear();
+  _fieldsLookup.clear();
+
+  const QStringList fieldNames = cache.fieldNames();
+  for( int i = 0; i < fieldNames.count(); ++i ) {
+    _fieldNames.append( fieldNames.at(i) );
+    if( !_fieldsLookup.contains( fieldNames.at(i).toLower() ) )
+      _fieldsLookup.insert( fieldNames.at(i).toLower(), i );
+  }
+
+  _comments = cache.comments();
+  _nRowsFiltered = cache.nRowsFiltered();
+
+  // The cache holds columns.  They're moved to rows if that's where they should be kept.
+  invalidateIndexes();
+  _data.clear();
+  const int dictionaryLimit = _columns.dictionaryLimit();
+  _columns = cache.columns();
+  _columns.setDictionaryLimit( dictionaryLimit );
+  _columnar = true;
+  setColumnarStorage( _columnarStorage || _autoFieldTypes );
+
+  toFront();
+  _loadedFromCache = true;
+
+  return true;
+}
+
+
+bool QCsv::saveCache() {
+  QCsvColumnStore columns;
+
+  if( _columnar )
+    columns = _columns;
+  else
+    columns.setRows( _data );
+
+  QCsvCache cache;
+  cache.setContents( _fieldNames, _comments, _nRowsFiltered, columns );
+
+  // A cache that can't be saved doesn't matter much: the file will just be parsed again next time.
+  // So this isn't an error, but the reason is kept for cacheSaveError().
+  if( !cache.save( _srcFilename, cacheSettings() ) ) {
+    _cacheSaveError = cache.errorMsg();
+    return false;
+  }
+
+  return true;
+}
+
+
+QString QCsv::cacheSettings() const {
+  // ASCII separators, which shouldn't turn up in any of these.  Each level of nesting has its own.
+  const QChar settingSep( 0x1C );
+  const QChar filterSep( 0x1D );
+  const QChar partSep( 0x1E );
+  const QChar listSep( 0x1F );
+
+  QStringList indexes;
+  for( int i = 0; i < _selectedFieldIndexes.count(); ++i )
+    indexes.append( QString::number( _selectedFieldIndexes.at(i) ) );
+
+  QStringList filters;
+  for( int i = 0; i < _rowFilters.count(); ++i ) {
+    const RowFilter& filter = _rowFilters.at(i);
+    QStringList values = filter.values.toList();
+    values.sort();
+
+    filters.append(
+      ( QStringList()
+        << filter.fieldName << QString::number( filter.fieldIndex ) << QString::number( int( filter.isRange ) )
+        << QString::number( filter.min, 'g', 17 ) << QString::number( filter.max, 'g', 17 ) << values.join( listSep )
+      ).join( partSep )
+    );
+  }
+
+  return (
+    QStringList()
+      << QString( _delimiter ) << QString::number( int( _containsFieldList ) ) << QString::number( int( _stringsContainDelimiters ) )
+      << _eolDelimiter << QString::number( int( _checkForComments ) ) << QString::number( _linesToSkip ) << _codec
+      << QString::number( int( _autoFieldTypes ) ) << _selectedFieldNames.join( listSep ) << indexes.join( listSep ) << filters.join( filterSep )
+      << QString::number( _columns.dictionaryLimit() )
+  ).join( settingSep );
+}
+
+
+bool QCsv::mapSourceFile() {
+  _mapSize = _srcFile->size();
+  _mapPos = 0;
+  _rowSpans.clear();
+
+  // An empty file can't be mapped, but there's nothing wrong with it either.
+  if( 0 == _mapSize ) {
+    _map = nullptr;
+    return true;
+  }
+
+  _map = _srcFile->map( 0, _mapSize );
+
+  // A UTF-8 byte order mark isn't part of the data.
+  if( ( nullptr != _map ) && ( 3 <= _mapSize ) && ( 0 == memcmp( _map, "\xEF\xBB\xBF", 3 ) ) )
+    _mapPos = 3;
+
+  return( nullptr != _map );
+}
+
+
+void QCsv::finishWithFile() {
+  // The transcoder reads from the decompressor or from _srcFile, and the decompressor reads from _srcFile,
+  // so they have to be stopped first, in that order.
+  if( nullptr != _transcoder ) {
+    delete _transcoder;
+    _transcoder = nullptr;
+  }
+
+  if( nullptr != _decompressor ) {
+    delete _decompressor;
+    _decompressor = nullptr;
+  }
+
+  _srcDevice = nullptr;
+
+  #ifdef Q_OS_LINUX
+    if( -1 != _followWatch ) {
+      ::close( _followWatch );
+      _followWatch = -1;
+    }
+  #endif
+
+  if( nullptr != _srcFile ) {
+    if( nullptr != _map ) {
+      _srcFile->unmap( _map );
+      _map = nullptr;
+      _mapSize = 0;
+      _rowSpans.clear();
+    }
+
+    _srcFile->close();
+    delete _srcFile;
+    _srcFile = nullptr;
+  }
+}
+
+
+// Reports damaged or truncated compressed data, once everything that could be decompressed has been read.
+void QCsv::checkDecompression() {
+  if( ( nullptr != _decompressor ) && !_decompressor->decompressionError().isEmpty() ) {
+    _error = ERROR_BAD_READ;
+    _errorMsg = _decompressor->decompressionError();
+  }
+}
+
+
+// Does the data start with a UTF-16 byte order mark?
+bool QCsv::hasUtf16Bom( const QByteArray& leadingBytes ) {
+  return ( leadingBytes.startsWith( "\xFF\xFE" ) || leadingBytes.startsWith( "\xFE\xFF" ) );
+}
+
+
+bool QCsv::detectDialect( const int sampleSize /* = QCsvDialect::defaultSampleSize */ ) {
+  clearError();
+
+  QCsvDialect dialect;
+
+  // A file without any complete rows can still be opened: it just doesn't say anything about its dialect.
+  if( !dialect.sniffFile( _srcFilename, sampleSize, _checkForComments, _linesToSkip ) && !dialect.errorMsg().isEmpty() ) {
+    setError( ERROR_OPEN, dialect.errorMsg() );
+    return false;
+  }
+
+  setDialect( dialect );
+
+  return true;
+}
+
+
+void QCsv::setDialect( const QCsvDialect& dialect ) {
+  _dialect = dialect;
+
+  if( QCsvDialect::UnknownEncoding != dialect.encoding() )
+    _codec = ( QCsvDialect::Utf8Encoding == dialect.encoding() ? QString() : dialect.codecName() );
+
+  if( dialect.isValid() ) {
+    _delimiter = dialect.delimiter();
+    _containsFieldList = dialect.hasHeader();
+  }
+}
+
+
+void QCsv::close(){
+  clearError();
+  finishWithFile();
+  _isOpen = false;
+}
+
+
+bool QCsv::toFront() {
+  // This function will not work with qCSV_LineByLine mode.
+  Q_ASSERT( LineByLine != _mode );
+  clearError();
+
+  if( LineByLine == _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile or MemoryMapped mode may be used with this function.") );
+    return false;
+  }
+  else if( MemoryMapped == _mode ) {
+    _mapPos = _dataStart;
+    _currentRowNumber = _dataStartRow;
+    _rowSpans.clear();
+    return true;
+  }
+  else {
+    _currentRowNumber = -1;
+    return true;
+  }
+}
+
+
+bool QCsv::useRowIndex() {
+  clearError();
+  _rowIndexSaveError.clear();
+
+  if( ( LineByLine != _mode ) && ( MemoryMapped != _mode ) ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only LineByLine or MemoryMapped mode may be used with this function.") );
+    return false;
+  }
+  else if( !_isOpen || ( nullptr == _srcFile ) ) {
+    setError( ERROR_OPEN, QStringLiteral("Object is not open.") );
+    return false;
+  }
+  else if( ( nullptr != _decompressor ) || ( nullptr != _transcoder ) || _follow ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Compressed, converted, or followed files can't be indexed.") );
+    return false;
+  }
+
+  if( _rowIndex.load( _srcFilename, _dataStart ) )
+    return true;
+
+  if( !_rowIndex.build( _srcFilename, _dataStart ) ) {
+    setError( ERROR_BAD_READ, _rowIndex.errorMsg() );
+    return false;
+  }
+
+  // An index that can't be saved is still useful, so this isn't treated as an error.
+  if( !_rowIndex.save() )
+    _rowIndexSaveError = _rowIndex.errorMsg();
+
+  return true;
+}
+
+
+bool QCsv::seekToRow( const int rowNumber ) {
+  clearError();
+
+  if( !hasRowIndex() || ( nullptr == _srcFile ) ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("There is no row index.  Use useRowIndex() first.") );
+    return false;
+  }
+  else if( !_rowFilters.isEmpty() ) {
+    // The index counts every row in the file, but filters hide some of them, so a row number can't be trusted:
+    // readNext() would quietly move on to the next row that passes the filters.
+    setError( ERROR_WRONG_MODE, QStringLiteral("Rows can't be read by number while row filters are set.") );
+    return false;
+  }
+  else if( ( 0 > rowNumber ) || ( _rowIndex.nRows() <= rowNumber ) ) {
+    _error = ERROR_INDEX_OUT_OF_RANGE;
+    _errorMsg = QStringLiteral( "There is no row %1" ).arg( rowNumber );
+    return false;
+  }
+
+  const qint64 offset = _rowIndex.offset( rowNumber );
+
+  if( MemoryMapped == _mode ) {
+    _mapPos = offset;
+  }
+  else if( !_srcFile->seek( offset ) ) {
+    setError( ERROR_BAD_READ, QStringLiteral( "Could not move to row %1" ).arg( rowNumber ) );
+    return false;
+  }
+
+  _fieldData.clear();
+  _currentLine.clear();
+  _rowSpans.clear();
+  _spanRow = false;
+
+  // Row numbers carry on from here as though every row before this one had been read.
+  _currentRowNumber = _dataStartRow + rowNumber;
+
+  return true;
+}
+
+
+QList<QStringList> QCsv::rowRange( const int first, const int count ) {
+  QList<QStringList> result;
+
+  if( !seekToRow( first ) )
+    return result;
+
+  const int last = qMin( first + count, _rowIndex.nRows() );
+  result.reserve( last - first );
+
+  for( int i = first; i < last; ++i ) {
+    if( -1 == readNext() )
+      break;
+
+    result.append( rowData() );
+  }
+
+  return result;
+}
+
+
+//  Returns the number of fields in the row, or -1 at the end of the file.
+int QCsv::moveNext() {
+  clearError();
+
+  if( ( LineByLine == _mode ) || ( MemoryMapped == _mode ) ) {
+    if( _isOpen ) {
+      const int result = readNext();
+
+      if( -1 != result )
+        validateCurrentRow();
+
+      return result;
+    }
+    else {
+      this->setError( ERROR_OPEN, QStringLiteral("Object is not open.") );
+      return -1;
+    }
+  }
+  else {
+    ++_currentRowNumber;
+
+    if( _currentRowNumber < dataRowCount() ) {
+      _fieldData.clear();
+
+      // Values in columns are read where they are, as they are needed.
+      if( _columnar )
+        return _columns.nCols();
+
+      _fieldData = dataRow( _currentRowNumber );
+      return _fieldData.count();
+    }
+    else {
+      return -1;
+    }
+  }
+}
+
+
+//  As moveNext(), but the fields of the new row are also put into 'row'.  No strings are created, unless
+//  they already have been: see QCsvRowBuffer.
+int QCsv::moveNext( QCsvRowBuffer& row ) {
+  row.clear();
+
+  if( EntireFile == _mode ) {
+    clearError();
+    ++_currentRowNumber;
+
+    if( _currentRowNumber >= dataRowCount() )
+      return -1;
+
+    _fieldData.clear();
+
+    if( _columnar ) {
+      const char* data;
+      int length;
+
+      for( int i = 0; i < _columns.nCols(); ++i ) {
+        if( _columns.rawValue( i, _currentRowNumber, data, length ) ) {
+          const int start = row._text.size();
+          row.appendUtf8( data, length );
+          row.appendTrimmed( start );
+        }
+        else {
+          row.appendString( _columns.value( i, _currentRowNumber ) );
+        }
+      }
+    }
+    else {
+      // Copying a QStringList only shares its data, and so allocates nothing.
+      _fieldData = _data.at( _currentRowNumber );
+      for( int i = 0; i < _fieldData.count(); ++i )
+        row.appendRef( &_fieldData.at(i) );
+    }
+
+    return row.count();
+  }
+
+  const int result = moveNext();
+
+  if( -1 == result ) {
+    return result;
+  }
+  else if( rowInSpans() ) {
+    const char* record = currentRecord();
+    for( int i = 0; i < _rowSpans.count(); ++i )
+      row.appendSpan( record, _rowSpans.at(i), _eolDelimiter, _recordIsAscii );
+  }
+  else {
+    for( int i = 0; i < _fieldData.count(); ++i )
+      row.appendRef( &_fieldData.at(i) );
+  }
+
+  return result;
+}
+
+
+QString QCsv::readLine() {
+  if( MemoryMapped == _mode )
+    return readMappedLine();
+
+  QByteArray arr;
+  int nQuotes = 0;
+  QString tmp;
+  QString result;
+
+  // The do loop handles situations where end-of-line
+  // characters are encountered inside quote marks.
+  do {
+    arr = _srcDevice->readLine();
+
+    // The end of the file, possibly in the middle of a quoted field
+    if( arr.isEmpty() ) {
+      _recordComplete = result.isEmpty();
+      break;
+    }
+
+    _recordComplete = arr.endsWith( '\n' );
+
+    arr.replace( '\0', "" );
+    tmp = arr;
+
+    // FIXME: Is there a better way to handle delimiters here?
+    if( !_delimiter.isSpace() )
+      tmp = tmp.trimmed();
+
+    result.append( tmp );
+
+    if( !result.isEmpty() )
+      result.append( _eolDelimiter );
+
+    nQuotes = nQuotes + tmp.count( '\"' );
+  } while( 0 != nQuotes%2 );
+
+  return result;
+}
+
+
+int QCsv::readHeader() {
+  int result = -1;
+  QStringList fieldList;
+
+  clearError();
+
+  _fieldData.clear();
+
+  _currentLine = readLine();
+
+  if( !_currentLine.isEmpty() ) {
+    ++_currentRowNumber;
+
+    // If the user wants to skip any lines, do that here.
+    if( _linesSkipped < _linesToSkip ) {
+      ++_linesSkipped;
+      return readHeader();
+    }
+
+    // This next block handles the situation where the file
+    // begins with a header (indicated by lines that start with #).
+    // These lines should simply be skipped.
+    if( _checkForComments && isCommentLine( _currentLine ) ) {
+      _comments.append( _currentLine );
+      return readHeader();
+    }
+
+    fieldList = splitLine( _currentLine );
+
+    for ( int i = 0; i < fieldList.size(); i++ ){
+      QString tempString = fieldList.at(i);
+      tempString = tempString.trimmed();
+
+      _fieldNames.append( tempString );
+      if( !_fieldsLookup.contains( tempString.toLower() ) )
+        _fieldsLookup.insert( tempString.toLower(), i );
+    }
+
+    _fieldData.clear();
+    result = _fieldNames.count();
+  }
+
+  return result;
+}
+
+
+void QCsv::addEqualsFilter( const QString& fieldName, const QString& value ) {
+  addInFilter( fieldName, QStringList( value ) );
+}
+
+
+void QCsv::addEqualsFilter( const int index, const QString& value ) {
+  addInFilter( index, QStringList( value ) );
+}
+
+
+void QCsv::addInFilter( const QString& fieldName, const QStringList& values ) {
+  RowFilter filter;
+  filter.fieldName = fieldName;
+  setFilterValues( filter, values );
+  _rowFilters.append( filter );
+}
+
+
+void QCsv::addInFilter( const int index, const QStringList& values ) {
+  RowFilter filter;
+  filter.fieldIndex = index;
+  setFilterValues( filter, values );
+  _rowFilters.append( filter );
+}
+
+
+void QCsv::addRangeFilter( const QString& fieldName, const double min, const double max ) {
+  RowFilter filter;
+  filter.fieldName = fieldName;
+  filter.isRange = true;
+  filter.min = min;
+  filter.max = max;
+  _rowFilters.append( filter );
+}
+
+
+void QCsv::addRangeFilter( const int index, const double min, const double max ) {
+  RowFilter filter;
+  filter.fieldIndex = index;
+  filter.isRange = true;
+  filter.min = min;
+  filter.max = max;
+  _rowFilters.append( filter );
+}
+
+
+void QCsv::clearRowFilters() {
+  _rowFilters.clear();
+  _maxFilterField = -1;
+}
+
+
+// Values that are pure ASCII are also kept as bytes, so that they can be compared directly with the raw bytes of
+// (unescaped, ASCII) fields.  A field like that can never be equal to any other value.
+void QCsv::setFilterValues( RowFilter& filter, const QStringList& values ) {
+  for( int i = 0; i < values.count(); ++i ) {
+    const QString& value = values.at(i);
+    filter.values.insert( value );
+
+    bool ascii = true;
+    for( int j = 0; j < value.length(); ++j ) {
+      if( 0x7F < value.at(j).unicode() ) {
+        ascii = false;
+        break;
+      }
+    }
+
+    if( ascii )
+      filter.asciiValues.insert( value.toLatin1() );
+  }
+}
+
+
+// Works out which field of the file each filter refers to, once the header has been read (and before any
+// projection replaces the field names).
+bool QCsv::setUpRowFilters() {
+  _maxFilterField = -1;
+  _nRowsFiltered = 0;
+
+  for( int i = 0; i < _rowFilters.count(); ++i ) {
+    RowFilter& filter = _rowFilters[i];
+
+    if( -1 == filter.fieldIndex ) {
+      const QString key = filter.fieldName.trimmed().toLower();
+
+      if( !_containsFieldList ) {
+        setError( ERROR_NO_FIELDLIST, QStringLiteral("Rows can only be filtered by field name if the file has a field list.") );
+        return false;
+      }
+      else if( !_fieldsLookup.contains( key ) ) {
+        setError( ERROR_INVALID_FIELD_NAME, QStringLiteral( "There is no field called %1" ).arg( filter.fieldName ) );
+        return false;
+      }
+
+      filter.sourceIndex = _fieldsLookup.value( key );
+    }
+    else if( ( 0 > filter.fieldIndex ) || ( _containsFieldList && ( _fieldNames.count() <= filter.fieldIndex ) ) ) {
+      setError( ERROR_INDEX_OUT_OF_RANGE, QStringLiteral( "There is no field %1" ).arg( filter.fieldIndex ) );
+      return false;
+    }
+    else {
+      filter.sourceIndex = filter.fieldIndex;
+    }
+
+    _maxFilterField = qMax( _maxFilterField, filter.sourceIndex );
+  }
+
+  return true;
+}
+
+
+bool QCsv::valuePassesFilter( const RowFilter& filter, const QString& value ) const {
+  if( filter.isRange ) {
+    bool ok;
+    const double d = fastStrToDouble( value, &ok );
+    return ( ok && ( filter.min <= d ) && ( d <= filter.max ) );
+  }
+  else {
+    return filter.values.contains( value );
+  }
+}
+
+
+// Checks a row that has already been split into strings, e.g. by splitLine().
+bool QCsv::fieldsPassFilters( const QStringList& fields ) const {
+  for( int i = 0; i < _rowFilters.count(); ++i ) {
+    const RowFilter& filter = _rowFilters.at(i);
+
+    if( ( filter.sourceIndex >= fields.count() ) || !valuePassesFilter( filter, fields.at( filter.sourceIndex ).trimmed() ) )
+      return false;
+  }
+
+  return true;
+}
+
+
+// Checks a row of raw bytes.  The record is split only as far as the last field that any filter needs, and only
+// the fields that filters need are looked at.  Where possible, they are compared as bytes, without creating strings.
+bool QCsv::recordPassesFilters( const char* record, const int length, const bool quoteAware, const bool isAscii, QVector<CSV::FieldSpan>& spans ) const {
+  const int nFields = CSV::splitRecord( record, length, _delimiter.toLatin1(), spans, quoteAware, _maxFilterField + 1 );
+
+  for( int i = 0; i < _rowFilters.count(); ++i ) {
+    const RowFilter& filter = _rowFilters.at(i);
+
+    if( filter.sourceIndex >= nFields )
+      return false;
+
+    const CSV::FieldSpan& span = spans.at( filter.sourceIndex );
+
+    if( isAscii && !span.escaped ) {
+      const char* p = record + span.start;
+      int len = span.length;
+
+      while( ( 0 < len ) && isspace( static_cast<unsigned char>( p[0] ) ) ) {
+        ++p;
+        --len;
+      }
+      while( ( 0 < len ) && isspace( static_cast<unsigned char>( p[len - 1] ) ) )
+        --len;
+
+      if( filter.isRange ) {
+        bool ok;
+        const double d = bytesToDouble( p, len, &ok );
+        if( !ok || ( d < filter.min ) || ( filter.max < d ) )
+          return false;
+      }
+      else if( !filter.asciiValues.contains( QByteArray::fromRawData( p, len ) ) ) {
+        return false;
+      }
+    }
+    else if( !valuePassesFilter( filter, CSV::spanToString( record, span, _eolDelimiter, isAscii ) ) ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+void QCsv::setSelectedFields( const QStringList& fieldNames ) {
+  _selectedFieldNames = fieldNames;
+  _selectedFieldIndexes.clear();
+}
+
+
+void QCsv::setSelectedFields( const QList<int>& indexes ) {
+  _selectedFieldIndexes = indexes;
+  _selectedFieldNames.clear();
+}
+
+
+// Works out which fields of the file are kept, once the header has been read.  If only some fields are selected,
+// the field names are replaced by the names of those fields, in the order in which they were selected.
+bool QCsv::setUpProjection() {
+  _projection.clear();
+  _sourceFieldCount = ( _containsFieldList ? _fieldNames.count() : 0 );
+
+  if( !_selectedFieldNames.isEmpty() ) {
+    if( !_containsFieldList ) {
+      setError( ERROR_NO_FIELDLIST, QStringLiteral("Fields can only be selected by name if the file has a field list.") );
+      return false;
+    }
+
+    for( int i = 0; i < _selectedFieldNames.count(); ++i ) {
+      const QString key = _selectedFieldNames.at(i).trimmed().toLower();
+
+      if( !_fieldsLookup.contains( key ) ) {
+        setError( ERROR_INVALID_FIELD_NAME, QStringLiteral( "There is no field called %1" ).arg( _selectedFieldNames.at(i) ) );
+        return false;
+      }
+
+      _projection.append( _fieldsLookup.value( key ) );
+    }
+  }
+  else if( !_selectedFieldIndexes.isEmpty() ) {
+    for( int i = 0; i < _selectedFieldIndexes.count(); ++i ) {
+      const int index = _selectedFieldIndexes.at(i);
+
+      if( ( 0 > index ) || ( _containsFieldList && ( _sourceFieldCount <= index ) ) ) {
+        setError( ERROR_INDEX_OUT_OF_RANGE, QStringLiteral( "There is no field %1" ).arg( index ) );
+        return false;
+      }
+
+      _projection.append( index );
+    }
+  }
+  else {
+    return true;
+  }
+
+  if( _containsFieldList ) {
+    const QStringList allNames = _fieldNames;
+    _fieldNames.clear();
+    _fieldsLookup.clear();
+
+    for( int i = 0; i < _projection.count(); ++i ) {
+      _fieldNames.append( allNames.at( _projection.at(i) ) );
+      if( !_fieldsLookup.contains( _fieldNames.last().toLower() ) )
+        _fieldsLookup.insert( _fieldNames.last().toLower(), i );
+    }
+  }
+
+  return true;
+}
+
+
+// Checks that a row read from the file has the expected number of fields, counting every field in the file
+// rather than only the selected ones.  Sets an error and returns false if it doesn't.
+bool QCsv::validFieldCount( const int nFields ) {
+  const int expected = ( _projection.isEmpty() ? fieldCount() : _sourceFieldCount );
+
+  if( ( 0 != expected ) && ( nFields != expected ) ) {
+    _error = ERROR_INVALID_FIELD_COUNT;
+    _errorMsg = QStringLiteral( "Line %1: %2 fields expected, but %3 fields encountered.  Please check your file format." )
+      .arg( QString::number( _currentRowNumber ), QString::number( expected ), QString::number( nFields ) )
+    ;
+    return false;
+  }
+
+  // Without a field list, every row in EntireFile mode should have as many fields as the first one.
+  if( !_projection.isEmpty() && ( 0 == _sourceFieldCount ) && ( EntireFile == _mode ) )
+    _sourceFieldCount = nFields;
+
+  return true;
+}
+
+
+QStringList QCsv::projectFields( const QStringList& fields ) const {
+  QStringList result;
+  result.reserve( _projection.count() );
+
+  for( int i = 0; i < _projection.count(); ++i ) {
+    const int src = _projection.at(i);
+    result.append( src < fields.count() ? fields.at( src ) : QString() );
+  }
+
+  return result;
+}
+
+
+// Keeps only the spans of the selected fields in the current row.  No strings are created for the others.
+void QCsv::projectSpans() {
+  const int nFields = _rowSpans.count();
+  _projectedSpans.resize( _projection.count() );
+
+  for( int i = 0; i < _projection.count(); ++i ) {
+    const int src = _projection.at(i);
+
+    if( src < nFields ) {
+      _projectedSpans[i] = _rowSpans.at( src );
+    }
+    else {
+      _projectedSpans[i].start = 0;
+      _projectedSpans[i].length = 0;
+      _projectedSpans[i].escaped = false;
+    }
+  }
+
+  _rowSpans.swap( _projectedSpans );
+}
+
+
+// Breaks a line (as returned by readLine()) into its component fields, according to the current settings.
+QStringList QCsv::splitLine( const QString& line ) const {
+  QStringList fieldList;
+
+  if ( _stringsContainDelimiters )
+    fieldList = CSV::parseLine( line, _delimiter );
+  else {
+    fieldList = line.split( _delimiter );
+    for( int i = 0; i < fieldList.count(); ++i ) {
+      if( fieldList.at(i).startsWith( '\"' ) && fieldList.at(i).endsWith( '\"' ) ) {
+        fieldList[i] = fieldList.at(i).mid( 1, fieldList.at(i).length() - 2 );
+      }
+    }
+  }
+
+  return fieldList;
+}
+
+
+//  Cause a read of a line of data from the csv file.
+//  Returns the number of fields read, or -1 at the end of the file.
+//  Rows that don't meet the conditions given by addEqualsFilter() etc. are skipped.
+int QCsv::readNext() {
+  int result;
+
+  do {
+    _rowRejected = false;
+
+    if( MemoryMapped == _mode )
+      result = readNextMapped();
+    else if( _byteRecords )
+      result = readNextRecord();
+    else
+      result = readNextLine();
+  } while( _rowRejected );
+
+  return result;
+}
+
+
+//  Reads the next row of data as a string, and splits it into fields.
+//  Returns the number of fields read, or -1 at the end of the file or if the row was rejected by a filter.
+int QCsv::readNextLine() {
+  int result = -1;
+  QStringList fieldList;
+
+  clearError();
+
+  _fieldData.clear();
+
+  _currentLine = readLine();
+
+  if( holdBackPartialRecord() ) {
+    _currentLine.clear();
+    return result;
+  }
+
+  if( !_currentLine.isEmpty() ) {
+    ++_currentRowNumber;
+
+    fieldList = splitLine( _currentLine );
+
+    if( !_rowFilters.isEmpty() && !fieldsPassFilters( fieldList ) ) {
+      ++_nRowsFiltered;
+      _rowRejected = true;
+    }
+    else if( !validFieldCount( fieldList.count() ) ) {
+      result = -1;
+    }
+    else {
+      if( !_projection.isEmpty() )
+        fieldList = projectFields( fieldList );
+
+      for ( int i = 0; i < fieldList.count(); i++ ){
+        QString tempString = fieldList.at(i);
+        tempString = tempString.trimmed();
+
+        _fieldData.insert( i, tempString );
+      }
+
+      result = _fieldData.count();
+
+      if( EntireFile == _mode ) {
+        storeRow( _fieldData );
+      }
+    }
+  }
+  else if ( !_srcDevice->atEnd() ){
+    _error = ERROR_BAD_READ;
+    _errorMsg = "Can not read next line.  Last line number was: " + QString::number ( _currentRowNumber ) + ".  Are we at the end of the file?";
+  }
+  else {
+    checkDecompression();
+  }
+
+  return result;
+}
+
+
+// Reads the rest of the file (everything after the header) in EntireFile mode, using all available cores.
+//
+// The file is divided into roughly equal byte ranges.  Since a quoted field may contain line breaks,
+// a range can't simply begin at the first line break after its nominal start: it has to be known whether
+// that line break falls inside quotation marks.  This is the same problem that readLine() handles by
+// counting quote marks, and it's solved here in the same way.  The quote marks in each range are counted
+// in parallel, and a running total then tells whether each range begins inside or outside of quotes.
+// Each range is then moved forward to the end of the record that straddles its nominal start, the ranges
+// are parsed in parallel, and the results are stitched back together in their original order.
+void QCsv::readAllInParallel() {
+  clearError();
+
+  QByteArray bytes = _srcDevice->readAll();
+  bytes.replace( '\0', "" );
+
+  const char* data = bytes.constData();
+  const qint64 size = bytes.size();
+
+  // Each chunk should be at least a megabyte or so: anything smaller isn't worth the overhead.
+  const int nChunks = int( qMin( qint64( qMax( 1, QThread::idealThreadCount() ) ), 1 + size/( 1024 * 1024 ) ) );
+
+  QVector<qint64> bounds( nChunks + 1 );
+  for( int k = 0; k <= nChunks; ++k ) {
+    bounds[k] = ( size * k )/nChunks;
+  }
+
+  QList< QFuture<int> > quoteCounts;
+  for( int k = 0; k < nChunks - 1; ++k ) {
+    quoteCounts.append( QtConcurrent::run( countQuotes, data, bounds.at(k), bounds.at(k + 1) ) );
+  }
+
+  QVector<qint64> starts( nChunks + 1 );
+  starts[0] = 0;
+  starts[nChunks] = size;
+
+  int nQuotes = 0;
+  for( int k = 1; k < nChunks; ++k ) {
+    nQuotes = nQuotes + quoteCounts.at( k - 1 ).result();
+
+    bool inQuote = ( 1 == nQuotes%2 );
+    qint64 pos = bounds.at(k);
+
+    while( pos < size ) {
+      pos = findAny( data, pos, size, '"', '\n', '\n', '\n', '\n' );
+
+      if( pos < size ) {
+        const bool isQuote = ( '"' == data[pos] );
+        ++pos;
+
+        if( isQuote )
+          inQuote = !inQuote;
+        else if( !inQuote )
+          break;
+      }
+    }
+
+    // A single enormous record may swallow the next nominal boundary, leaving an empty chunk.
+    starts[k] = qMax( pos, starts.at( k - 1 ) );
+  }
+
+  QList< QFuture<ParsedChunk> > chunks;
+  for( int k = 0; k < nChunks; ++k ) {
+    chunks.append( QtConcurrent::run( this, &QCsv::parseChunk, data, starts.at(k), starts.at(k + 1), size ) );
+  }
+
+  // Stitch the results together, applying the same checks as readNext().
+  // Every future must be waited for, even after a problem is found, because they all use 'bytes'.
+  bool stopped = false;
+
+  for( int k = 0; k < nChunks; ++k ) {
+    const ParsedChunk chunk = chunks.at(k).result();
+
+    if( stopped )
+      continue;
+
+    // Rows rejected by filters still count towards the row numbers used in error messages.
+    const int chunkStartRow = _currentRowNumber;
+
+    for( int i = 0; i < chunk.rows.count(); ++i ) {
+      _currentRowNumber = chunkStartRow + chunk.rowPositions.at(i);
+
+      if( !validFieldCount( chunk.fieldCounts.at(i) ) ) {
+        stopped = true;
+        break;
+      }
+
+      validateRow( chunk.rows.at(i) );
+      storeRow( chunk.rows.at(i) );
+    }
+
+    if( !stopped ) {
+      const int nRows = chunk.nRowsRead - ( chunk.stopped ? 1 : 0 ); // A blank line that ends the data isn't a row.
+      _currentRowNumber = chunkStartRow + nRows;
+      _nRowsFiltered = _nRowsFiltered + ( nRows - chunk.rows.count() );
+    }
+
+    if( !stopped && chunk.stopped ) {
+      if( chunk.badRead ) {
+        _error = ERROR_BAD_READ;
+        _errorMsg = "Can not read next line.  Last line number was: " + QString::number ( _currentRowNumber ) + ".  Are we at the end of the file?";
+      }
+      stopped = true;
+    }
+  }
+
+  if( ERROR_NONE == _error ) {
+    checkDecompression();
+  }
+}
+
+
+// Parses the complete records in data[start, end).  Called from worker threads by readAllInParallel(),
+// so this must not change the state of the object.
+QCsv::ParsedChunk QCsv::parseChunk( const char* data, const qint64 start, const qint64 end, const qint64 size ) const {
+  ParsedChunk result;
+  result.stopped = false;
+  result.badRead = false;
+  result.nRowsRead = 0;
+
+  qint64 pos = start;
+
+  // Used when rows can be split as raw bytes, as in readNextRecord()
+  QVector<CSV::FieldSpan> spans;
+  const char delimiter = _delimiter.toLatin1();
+
+  while( pos < end ) {
+    const qint64 recordEnd = CSV::findRecordEnd( data, end, pos );
+    const qint64 recordStart = pos;
+    pos = recordEnd;
+
+    QStringList fieldList;
+    int nFields;
+
+    ++result.nRowsRead;
+
+    if( _byteRecords ) {
+      qint64 lineEnd = recordEnd;
+      while( ( lineEnd > recordStart ) && ( ( '\n' == data[lineEnd - 1] ) || ( '\r' == data[lineEnd - 1] ) ) )
+        --lineEnd;
+
+      const char* record = data + recordStart;
+      const int length = int( lineEnd - recordStart );
+
+      bool isBlank = true;
+      for( int i = 0; i < length; ++i ) {
+        if( !isspace( static_cast<unsigned char>( record[i] ) ) ) {
+          isBlank = false;
+          break;
+        }
+      }
+
+      // As with readNext(), a blank line marks the end of the data.
+      if( isBlank ) {
+        result.stopped = true;
+        result.badRead = ( pos < size );
+        break;
+      }
+
+      // Only the fields that will be kept are converted to strings.
+      const bool isAscii = CSV::isAscii( record, length );
+
+      if( !_rowFilters.isEmpty() && !recordPassesFilters( record, length, true, isAscii, spans ) )
+        continue;
+
+      nFields = CSV::splitRecord( record, length, delimiter, spans, true );
+
+      if( _projection.isEmpty() ) {
+        fieldList.reserve( nFields );
+        for( int i = 0; i < nFields; ++i )
+          fieldList.append( CSV::spanToString( record, spans.at(i), _eolDelimiter, isAscii ) );
+      }
+      else {
+        fieldList.reserve( _projection.count() );
+        for( int i = 0; i < _projection.count(); ++i ) {
+          const int src = _projection.at(i);
+          fieldList.append( src < nFields ? CSV::spanToString( record, spans.at( src ), _eolDelimiter, isAscii ) : QString() );
+        }
+      }
+    }
+    else {
+      const QString line = lineFromRecord( data + recordStart, int( recordEnd - recordStart ) );
+
+      // As with readNext(), a blank line marks the end of the data.
+      if( line.isEmpty() ) {
+        result.stopped = true;
+        result.badRead = ( pos < size );
+        break;
+      }
+
+      fieldList = splitLine( line );
+      nFields = fieldList.count();
+
+      if( !_rowFilters.isEmpty() && !fieldsPassFilters( fieldList ) )
+        continue;
+
+      if( !_projection.isEmpty() )
+        fieldList = projectFields( fieldList );
+
+      for( int i = 0; i < fieldList.count(); ++i ) {
+        fieldList[i] = fieldList.at(i).trimmed();
+      }
+    }
+
+    result.rows.append( fieldList );
+    result.fieldCounts.append( nFields );
+    result.rowPositions.append( result.nRowsRead );
+  }
+
+  return result;
+}
+
+
+// Reads a record from a mapped file and converts it to a string, in exactly the same way
+// as readLine() would have.  This is only used to read the header and any comment lines:
+// rows of data are read by readNextMapped(), which does not create any strings at all.
+QString QCsv::readMappedLine() {
+  QString result;
+
+  if( _mapPos < _mapSize ) {
+    const char* data = reinterpret_cast<const char*>( _map );
+    const qint64 end = CSV::findRecordEnd( data, _mapSize, _mapPos );
+
+    result = lineFromRecord( data + _mapPos, int( end - _mapPos ) );
+    _mapPos = end;
+  }
+
+  return result;
+}
+
+
+QString QCsv::lineFromRecord( const char* record, const int length ) const {
+  QString result;
+  int lineStart = 0;
+
+  while( lineStart < length ) {
+    const char* nl = static_cast<const char*>( memchr( record + lineStart, '\n', size_t( length - lineStart ) ) );
+    const int lineEnd = ( nullptr == nl ) ? length : int( nl - record ) + 1;
+
+    QByteArray arr( record + lineStart, lineEnd - lineStart );
+    arr.replace( '\0', "" );
+    QString tmp = arr;
+
+    if( !_delimiter.isSpace() )
+      tmp = tmp.trimmed();
+
+    result.append( tmp );
+
+    if( !result.isEmpty() )
+      result.append( _eolDelimiter );
+
+    lineStart = lineEnd;
+  }
+
+  return result;
+}
+
+
+//  Locates the next row of data in a mapped file.
+//  Returns the number of fields read, or -1 at the end of the file.
+int QCsv::readNextMapped() {
+  int result = -1;
+
+  clearError();
+
+  _rowSpans.clear();
+
+  if( _mapPos >= _mapSize ) {
+    return result;
+  }
+
+  const char* data = reinterpret_cast<const char*>( _map );
+  const qint64 end = CSV::findRecordEnd( data, _mapSize, _mapPos );
+
+  _rowOffset = _mapPos;
+  _mapPos = end;
+
+  // Don't include the line break as part of the record.
+  qint64 recordEnd = end;
+  while( ( recordEnd > _rowOffset ) && ( ( '\n' == data[recordEnd - 1] ) || ( '\r' == data[recordEnd - 1] ) ) )
+    --recordEnd;
+
+  _rowLength = int( recordEnd - _rowOffset );
+
+  // As with readNext(), a blank line marks the end of the data.
+  bool isBlank = true;
+  for( qint64 i = _rowOffset; i < recordEnd; ++i ) {
+    if( !isspace( static_cast<unsigned char>( data[i] ) ) && ( '\0' != data[i] ) ) {
+      isBlank = false;
+      break;
+    }
+  }
+
+  if( isBlank ) {
+    if( _mapPos < _mapSize ) {
+      _error = ERROR_BAD_READ;
+      _errorMsg = "Can not read next line.  Last line number was: " + QString::number ( _currentRowNumber ) + ".  Are we at the end of the file?";
+    }
+    return result;
+  }
+
+  ++_currentRowNumber;
+
+  _recordIsAscii = CSV::isAscii( data + _rowOffset, _rowLength );
+
+  if( !_rowFilters.isEmpty() && !recordPassesFilters( data + _rowOffset, _rowLength, _stringsContainDelimiters, _recordIsAscii, _rowSpans ) ) {
+    _rowSpans.clear();
+    ++_nRowsFiltered;
+    _rowRejected = true;
+    return result;
+  }
+
+  const int nFields = CSV::splitRecord( data + _rowOffset, _rowLength, _delimiter.toLatin1(), _rowSpans, _stringsContainDelimiters );
+
+  if( !validFieldCount( nFields ) ) {
+    _rowSpans.clear();
+  }
+  else {
+    if( !_projection.isEmpty() )
+      projectSpans();
+
+    result = _rowSpans.count();
+  }
+
+  return result;
+}
+
+
+//  Reads the next row of data as raw bytes, in the same way that readNextMapped() reads it from a mapped file.
+//  Unlike readLine(), this doesn't convert the whole line to a string: fields are converted only when they are
+//  requested (in EntireFile mode, every row is stored, so all fields are converted right away).
+//  Returns the number of fields read, or -1 at the end of the file.
+int QCsv::readNextRecord() {
+  int result = -1;
+
+  clearError();
+
+  _fieldData.clear();
+  _currentLine.clear();
+  _rowSpans.clear();
+  _spanRow = false;
+
+  const qint64 length = readRecordBytes();
+
+  if( holdBackPartialRecord() )
+    return result;
+
+  const char* data = _recordBytes.constData();
+
+  // Don't include the line break as part of the record.
+  qint64 recordEnd = length;
+  while( ( recordEnd > 0 ) && ( ( '\n' == data[recordEnd - 1] ) || ( '\r' == data[recordEnd - 1] ) ) )
+    --recordEnd;
+
+  _rowLength = int( recordEnd );
+
+  // As with readNext(), a blank line marks the end of the data.
+  bool isBlank = true;
+  for( qint64 i = 0; i < recordEnd; ++i ) {
+    if( !isspace( static_cast<unsigned char>( data[i] ) ) && ( '\0' != data[i] ) ) {
+      isBlank = false;
+      break;
+    }
+  }
+
+  if( isBlank ) {
+    if( !_srcDevice->atEnd() ) {
+      _error = ERROR_BAD_READ;
+      _errorMsg = "Can not read next line.  Last line number was: " + QString::number ( _currentRowNumber ) + ".  Are we at the end of the file?";
+    }
+    else {
+      checkDecompression();
+    }
+    return result;
+  }
+
+  ++_currentRowNumber;
+
+  // Most records are pure ASCII, which can be converted to strings without decoding UTF-8.
+  _recordIsAscii = CSV::isAscii( data, _rowLength );
+
+  if( !_rowFilters.isEmpty() && !recordPassesFilters( data, _rowLength, true, _recordIsAscii, _rowSpans ) ) {
+    _rowSpans.clear();
+    ++_nRowsFiltered;
+    _rowRejected = true;
+    return result;
+  }
+
+  // The count is checked before _spanRow is set: as for readNext(), nothing is expected in LineByLine mode without a field list.
+  const int nFields = CSV::splitRecord( data, _rowLength, _delimiter.toLatin1(), _rowSpans, true );
+
+  if( !validFieldCount( nFields ) ) {
+    _rowSpans.clear();
+  }
+  else {
+    _spanRow = true;
+
+    if( !_projection.isEmpty() )
+      projectSpans();
+
+    result = _rowSpans.count();
+
+    if( EntireFile == _mode ) {
+      decodeSpanRow();
+      storeRow( _fieldData );
+    }
+  }
+
+  return result;
+}
+
+
+// Reads a record from the source file into _recordBytes.  As with readLine(), line breaks inside quotation
+// marks don't end the record.  The buffer is reused from one record to the next, and only ever grows.
+// Returns the number of bytes read, including the line break.
+qint64 QCsv::readRecordBytes() {
+  qint64 length = 0;
+  int nQuotes = 0;
+
+  while( true ) {
+    if( _recordBytes.size() - length < 1024 )
+      _recordBytes.resize( int( qMax( qint64( 2 ) * _recordBytes.size(), length + 4096 ) ) );
+
+    const qint64 n = _srcDevice->readLine( _recordBytes.data() + length, _recordBytes.size() - length );
+
+    if( 0 >= n )
+      break;
+
+    nQuotes = nQuotes + countQuotes( _recordBytes.constData(), length, length + n );
+    length = length + n;
+
+    // Carry on if the line didn't fit in the buffer, or if its line break is inside quotation marks.
+    if( ( '\n' == _recordBytes.at( int( length - 1 ) ) ) && ( 0 == nQuotes%2 ) )
+      break;
+  }
+
+  _recordComplete = ( ( 0 == length ) || ( ( '\n' == _recordBytes.at( int( length - 1 ) ) ) && ( 0 == nQuotes%2 ) ) );
+
+  return length;
+}
+
+
+// In follow mode, a record that is still being written when it is read is put back, to be read again once
+// it has been finished.  Returns true if that happened.
+bool QCsv::holdBackPartialRecord() {
+  if( !_follow )
+    return false;
+
+  _followScanned = qMax( _followScanned, _srcFile->pos() );
+
+  if( _recordComplete ) {
+    _followOffset = _srcFile->pos();
+    return false;
+  }
+  else {
+    _srcFile->seek( _followOffset );
+    return true;
+  }
+}
+
+
+bool QCsv::waitForMoreData( const int msecs /* = -1 */ ) {
+  clearError();
+
+  if( !_follow || ( LineByLine != _mode ) ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only files in follow mode can be waited for.") );
+    return false;
+  }
+  else if( !_isOpen || ( nullptr == _srcFile ) ) {
+    setError( ERROR_OPEN, QStringLiteral("Object is not open.") );
+    return false;
+  }
+
+  #ifdef Q_OS_LINUX
+    // The watch is set up before the size of the file is checked, so that nothing written in between is missed.
+    if( -1 == _followWatch ) {
+      _followWatch = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
 
-  if( LineByLine == _mode ) {
-    if( _isOpen )
-      return readNext();
-    else {
-      this->setError( ERROR_OPEN, QStringLiteral("Object is not open.") );
-      return -1;
+      if( ( -1 != _followWatch ) && ( -1 == inotify_add_watch( _followWatch, QFile::encodeName( _srcFilename ).constData(), IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF ) ) ) {
+        ::close( _followWatch );
+        _followWatch = -1;
+      }
     }
-  }
-  else {
-    ++_currentRowNumber;
+  #endif
 
-    if( _currentRowNumber < _data.count() ) {
-      _fieldData.clear();
-      _fieldData = _data.at( _currentRowNumber );
-      return _data.at( _currentRowNumber ).count();
+  QElapsedTimer timer;
+  timer.start();
+
+  while( true ) {
+    const qint64 size = _srcFile->size();
+
+    if( size < _followOffset ) {
+      setError( ERROR_BAD_READ, QStringLiteral("The followed file has been truncated or replaced: %1").arg( _srcFilename ) );
+      return false;
     }
-    else {
-      return -1;
+    else if( size > _followScanned ) {
+      // Whatever QFile has buffered is discarded, so that reading starts again with the last incomplete record.
+      _srcFile->seek( _followOffset );
+      return true;
     }
+
+    // Without inotify, the file is checked every 100 ms.  With it, the file is still checked every second,
+    // for file systems (e.g. network shares) that don't report changes.
+    int slice = 100;
+    if( 0 <= msecs ) {
+      const qint64 remaining = msecs - timer.elapsed();
+      if( 0 >= remaining )
+        return false;
+      slice = int( qMin( qint64( slice ), remaining ) );
+    }
+
+    #ifdef Q_OS_LINUX
+      if( -1 != _followWatch ) {
+        if( 0 <= msecs )
+          slice = int( qMin( qint64( 1000 ), msecs - timer.elapsed() ) );
+        else
+          slice = 1000;
+
+        struct pollfd pfd;
+        pfd.fd = _followWatch;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if( 0 < poll( &pfd, 1, qMax( 0, slice ) ) ) {
+          // Only the size of the file matters, so the events themselves are simply discarded.
+          char events[4096];
+          while( 0 < ::read( _followWatch, events, sizeof( events ) ) ) {}
+        }
+
+        continue;
+      }
+    #endif
+
+    QThread::msleep( ulong( slice ) );
   }
 }
 
 
-QString QCsv::readLine() {
-  QByteArray arr;
-  int nQuotes = 0;
-  QString tmp;
-  QString result;
+void QCsv::decodeSpanRow() {
+  _fieldData = rowData();
+  _currentLine = QString::fromUtf8( currentRecord(), _rowLength ).trimmed();
+  _rowSpans.clear();
+  _spanRow = false;
+}
 
-  // The do loop handles situations where end-of-line
-  // characters are encountered inside quote marks.
-  do {
-    arr = _srcFile->readLine();
-    arr.replace( '\0', "" );
-    tmp = arr;
 
-    // FIXME: Is there a better way to handle delimiters here?
-    if( !_delimiter.isSpace() )
-      tmp = tmp.trimmed();
+const char* QCsv::currentRecord() const {
+  if( MemoryMapped == _mode )
+    return reinterpret_cast<const char*>( _map ) + _rowOffset;
+  else
+    return _recordBytes.constData();
+}
 
-    result.append( tmp );
 
-    if( !result.isEmpty() )
-      result.append( _eolDelimiter );
+QString QCsv::spanField( const int index ) const {
+  return CSV::spanToString( currentRecord(), _rowSpans.at( index ), _eolDelimiter, _recordIsAscii );
+}
 
-    nQuotes = nQuotes + tmp.count( '\"' );
-  } while( 0 != nQuotes%2 );
 
-  return result;
+// The number of fields in the current row, regardless of mode.
+int QCsv::currentFieldCount() const {
+  switch( _mode ) {
+    case LineByLine:
+      return ( _spanRow ? _rowSpans.count() : _fieldData.count() );
+    case MemoryMapped:
+      return _rowSpans.count();
+    case EntireFile:
+      if( ( 0 <= _currentRowNumber ) && ( _currentRowNumber < dataRowCount() ) )
+        return ( _columnar ? _columns.nCols() : _data.at( _currentRowNumber ).count() );
+      else
+        return 0;
+    default:
+      return 0;
+  }
 }
 
 
-int QCsv::readHeader() {
-  int result = -1;
-  QStringList fieldList;
-
-  clearError();
+void QCsv::setColumnarStorage( const bool val ) {
+  _columnarStorage = val;
 
-  _fieldData.clear();
+  // If the data has already been loaded, move it now.
+  if( EntireFile == _mode ) {
+    if( val )
+      useColumnStorage();
+    else
+      useRowStorage();
+  }
+}
 
-  _currentLine = readLine();
 
-  if( !_currentLine.isEmpty() ) {
-    ++_currentRowNumber;
+int QCsv::dataRowCount() const {
+  return ( _columnar ? _columns.nRows() : _data.count() );
+}
 
-    // If the user wants to skip any lines, do that here.
-    if( _linesSkipped < _linesToSkip ) {
-      ++_linesSkipped;
-      return readHeader();
-    }
 
-    // This next block handles the situation where the file
-    // begins with a header (indicated by lines that start with #).
-    // These lines should simply be skipped.
-    if( _checkForComments && isCommentLine( _currentLine ) ) {
-      _comments.append( _currentLine );
-      return readHeader();
-    }
+QStringList QCsv::dataRow( const int row ) const {
+  return ( _columnar ? _columns.row( row ) : _data.at( row ) );
+}
 
-    if ( _stringsContainDelimiters )
-      fieldList = CSV::parseLine( _currentLine, _delimiter );
-    else {
-      fieldList = _currentLine.split( _delimiter );
-      for( int i = 0; i < fieldList.count(); ++i ) {
-        if( fieldList.at(i).startsWith( '\"' ) && fieldList.at(i).endsWith( '\"' ) ) {
-          fieldList[i] = fieldList.at(i).mid( 1, fieldList.at(i).length() - 2 );
-        }
-      }
-    }
 
-    for ( int i = 0; i < fieldList.size(); i++ ){
-      QString tempString = fieldList.at(i);
-      tempString = tempString.trimmed();
+QString QCsv::dataValue( const int col, const int row ) const {
+  return ( _columnar ? _columns.value( col, row ) : _data.at( row ).at( col ) );
+}
 
-      _fieldNames.append( tempString );
-      _fieldsLookup.insert( tempString.toLower(), i );
-    }
 
-    _fieldData.clear();
-    result = _fieldNames.count();
-  }
+void QCsv::storeRow( const QStringList& values ) {
+  invalidateIndexes();
 
-  return result;
+  if( _columnar )
+    _columns.appendRow( values );
+  else
+    _data.append( values );
 }
 
 
-//  Cause a read of a line of data from the csv file.
-//  Returns the number of fields read, or -1 at the end of the file.
-int QCsv::readNext() {
-  int result = -1;
-  QStringList fieldList;
+void QCsv::useRowStorage() {
+  if( _columnar ) {
+    _data = _columns.toRows();
+    _columns.clear();
+    _columnar = false;
+  }
+}
 
-  clearError();
 
-  _fieldData.clear();
+void QCsv::useColumnStorage() {
+  if( !_columnar ) {
+    _columns.setRows( _data );
+    _data.clear();
+    _columnar = true;
+  }
+}
 
-  _currentLine = readLine();
 
-  if( !_currentLine.isEmpty() ) {
-    ++_currentRowNumber;
+// Reformats every value in a column in EntireFile mode.  With columnar storage, the column is
+// converted to native values if possible.  Values that can't be converted are left as they are.
+bool QCsv::formatColumn( const int fieldIdx, const ColumnFormat columnFmt, const StrUtilsDateFormat dateFmt, const int defaultCentury ) {
+  bool result = true; // Until shown otherwise.
 
-    if ( _stringsContainDelimiters )
-      fieldList = CSV::parseLine( _currentLine, _delimiter );
-    else {
-      fieldList = _currentLine.split( _delimiter );
-      for( int i = 0; i < fieldList.count(); ++i ) {
-        if( fieldList.at(i).startsWith( '\"' ) && fieldList.at(i).endsWith( '\"' ) ) {
-          fieldList[i] = fieldList.at(i).mid( 1, fieldList.at(i).length() - 2 );
-        }
-      }
-    }
+  invalidateIndexes();
 
-    if( 0 != fieldCount() && ( fieldList.count() != fieldCount() ) ) {
-      _error = ERROR_INVALID_FIELD_COUNT;
-      _errorMsg = QStringLiteral( "Line %1: %2 fields expected, but %3 fields encountered.  Please check your file format." )
-        .arg( QString::number( _currentRowNumber ), QString::number( fieldCount() ), QString::number( fieldList.count() ) )
-      ;
-      result = -1;
+  if( _columnar ) {
+    QCsvColumnStore::ColumnType type;
+    switch( columnFmt ) {
+      case IntegerFormat: type = QCsvColumnStore::IntegerColumn; break;
+      case DoubleFormat: type = QCsvColumnStore::DoubleColumn; break;
+      default: type = QCsvColumnStore::DateColumn; break;
     }
-    else {
-      for ( int i = 0; i < fieldList.count(); i++ ){
-        QString tempString = fieldList.at(i);
-        tempString = tempString.trimmed();
 
-        _fieldData.insert( i, tempString );
-      }
+    if( _columns.setColumnType( fieldIdx, type, dateFmt, defaultCentury ) )
+      return true;
+  }
 
-      result = _fieldData.count();
+  QStringList values = ( _columnar ? _columns.column( fieldIdx ) : QStringList() );
 
-      if( EntireFile == _mode ) {
-        _data.append( _fieldData );
-      }
+  for( int row = 0; row < dataRowCount(); ++row ) {
+    QString& str = ( _columnar ? values[row] : _data[row][fieldIdx] );
+
+    if( !formatValue( str, columnFmt, dateFmt, defaultCentury ) ) {
+      setError( QCsv::ERROR_OTHER, QStringLiteral( "Format of cell at row %1, column %2 cannot be changed to %3." ).arg( row ).arg( fieldIdx ).arg( formatName( columnFmt ) ) );
+      result = false;
     }
   }
-  else if ( !_srcFile->atEnd() ){
-    _error = ERROR_BAD_READ;
-    _errorMsg = "Can not read next line.  Last line number was: " + QString::number ( _currentRowNumber ) + ".  Are we at the end of the file?";
-  }
+
+  if( _columnar )
+    _columns.setColumn( fieldIdx, values );
 
   return result;
 }
@@ -1712,46 +4716,28 @@ bool QCsv::setFieldFormat( const int fieldIdx, const ColumnFormat columnFmt, con
     result = false;
   }
   else {
-    Q_ASSERT( columnFmt == DateFormat ); // FIXME: Eventually, support time and date/time formats.
-
     switch( columnFmt ) {
       case DateFormat:
+      case IntegerFormat:
+      case DoubleFormat:
         if( EntireFile == _mode ) {
-          for( int row = 0; row < this->rowCount(); ++row ) {
-            QString str = _data.at(row).at(fieldIdx);
-            if( !str.isEmpty() ) {
-              QDate date = guessDateFromString( str, dateFmt, defaultCentury );
-
-              if( date.isValid() ) {
-                _data[row][fieldIdx] = date.toString( QStringLiteral("yyyy-MM-dd") );
-              }
-              else {
-                setError( QCsv::ERROR_OTHER, QStringLiteral( "Format of cell at row %1, column %2 cannot be changed to DateFormat." ).arg( row ).arg( fieldIdx ) );
-                result = false;
-              }
-            }
-          }
+          result = formatColumn( fieldIdx, columnFmt, dateFmt, defaultCentury );
         }
         else if( LineByLine == _mode ) {
-          QString str = _fieldData.at( fieldIdx );
-          if( !str.isEmpty() ) {
-            QDate date = guessDateFromString( str, dateFmt, defaultCentury );
+          if( _spanRow )
+            decodeSpanRow();
 
-            if( date.isValid() ) {
-              _fieldData[fieldIdx] = date.toString( QStringLiteral("yyyy-MM-dd") );
-            }
-            else {
-              setError( QCsv::ERROR_OTHER, QStringLiteral( "Format of data in field %1 cannot be changed to DateFormat." ).arg( fieldIdx ) );
-              result = false;
-            }
+          if( !formatValue( _fieldData[fieldIdx], columnFmt, dateFmt, defaultCentury ) ) {
+            setError( QCsv::ERROR_OTHER, QStringLiteral( "Format of data in field %1 cannot be changed to %2." ).arg( fieldIdx ).arg( formatName( columnFmt ) ) );
+            result = false;
           }
         }
         else {
-          // This should never happen: if a file is open, it's mode will have been set.
+          // MemoryMapped mode is read-only.  Otherwise, this should never happen:
+          // if a file is open, it's mode will have been set.
           setError( QCsv::ERROR_WRONG_MODE, QStringLiteral("Mode must be specified to set a field format.") );
           result = false;
         }
-
         break;
       //case TimeFormat: // Fall through, for now.
       //case DateTimeFormat: // Fall through, for now.
@@ -1766,6 +4752,216 @@ bool QCsv::setFieldFormat( const int fieldIdx, const ColumnFormat columnFmt, con
 }
 
 
+bool QCsv::inferFieldTypes() {
+  // This function will not work with qCSV_LineByLine mode.
+  Q_ASSERT( EntireFile == _mode );
+  clearError();
+
+  if( EntireFile != _mode ) {
+    setError( ERROR_WRONG_MODE, QStringLiteral("Only EntireFile mode may be used with this function.") );
+    return false;
+  }
+
+  setColumnarStorage( true );
+
+  for( int c = 0; c < _columns.nCols(); ++c ) {
+    _columns.inferColumnType( c );
+  }
+
+  return true;
+}
+
+
+QMetaType::Type QCsv::fieldType( const int index ) const {
+  if( !_columnar || ( 0 > index ) || ( _columns.nCols() <= index ) )
+    return QMetaType::QString;
+
+  switch( _columns.columnType( index ) ) {
+    case QCsvColumnStore::IntegerColumn: return QMetaType::LongLong;
+    case QCsvColumnStore::DoubleColumn: return QMetaType::Double;
+    case QCsvColumnStore::DateColumn: return QMetaType::QDate;
+    case QCsvColumnStore::BoolColumn: return QMetaType::Bool;
+    default: return QMetaType::QString;
+  }
+}
+
+
+QMetaType::Type QCsv::fieldType( const QString& fieldName ) {
+  return fieldType( fieldIndexOf( fieldName ) );
+}
+
+
+bool QCsv::isDictionaryField( const int index ) const {
+  return ( _columnar && ( 0 <= index ) && ( _columns.nCols() > index ) && ( QCsvColumnStore::DictionaryColumn == _columns.columnType( index ) ) );
+}
+
+
+bool QCsv::isNativeField( const int index, const QCsvColumnStore::ColumnType type ) const {
+  return(
+    _columnar
+    && ( 0 <= _currentRowNumber ) && ( _columns.nRows() > _currentRowNumber )
+    && ( 0 <= index ) && ( _columns.nCols() > index )
+    && ( type == _columns.columnType( index ) )
+    && !_columns.isNull( index, _currentRowNumber )
+  );
+}
+
+
+// Used by the typed accessors below: sets an error if there is no field called 'fieldName'.
+int QCsv::typedFieldIndex( const FieldHandle& handle, bool* ok ) {
+  if( !handle.isValid() ) {
+    _error = ERROR_INVALID_FIELD_NAME;
+    _errorMsg = "Invalid Field Name: " + handle.fieldName();
+    if( nullptr != ok )
+      *ok = false;
+  }
+
+  return handle.index();
+}
+
+
+int QCsv::typedFieldIndex( const QString& fieldName, bool* ok ) {
+  const int result = fieldIndexOf( fieldName );
+
+  if( -1 == result ) {
+    _error = ERROR_INVALID_FIELD_NAME;
+    _errorMsg = "Invalid Field Name: " + fieldName;
+    if( nullptr != ok )
+      *ok = false;
+  }
+
+  return result;
+}
+
+
+qint64 QCsv::fieldAsInt( const int index, bool* ok /* = nullptr */ ) {
+  qint64 result;
+  bool success;
+
+  if( isNativeField( index, QCsvColumnStore::IntegerColumn ) ) {
+    result = _columns.intValue( index, _currentRowNumber );
+    success = true;
+  }
+  else {
+    result = fastStrToInt64( field( index ), &success );
+  }
+
+  if( nullptr != ok )
+    *ok = success;
+
+  return result;
+}
+
+
+qint64 QCsv::fieldAsInt( const QString& fieldName, bool* ok /* = nullptr */ ) {
+  const int index = typedFieldIndex( fieldName, ok );
+  return ( ( -1 == index ) ? 0 : fieldAsInt( index, ok ) );
+}
+
+
+double QCsv::fieldAsDouble( const int index, bool* ok /* = nullptr */ ) {
+  double result;
+  bool success;
+
+  if( isNativeField( index, QCsvColumnStore::DoubleColumn ) ) {
+    result = _columns.doubleValue( index, _currentRowNumber );
+    success = true;
+  }
+  else if( isNativeField( index, QCsvColumnStore::IntegerColumn ) ) {
+    result = double( _columns.intValue( index, _currentRowNumber ) );
+    success = true;
+  }
+  else {
+    result = fastStrToDouble( field( index ), &success );
+  }
+
+  if( nullptr != ok )
+    *ok = success;
+
+  return result;
+}
+
+
+double QCsv::fieldAsDouble( const QString& fieldName, bool* ok /* = nullptr */ ) {
+  const int index = typedFieldIndex( fieldName, ok );
+  return ( ( -1 == index ) ? 0.0 : fieldAsDouble( index, ok ) );
+}
+
+
+QDate QCsv::fieldAsDate( const int index, bool* ok /* = nullptr */ ) {
+  QDate result;
+
+  if( isNativeField( index, QCsvColumnStore::DateColumn ) ) {
+    result = _columns.dateValue( index, _currentRowNumber );
+  }
+  else {
+    const QString str = field( index );
+    if( !str.isEmpty() )
+      result = guessDateFromString( str, UKDateFormat );
+  }
+
+  if( nullptr != ok )
+    *ok = result.isValid();
+
+  return result;
+}
+
+
+QDate QCsv::fieldAsDate( const QString& fieldName, bool* ok /* = nullptr */ ) {
+  const int index = typedFieldIndex( fieldName, ok );
+  return ( ( -1 == index ) ? QDate() : fieldAsDate( index, ok ) );
+}
+
+
+bool QCsv::fieldAsBool( const int index, bool* ok /* = nullptr */ ) {
+  bool result;
+  bool success;
+
+  if( isNativeField( index, QCsvColumnStore::BoolColumn ) ) {
+    result = _columns.boolValue( index, _currentRowNumber );
+    success = true;
+  }
+  else {
+    result = strToBool( field( index ), &success );
+  }
+
+  if( nullptr != ok )
+    *ok = success;
+
+  return result;
+}
+
+
+bool QCsv::fieldAsBool( const QString& fieldName, bool* ok /* = nullptr */ ) {
+  const int index = typedFieldIndex( fieldName, ok );
+  return ( ( -1 == index ) ? false : fieldAsBool( index, ok ) );
+}
+
+
+qint64 QCsv::fieldAsInt( const FieldHandle& handle, bool* ok /* = nullptr */ ) {
+  const int index = typedFieldIndex( handle, ok );
+  return ( ( -1 == index ) ? 0 : fieldAsInt( index, ok ) );
+}
+
+
+double QCsv::fieldAsDouble( const FieldHandle& handle, bool* ok /* = nullptr */ ) {
+  const int index = typedFieldIndex( handle, ok );
+  return ( ( -1 == index ) ? 0.0 : fieldAsDouble( index, ok ) );
+}
+
+
+QDate QCsv::fieldAsDate( const FieldHandle& handle, bool* ok /* = nullptr */ ) {
+  const int index = typedFieldIndex( handle, ok );
+  return ( ( -1 == index ) ? QDate() : fieldAsDate( index, ok ) );
+}
+
+
+bool QCsv::fieldAsBool( const FieldHandle& handle, bool* ok /* = nullptr */ ) {
+  const int index = typedFieldIndex( handle, ok );
+  return ( ( -1 == index ) ? false : fieldAsBool( index, ok ) );
+}
+
+
 // Protected members
 void QCsv::clearError(){
   _error = ERROR_NONE;
@@ -1832,7 +5028,7 @@ QString QCsv::asTable() {
   }
   else {
     for( int i = 0; i < this->fieldCount(); ++i ) {
-      arr << _data.at(0).at(i).length();
+      arr << dataValue( i, 0 ).length();
     }
   }
 
@@ -1840,7 +5036,7 @@ QString QCsv::asTable() {
   //-----------------------------------------------------
   for( int row = 0; row < this->rowCount(); ++row ) {
     for( int i = 0; i < this->fieldCount(); ++i ) {
-      arr[i] = qMax( arr.at(i), _data.at(row).at(i).length() );
+      arr[i] = qMax( arr.at(i), dataValue( i, row ).length() );
     }
   }
 
@@ -1865,7 +5061,7 @@ QString QCsv::asTable() {
   for( int row = 0; row < this->rowCount(); ++row ) {
     list.clear();
     for( int i = 0; i < this->fieldCount(); ++i ) {
-      list.append( QStringLiteral( "%1" ).arg( tablePadded( _data.at(row).at(i), arr.at(i) ) ) );
+      list.append( QStringLiteral( "%1" ).arg( tablePadded( dataValue( i, row ), arr.at(i) ) ) );
     }
     result.append( QStringLiteral( "|%1|\n" ).arg( list.join( '|' ) ) );
   }
@@ -1933,7 +5129,12 @@ QCsvObject::~QCsvObject() {
 
 int QCsvObject::readNext() {
   int result = QCsv::readNext();
-  emit nBytesRead( _currentLine.toUtf8().size() );
+
+  if( ( MemoryMapped == _mode ) || _byteRecords )
+    emit nBytesRead( _rowLength );
+  else
+    emit nBytesRead( _currentLine.toUtf8().size() );
+
   return result;
 }
 
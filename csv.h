@@ -25,6 +25,10 @@ Public License as published by the Free Software Foundation; either version 2 of
 #endif
 
 #include <ar_general_purpose/strutils.h>
+#include <ar_general_purpose/csvcolumnstore.h>
+#include <ar_general_purpose/csvrowindex.h>
+#include <ar_general_purpose/csvdialect.h>
+#include <ar_general_purpose/csvcache.h>
 
 /*
  * Basic use:
@@ -76,9 +80,63 @@ namespace CSV {
 
   // Writes a properly formatted multi-line CSV string from its component parts
   bool write(const QList<QStringList>& data, const QString &filename, const QChar delimiter = ',', const QString& codec = QString() );
+
+
+  // Lower-level functions for working directly with raw (UTF-8 or ASCII) bytes, without first
+  // converting them to QStrings.  These are used by QCsv::MemoryMapped mode, but may be useful elsewhere.
+  //------------------------------------------------------------------------------------------------------
+
+  // Describes the position of a single field within a record of raw bytes.
+  struct FieldSpan {
+    int start;    // Position of the first byte of the field, relative to the start of the record
+    int length;   // Number of bytes in the field, including any quote marks
+    bool escaped; // True if the field contains quote marks, line breaks, or NULs that need special handling
+  };
+
+  // Finds the end of the record that begins at position 'start' of 'data'.  As with QCsv::readLine(),
+  // line breaks that occur inside quotation marks do not end a record.
+  // Returns the position just after the record's line break, or 'length' if the end of the data is reached.
+  qint64 findRecordEnd( const char* data, const qint64 length, const qint64 start );
+
+  // Breaks a single record (without its terminating line break) into fields, without copying any data.
+  // Returns the number of fields found.
+  // If maxFields is positive, stops once that many fields have been found.
+  int splitRecord( const char* record, const int length, const char delimiter, QVector<FieldSpan>& spans, const bool quoteAware = true, const int maxFields = -1 );
+
+  // Converts the field described by 'span' to a QString, removing quote marks and surrounding white space
+  // in the same way that parseLine() does.  Line breaks inside the field are replaced by 'eolDelimiter'.
+  // If the caller has already checked that the record is pure ASCII, set isAscii to skip UTF-8 decoding.
+  QString spanToString( const char* record, const FieldSpan& span, const QString& eolDelimiter = QStringLiteral(" "), const bool isAscii = false );
+
+  // The bytes of an escaped field (see above), with quote marks removed and line breaks replaced by 'eol', in 'value'.
+  // Surrounding white space is left alone.  'value' can be reused from one field to the next.
+  void unescapeSpan( const char* record, const FieldSpan& span, const QByteArray& eol, QByteArray& value );
+
+  // Does data[0, length) contain only 7-bit ASCII characters?
+  bool isAscii( const char* data, const qint64 length );
 }
 
 
+class QCsvWriter;
+class QDecompressingReader;
+class QCsvRowBuffer;
+
+
+/* Checks each row of a file as QCsv reads it, so that data can be validated without a second pass.
+ * See QCsv::setValidator().  QCsvSchema is the usual implementation.
+ */
+class QCsvRowValidator {
+  public:
+    virtual ~QCsvRowValidator() { /* Nothing to do here */ }
+
+    // Called when a file has been opened, with the field names (if any) and the number of the line that held them.
+    virtual void beginValidation( const QStringList& fieldNames, const int headerLineNumber ) = 0;
+
+    // Called for each row of data that is read, with the row's fields and its line number (see QCsv::setValidator()).
+    virtual void validateRow( const QCsvRowBuffer& row, const int lineNumber ) = 0;
+};
+
+
 /* A class for reading, processing, and manipulating CSV-formatted data,
  * or other data that is similarly delimited.
  * This class will work with files or with multi-line strings, properly parsing
@@ -92,12 +150,21 @@ class QCsv {
      *    for processing very large data files for some applications.  This is because
      *    a line of data is read and can then be processed, but is not stored as part of the
      *    CSV object itself.  Access to data, then, is restricted to a single line at a time.
+     *    With the usual settings (an ASCII delimiter other than white space, and strings that may
+     *    contain delimiters), each line is split as raw UTF-8 bytes, and fields are only converted
+     *    to strings when they are requested.
      *  - Reading (or generating) the contents of an entire file all at once, which
      *    may be more flexible.  All data is stored as part of the CSV object, which consumes more
      *    memory, but all data is available at any time.
      *
-     * The values in this enum indicate which of these two modes is being used.  The
-     * The third mode, qCSV_UnspecifiedMode, is a sometimes used as a default setting
+     *  - Mapping the file into memory and reading rows directly from the mapped bytes.
+     *    As with line-by-line mode, only a single row is available at a time.  Rows are never
+     *    copied, however: the values of individual fields are only converted to strings when
+     *    they are requested via field() or rowData().  This is the fastest way to work through
+     *    very large ASCII or UTF-8 files.
+     *
+     * The values in this enum indicate which of these modes is being used.  The
+     * mode UnspecifiedMode is a sometimes used as a default setting
      * which must be changed before any real work can be carried out.
      */
     // FIXME: Do more with modes, to ensure that the object is in the right mode before and
@@ -105,7 +172,8 @@ class QCsv {
     enum QCsvMode {
       UnspecifiedMode,
       LineByLine,
-      EntireFile
+      EntireFile,
+      MemoryMapped
     };
 
     // Values in this enum are used to indicate error conditions.
@@ -125,7 +193,61 @@ class QCsv {
     enum ColumnFormat {
       DateFormat,
       TimeFormat,
-      DateTimeFormat
+      DateTimeFormat,
+      IntegerFormat,
+      DoubleFormat
+    };
+
+    // A field to sort on, and the direction in which to sort it.  See sorted().
+    struct SortKey {
+      SortKey( const int fieldIdx = 0, const Qt::SortOrder sortOrder = Qt::AscendingOrder ) { field = fieldIdx; order = sortOrder; }
+      int field;
+      Qt::SortOrder order;
+    };
+
+    // Kinds of join.  See join().
+    enum JoinType {
+      InnerJoin, // Only rows with a match in the other object
+      LeftJoin   // Every row of this object, with empty values where there is no match
+    };
+
+    // Summaries that may be calculated for each group of rows.  See groupBy().
+    enum AggregateFunction {
+      AggregateCount, // The number of rows (if no field is given) or of non-empty values in the field
+      AggregateSum,
+      AggregateMin,
+      AggregateMax,
+      AggregateMean
+    };
+
+    // A summary, the field to calculate it from, and (optionally) the name of the resulting field.
+    struct Aggregate {
+      Aggregate( const AggregateFunction fn = AggregateCount, const QString& field = QString(), const QString& name = QString() ) { function = fn; fieldName = field; outputName = name; }
+      AggregateFunction function;
+      QString fieldName;
+      QString outputName;
+    };
+
+    // A field, located by name once (see fieldHandle()) so that it can be read from row after row by position,
+    // without its name being looked up each time.  A handle remains valid until fields are added, removed, or
+    // reordered, or another file is opened.  See also QCsvRowReader, in csvrowreader.h.
+    class FieldHandle {
+      public:
+        FieldHandle() { _index = -1; }
+        FieldHandle( const FieldHandle& other ) { assign( other ); }
+        FieldHandle& operator=( const FieldHandle& other ) { assign( other ); return *this; }
+
+        bool isValid() const { return ( -1 != _index ); }
+        int index() const { return _index; }
+        QString fieldName() const { return _fieldName; }
+
+      protected:
+        friend class QCsv;
+        FieldHandle( const QString& fieldName, const int index ) { _fieldName = fieldName; _index = index; }
+        void assign( const FieldHandle& other ) { _fieldName = other._fieldName; _index = other._index; }
+
+        QString _fieldName;
+        int _index;
     };
 
     QCsv(); // Constructs an empty CSV object with an unspecified mode.  Use properties below to specify settings.
@@ -170,14 +292,17 @@ class QCsv {
     // Opens the file/object for reading/manipulation.  Returns false and sets an error flag if open failed.
     // This isn't strictly necessary for mode EntireFile, as it happens implicitly (at least when the main version of the constructor is used).
     // It's a good habit to get into, however, as explicitly opening a LineByLine file is required.
+    // Gzip- and zstd-compressed files are recognized by their contents and decompressed as they are read
+    // (see compressedio.h).  They can't be used in mode MemoryMapped.
     bool open();
     void close(); // Closes an open file.
-    bool toFront(); // Resets to the top of the file, so that moveNext() will return the first row of data.
+    bool toFront(); // Resets to the top of the file, so that moveNext() will return the first row of data.  Not available in line-by-line mode.
     int moveNext();  // Moves to the next row of data.  Returns the number of fields encountered, or -1 if the row is empty or does not exist.
+    int moveNext( QCsvRowBuffer& row ); // As above, and puts the fields of the row into a reusable buffer.  See QCsvRowBuffer.
 
     int fieldCount(); // The number of fields/columns in the CSV object
     int nCols() { return fieldCount(); }
-    int rowCount(); // The number of rows in the CSV object.  Not available in line-by-line mode.
+    int rowCount(); // The number of rows in the CSV object.  Not available in line-by-line or memory-mapped mode.
     int nRows() const;
 
     // The index of the current row.  Line 0 is the first row of data.  A current row number of
@@ -187,6 +312,7 @@ class QCsv {
     // Field/column names are case-insensitive.
     QString fieldName( const int index ) const; // Returns the field/column name of field/column index.
     int fieldIndexOf( const QString& fieldName ); // Returns the field/column number of the specified field name.
+    FieldHandle fieldHandle( const QString& fieldName ); // Locates the field once, for use with the functions below.  Check isValid().
     bool renameFields( const QStringList& newFieldNames ); // Rename all fields/columns with the names in the list.  The number of new names provided must match the number of existing names.
     bool renameField( QString oldName, QString newName ); // Change the name of field 'oldName' to 'newName'.
     bool containsFieldName( const QString& fieldName ); // Is there a field called 'fieldName'?
@@ -200,17 +326,35 @@ class QCsv {
     QString field( const int index ) const; // Same as above, but don't set the error message or otherwise mess with internals.
     QString field( const QString& fieldName );
     QString field( const QString& fieldName ) const; // Same as above, but don't set the error message or otherwise mess with internals.
+    QString field( const FieldHandle& handle );
+    QString field( const FieldHandle& handle ) const;
 
     // The field at position index (starting from 0) or with the name 'fieldName' of the row at 'rowNumber'.
     // Side-effect: move the current row number to 'rowNumber'.
-    // Available only in entire-file mode.
+    // Available only in entire-file mode, or in other modes with a row index (see useRowIndex()).
     QString field( const int index, const int rowNumber );
     QString field( const QString& fieldName, const int rowNumber );
 
     QString currentRow(); // Returns the current line of the object as a CSV-formatted string
     QStringList rowData(); // Returns all of the data from the current line of the object as a QStringList
-    QStringList rowData( const int idx ); // Returns all of the data from line idx of the object as a QStringList (only for entire-file mode)
-    QStringList rowData( const int idx ) const;
+    QStringList rowData( const int idx ); // Returns all of the data from line idx of the object as a QStringList (entire-file mode, or with a row index)
+    QStringList rowData( const int idx ) const; // Only for entire-file mode
+
+    // Random access to rows in LineByLine and MemoryMapped modes
+    //-----------------------------------------------------------
+    // useRowIndex() loads the positions of the rows of an open file from an index kept next to it (see QCsvRowIndex),
+    // or, if there is no index or the file has changed since it was built, builds the index in a single pass over the
+    // file and saves it for next time.  If it can't be saved (e.g. in a read-only directory), it's simply kept in memory.
+    // With an index, rows can be read in any order with seekToRow(), rowData( const int ), field( ..., rowNumber ), and rowRange().
+    // Rows are numbered from 0, as in EntireFile mode.  Compressed and followed files can't be indexed.
+    // Rows can't be read by number while there are row filters (see addEqualsFilter()), since those hide rows that
+    // the index counts: seekToRow(), and so the functions that use it, fail with ERROR_WRONG_MODE instead.
+    bool useRowIndex();
+    bool hasRowIndex() const { return _rowIndex.isValid(); }
+    int indexedRowCount() const { return _rowIndex.nRows(); }
+    QString rowIndexSaveError() const { return _rowIndexSaveError; } // Why useRowIndex() couldn't save a new index, if it couldn't.  The index is still used.
+    bool seekToRow( const int rowNumber ); // The next call to moveNext() will read row rowNumber.
+    QList<QStringList> rowRange( const int first, const int count ); // Reads up to count rows, starting with row first.
 
     // Returns all of the values in the column/field specified by 'index' or 'fieldName'.
     // Optionally: return only the unique values in this field (if 'unique' is true).
@@ -231,12 +375,41 @@ class QCsv {
     // It's not always possible to automatically determine the intended format of a column,
     // particularly for dates and times.  These functions, which can be called once a file is open,
     // will properly format a column with the indicated date or time format.
+    // With columnar storage (see setColumnarStorage()), date, integer, and double columns are also
+    // stored as native values rather than as strings.
     // For Excel dates, see CXlCsv::setFieldFormatXl(), which deals with the conversion of integers
     // to dates using either the 1900 and 1904 date systems.
     bool setFieldFormat( const QString& fieldName, const ColumnFormat columnFmt, const StrUtilsDateFormat dateFmt, const int defaultCentury = 2000 );
     bool setFieldFormat( const int fieldIdx, const ColumnFormat columnFmt, const StrUtilsDateFormat dateFmt, const int defaultCentury = 2000 );
 
-    bool writeFile( const QString &filename, const QString &codec = QString() ); // Write contents of the CSV object to a file.
+    // Examines every column and keeps those that hold only integers, doubles, booleans, or yyyy-MM-dd
+    // dates as native values (see QCsvColumnStore::inferColumnType()).  The text of each field is
+    // unchanged.  Available only in entire-file mode, and switches the object to columnar storage.
+    bool inferFieldTypes();
+
+    // The type of values held by a column: QMetaType::LongLong, QMetaType::Double, QMetaType::Bool,
+    // QMetaType::QDate, or (for columns without native storage) QMetaType::QString.
+    QMetaType::Type fieldType( const int index ) const;
+    QMetaType::Type fieldType( const QString& fieldName );
+
+    // The field at position index or with the name 'fieldName' of the current line, as a native value.
+    // Columns with native storage are read directly.  Other fields are converted from text, with
+    // strToBool() or guessDateFromString() (in UKDateFormat) as appropriate.  If the field is empty or
+    // can't be converted, 'ok' (if provided) is set to false.
+    qint64 fieldAsInt( const int index, bool* ok = nullptr );
+    qint64 fieldAsInt( const QString& fieldName, bool* ok = nullptr );
+    double fieldAsDouble( const int index, bool* ok = nullptr );
+    double fieldAsDouble( const QString& fieldName, bool* ok = nullptr );
+    QDate fieldAsDate( const int index, bool* ok = nullptr );
+    QDate fieldAsDate( const QString& fieldName, bool* ok = nullptr );
+    bool fieldAsBool( const int index, bool* ok = nullptr );
+    bool fieldAsBool( const QString& fieldName, bool* ok = nullptr );
+    qint64 fieldAsInt( const FieldHandle& handle, bool* ok = nullptr );
+    double fieldAsDouble( const FieldHandle& handle, bool* ok = nullptr );
+    QDate fieldAsDate( const FieldHandle& handle, bool* ok = nullptr );
+    bool fieldAsBool( const FieldHandle& handle, bool* ok = nullptr );
+
+    bool writeFile( const QString &filename, const QString &codec = QString() ); // Write contents of the CSV object to a file.  Files named *.gz or *.zst are compressed.
     bool displayTable( QTextStream* stream ); // Write a nicely formatted plain-text table to the stream.
 
     // Generates a subset of this object, with only rows in which the indicated field contains the indicated value (which may or may not be case-sensitive).
@@ -244,13 +417,55 @@ class QCsv {
     QCsv filter( const int index, const QString& value, const Qt::CaseSensitivity cs = Qt::CaseSensitive );
     QCsv filter( const QString& fieldName, const QString& value, const Qt::CaseSensitivity cs = Qt::CaseSensitive );
 
-    QCsv sorted( const int index );
-    QCsv sorted( const QString& fieldName );
+    // Returns a copy of this object, sorted on one or more fields.  Sorts are stable: rows with equal
+    // keys keep their original order.  Fields with native storage (see fieldType()), or that contain
+    // nothing but numbers, are compared as numbers.  Other fields are compared as text.  Empty values
+    // come before all others.
+    // These functions work only in entire-file mode.
+    QCsv sorted( const int index, const Qt::SortOrder order = Qt::AscendingOrder );
+    QCsv sorted( const QString& fieldName, const Qt::SortOrder order = Qt::AscendingOrder );
+    QCsv sorted( const QList<SortKey>& keys );
+
+    // The sorted order of the rows, as above, without copying any data: element i is the number of
+    // the row that would be at position i.  Use with rowData( const int ) or field( ..., rowNumber ).
+    QVector<int> sortOrder( const QList<SortKey>& keys );
 
     // Returns a subset of this object, containing only rows that are distinct.
     // This function currently works only in entire-file mode.
     QCsv distinct();
 
+    // Joins this object to 'other' on one or more key fields, given by name and paired in order.  Keys match if
+    // all of their values are identical.  The result has every field of this object, followed by every field of
+    // 'other' except its keys.  Names from 'other' that are already in use get a suffix (e.g. "name_2").
+    // Rows appear in the order of this object, and the matches for each row in the order of 'other'.
+    // The rows of 'other' are held in a hash table, so 'other' must be in entire-file mode.  An index on its key
+    // field (see createIndex()) is used if there is one.  This object is read one row at a time, and may be in any
+    // mode: in modes other than entire-file, rows that haven't yet been read are joined.  When one of the two files
+    // is very large, it should therefore be this one.
+    QCsv join( QCsv& other, const QStringList& keyFields, const JoinType joinType = InnerJoin );
+    QCsv join( QCsv& other, const QStringList& keyFields, const QStringList& otherKeyFields, const JoinType joinType = InnerJoin );
+
+    // As above, but the joined rows are written straight to an open writer instead of being held in memory.
+    bool join( QCsv& other, const QStringList& keyFields, const QStringList& otherKeyFields, const JoinType joinType, QCsvWriter* writer );
+
+    // Groups rows with identical values in the key fields, and summarizes each group.  The result has the key
+    // fields, followed by a field for each aggregate (named, unless specified, e.g. "count", "sum_weight", or
+    // "max_date"), and one row for each group in order of first appearance.  With no key fields, all rows form
+    // a single group.  Sum and mean ignore empty values and values that aren't numbers.  Min and max compare
+    // numbers as numbers, unless the group contains other text, in which case all values are compared as text.
+    // Groups are held in a hash table and rows are read one at a time, so this works in any mode (see join()).
+    QCsv groupBy( const QStringList& keyFields, const QList<Aggregate>& aggregates );
+
+    // An index on a field makes filter(), fieldValues( ..., true ), and distinct() much faster with
+    // large data sets: these functions use any available index automatically.  The index itself is
+    // built the first time that it's needed, and is discarded whenever the data change, to be rebuilt
+    // when it is next needed.  Indexes are available only in entire-file mode.
+    bool createIndex( const int index );
+    bool createIndex( const QString& fieldName );
+    void dropIndex( const int index ) { _indexedFields.remove( index ); _fieldIndexes.remove( index ); }
+    void dropIndexes() { _indexedFields.clear(); _fieldIndexes.clear(); }
+    bool hasIndex( const int index ) const { return _indexedFields.contains( index ); }
+
     // Functions for modifying a CSV object in memory. These work only for read mode qCSV_EntireFile.
     bool appendField( const QString& fieldName ); // Add a new field/column with the name 'fieldName'.  The field will be empty, but can be added to with setField.
     bool removeField( const QString& fieldName ); // Remove the field/column 'fieldName' (as well as all data in the column!)
@@ -288,9 +503,109 @@ class QCsv {
     void setDelimiter( const QChar val ) { _delimiter = val; } // The delimiter character.  Default value is a comma.
     QChar delimiter() const { return _delimiter; }
 
+    // The encoding of the file, as a name that QTextCodec recognizes (e.g. "windows-1252" or "UTF-16LE").  An empty name
+    // (the default) means UTF-8.  Files in other encodings are converted to UTF-8 as they are read: these can't be used
+    // in MemoryMapped or follow mode, or with a row index.  A UTF-8 byte order mark at the start of a file is skipped, and
+    // a file that starts with a UTF-16 byte order mark is read as UTF-16, whatever the setting.
+    void setCodec( const QString& val ) { _codec = val; }
+    QString codec() const { return _codec; }
+
+    // Working out the delimiter, whether there is a field list, and the encoding from the start of the file (see QCsvDialect).
+    // If autoDetectDialect is true, this is done each time the file is opened, and replaces any values set for
+    // these properties.  Default value is false.  Comments and lines to skip are taken into account, so set those first.
+    void setAutoDetectDialect( const bool val ) { _autoDetectDialect = val; }
+    bool autoDetectDialect() const { return _autoDetectDialect; }
+    bool detectDialect( const int sampleSize = QCsvDialect::defaultSampleSize ); // Does it now.  Returns false if the file can't be read.
+    void setDialect( const QCsvDialect& dialect ); // Uses a dialect that was detected elsewhere, e.g. for another file from the same source
+    QCsvDialect dialect() const { return _dialect; } // The dialect that was last detected or set
+
     void setMode( const QCsvMode val ) { _mode = val; } // Either line-by-line or entire-file.  See enum above.
     QCsvMode mode() const { return _mode; }
 
+    // Reading only some of the fields of a file.  If fields are selected before open() is called, the object behaves as
+    // though the file contained only those fields, in the order in which they were selected.  Other fields are skipped
+    // as each row is parsed: they aren't converted to strings or stored, so memory use and parsing time depend mostly on
+    // the number of fields selected.  Fields may be selected by name (if the file has a field list) or by position in
+    // the file, starting from 0.  Rows are still checked for the right number of fields in the file as a whole.
+    // An empty list (the default) selects every field.  Note that currentRow() still returns the whole line.
+    void setSelectedFields( const QStringList& fieldNames );
+    void setSelectedFields( const QList<int>& indexes );
+    bool hasSelectedFields() const { return !( _selectedFieldNames.isEmpty() && _selectedFieldIndexes.isEmpty() ); }
+
+    // Reading only the rows that meet some conditions.  Conditions added before open() is called are checked as each
+    // row is read, and rows that fail are skipped: the object behaves as though they weren't in the file.  A row
+    // is split only as far as the last field that a condition needs, and other fields of rejected rows are never
+    // looked at, converted to strings, or stored.  A row must meet every condition.  Fields are identified as for
+    // setSelectedFields(), but don't have to be selected.  Values are compared with the (trimmed) value of the field.
+    void addEqualsFilter( const QString& fieldName, const QString& value );
+    void addEqualsFilter( const int index, const QString& value );
+    void addInFilter( const QString& fieldName, const QStringList& values ); // The value is one of these
+    void addInFilter( const int index, const QStringList& values );
+    void addRangeFilter( const QString& fieldName, const double min, const double max ); // A number between min and max, inclusive
+    void addRangeFilter( const int index, const double min, const double max );
+    void clearRowFilters();
+    qint64 nRowsFiltered() const { return _nRowsFiltered; } // How many rows have been skipped since the file was opened
+
+    // If true, then a file opened in LineByLine mode is followed as it grows, like "tail -f".  Default value is false.
+    // When moveNext() reaches the end of the data written so far, call waitForMoreData() and then carry on
+    // calling moveNext().  A last line that hasn't been completely written yet is never returned: it's read
+    // again, once it is complete.  Compressed files can't be followed, and any header must already have been
+    // written when the file is opened.
+    void setFollow( const bool val ) { _follow = val; }
+    bool follow() const { return _follow; }
+
+    // Waits until data are appended to a followed file, or until msecs milliseconds have passed (if msecs
+    // is negative, waits indefinitely).  Returns true if there is more to read.  Changes to the file are
+    // watched for with inotify on Linux.  Elsewhere, the size of the file is checked 10 times per second.
+    // If the file shrinks (i.e., it has been replaced or truncated), ERROR_BAD_READ is set and false is returned.
+    bool waitForMoreData( const int msecs = -1 );
+
+    // In follow mode, the position in the file just after the last complete row that was read.
+    qint64 followOffset() const { return _followOffset; }
+
+    // If true, then a file opened in EntireFile mode is divided into chunks that are parsed
+    // simultaneously on all available processor cores.  Default value is false.
+    // Note that QCsvObject::nBytesRead() is not emitted for files that are loaded in this way.
+    void setParallelLoad( const bool val ) { _parallelLoad = val; }
+    bool parallelLoad() const { return _parallelLoad; }
+
+    // If true, then data in EntireFile mode is kept column by column (see QCsvColumnStore) rather than
+    // as a list of string lists.  This uses much less memory, and makes column operations like fieldValues(),
+    // filter(), sorted(), and distinct() faster.  Default value is false.
+    // The setting can be changed at any time.  Functions that modify existing data (setField(),
+    // appendField(), removeField(), etc.) quietly switch the object back to row storage first.
+    void setColumnarStorage( const bool val );
+    bool columnarStorage() const { return _columnarStorage; }
+    bool usingColumnarStorage() const { return _columnar; } // Is the data currently being kept in columns?
+
+    // With columnar storage, a field with no more than this many distinct values is kept as a dictionary: each value is
+    // stored once, with a small code for each row (see QCsvColumnStore).  Fields like codes, categories, and statuses then
+    // use far less memory, and filter(), fieldValues( ..., true ), and distinct() work on the codes rather than on strings.
+    // Fields with more distinct values are stored as usual.  0 turns this off.  Default value is 1024.
+    // The limit applies to data loaded (or moved into columns) after it is set.
+    void setDictionaryLimit( const int val ) { _columns.setDictionaryLimit( val ); }
+    int dictionaryLimit() const { return _columns.dictionaryLimit(); }
+
+    // If true, then a file opened in EntireFile mode is loaded from a binary cache kept next to it (see QCsvCache), if there
+    // is one that is up to date and was written with the same settings.  Otherwise, the file is parsed as usual and the cache
+    // is written for next time.  Column types (see inferFieldTypes()) are kept in the cache.  Default value is false.
+    void setUseCache( const bool val ) { _useCache = val; }
+    bool useCache() const { return _useCache; }
+    bool loadedFromCache() const { return _loadedFromCache; } // Was the file that was last opened loaded from its cache?
+    QString cacheSaveError() const { return _cacheSaveError; } // Why the cache couldn't be written when the file was last opened, if it couldn't
+
+    // If a validator (e.g., a QCsvSchema) is set, then every row of data is passed to it as the file is read: as the file is
+    // loaded in EntireFile mode, or as moveNext() is called in other modes.  Rows rejected by filters aren't checked.
+    // Lines are counted as records, from 1 at the top of the file: a quoted line break doesn't start a new line.
+    // The validator isn't owned by this object, and isn't shared with copies of it.  While it is set, a file isn't
+    // loaded from its cache (see setUseCache()), since the rows must be read to be checked.
+    void setValidator( QCsvRowValidator* validator ) { _validator = validator; }
+    QCsvRowValidator* validator() const { return _validator; }
+
+    // If true, then inferFieldTypes() is called when a file is opened in EntireFile mode.  Default value is false.
+    void setAutoFieldTypes( const bool val ) { _autoFieldTypes = val; }
+    bool autoFieldTypes() const { return _autoFieldTypes; }
+
     // If true, then lines at the start of the file that begin with '#' will be treated as comments and will not be processed.
     // Default value is false.
     // Note that this currently is not used to find and skip comments that occur anywhere else in a file: only the lines at the top are checked.
@@ -328,11 +643,78 @@ class QCsv {
   protected:
     void initialize();
     virtual int readNext();
+    int readNextLine();
     void assign( const QCsv& other );
 
     bool openFileAndReadHeader();
+    bool loadCache();
+    bool saveCache();
+    QString cacheSettings() const; // Describes everything that affects what is read from a file
+    static bool hasUtf16Bom( const QByteArray& leadingBytes );
+    void checkDecompression();
     int readHeader();
     QString readLine();
+    QStringList splitLine( const QString& line ) const;
+    bool validFieldCount( const int nFields );
+    void rebuildFieldsLookup();
+
+    // Used when rows are filtered
+    struct RowFilter {
+      RowFilter() { fieldIndex = -1; isRange = false; min = 0.0; max = 0.0; sourceIndex = -1; }
+      QString fieldName;              // Either the name...
+      int fieldIndex;                 // ...or the position of the field, as given
+      bool isRange;
+      double min;
+      double max;
+      QSet<QString> values;
+      QSet<QByteArray> asciiValues;   // The ASCII values, for comparison with raw bytes
+      int sourceIndex;                // The position of the field in the file, once it is open
+    };
+    void setFilterValues( RowFilter& filter, const QStringList& values );
+    bool setUpRowFilters();
+    bool valuePassesFilter( const RowFilter& filter, const QString& value ) const;
+    bool fieldsPassFilters( const QStringList& fields ) const;
+    bool recordPassesFilters( const char* record, const int length, const bool quoteAware, const bool isAscii, QVector<CSV::FieldSpan>& spans ) const;
+
+    // Used when only some fields are selected
+    bool setUpProjection();
+    QStringList projectFields( const QStringList& fields ) const;
+    void projectSpans();
+
+    // Used for parallel loading in EntireFile mode
+    struct ParsedChunk {
+      QList<QStringList> rows;
+      bool stopped; // Was a blank line encountered before the end of the chunk?
+      bool badRead; // Was that blank line followed by more data?
+      QVector<int> fieldCounts; // The number of fields in each row of the file, before any fields were skipped
+      QVector<int> rowPositions; // The position of each row among the rows read, counting those rejected by filters
+      int nRowsRead;
+    };
+    void readAllInParallel();
+    ParsedChunk parseChunk( const char* data, const qint64 start, const qint64 end, const qint64 size ) const;
+
+    // Used with mode MemoryMapped
+    bool mapSourceFile();
+    int readNextMapped();
+    QString readMappedLine();
+    QString lineFromRecord( const char* record, const int length ) const;
+    int currentFieldCount() const;
+
+    // Used to read UTF-8 files as raw bytes in other modes (see readNextRecord())
+    int readNextRecord();
+    qint64 readRecordBytes();
+    bool holdBackPartialRecord(); // Used in follow mode
+    void decodeSpanRow(); // Converts the fields of the current row to strings in _fieldData, e.g. before they are changed
+
+    // Access to the current row when it is held as spans of raw bytes, in MemoryMapped mode or when reading bytes
+    bool rowInSpans() const { return ( ( MemoryMapped == _mode ) || _spanRow ); }
+    const char* currentRecord() const;
+    QString spanField( const int index ) const;
+
+    // Used with a validator
+    void beginValidation();
+    void validateCurrentRow();
+    void validateRow( const QStringList& values );
 
     bool identicalFieldNames( const QStringList& otherNames );
 
@@ -347,8 +729,37 @@ class QCsv {
     QString tablePadded( const QString& val, const int len );
     QString tableDiv( const int len );
 
+    // Access to rows of data in EntireFile mode, regardless of how they are stored.
+    int dataRowCount() const;
+    QStringList dataRow( const int row ) const;
+    QString dataValue( const int col, const int row ) const;
+    void storeRow( const QStringList& values );
+    void useRowStorage(); // Moves data from columns to rows, before the data is changed.
+    void useColumnStorage();
+    bool formatColumn( const int fieldIdx, const ColumnFormat columnFmt, const StrUtilsDateFormat dateFmt, const int defaultCentury );
+    bool isNativeField( const int index, const QCsvColumnStore::ColumnType type ) const; // Is the field in the current row stored as a non-null value of this type?
+    bool isDictionaryField( const int index ) const; // Is the field kept as a dictionary (see setDictionaryLimit())?
+    int typedFieldIndex( const QString& fieldName, bool* ok );
+    int typedFieldIndex( const FieldHandle& handle, bool* ok );
+    bool sortNumbers( const int index, QVector<double>& numbers );
+    bool fieldIndexes( const QStringList& fieldNames, QVector<int>& indexes ); // Looks up several fields by name
+    bool joinRows( QCsv& other, const QStringList& keyFields, const QStringList& otherKeyFields, const JoinType joinType, QCsv* result, QCsvWriter* writer );
+    bool nextSourceRow( int& row ); // Reads the next row for join() and groupBy(), in any mode
+    QString sourceValue( const int col, const int row ) const; // A value from that row
+
+    // The rows, in order, in which each (trimmed) value in a field appears.
+    typedef QHash<QString, QVector<int> > FieldIndex;
+    const FieldIndex& fieldIndex( const int index ); // Builds the index, if necessary
+    void invalidateIndexes() { _fieldIndexes.clear(); } // Call whenever any data change
+
     QString      _srcFilename;
     QFile*       _srcFile;
+    QIODevice*   _srcDevice;    // Where data are read from: _srcFile, _decompressor for a compressed file, or _transcoder
+    QDecompressingReader* _decompressor;
+    QTranscodingReader* _transcoder; // Reads from _srcFile or _decompressor, for files that aren't UTF-8
+    QString      _codec;
+    bool         _autoDetectDialect;
+    QCsvDialect  _dialect;
     bool         _isOpen;
     QString      _currentLine;
     int          _currentRowNumber;
@@ -367,8 +778,15 @@ class QCsv {
 
     // Key is the field name, converted to lower case.
     // Value is the position of the field in the file (i.e., the column number), starting from 0.
+    // If several fields have the same name, the value is the position of the first.
     QHash<QString, int> _fieldsLookup;
 
+    // Fields found by fieldIndexOf().  Key is the name exactly as it was asked for.  Value is the position
+    // of the field and the name found there, which is checked before the position is used: fields may have
+    // changed since.  Loops tend to ask for the same few fields over and over, and checking an answer is
+    // cheaper than trimming and lower-casing the name to look it up again.
+    QHash<QString, QPair<int, QString> > _lookupCache;
+
     // List of field names as they were in the original file.
     QStringList _fieldNames;
 
@@ -377,6 +795,67 @@ class QCsv {
 
     // All rows of data, if an entire file has been read into memory.
     QList<QStringList> _data;
+
+    // Used with mode MemoryMapped
+    uchar* _map;              // Start of the mapped file
+    qint64 _mapSize;          // Size of the mapped file, in bytes
+    qint64 _mapPos;           // Position of the next record to be read
+    qint64 _dataStart;        // Position of the first row of data (after the header, comments, etc.), also used by the row index
+    int _dataStartRow;        // Row number to return to when toFront() is called
+    qint64 _rowOffset;        // Position of the current record
+    int _rowLength;           // Length of the current record, excluding its line break
+    QVector<CSV::FieldSpan> _rowSpans; // Locations of the fields in the current record
+
+    // Used when reading raw bytes in other modes
+    bool _byteRecords;        // Are rows read as raw bytes, rather than line by line as strings?
+    bool _spanRow;            // Is the current row held in _recordBytes and _rowSpans, rather than in _fieldData?
+    QByteArray _recordBytes;  // Buffer holding the current record
+    bool _recordIsAscii;      // Does the current record (mapped or read) contain only ASCII characters?
+    bool _recordComplete;     // Did the last record read end with a line break (outside of quotation marks)?
+
+    // Used in follow mode
+    bool _follow;
+    qint64 _followOffset;     // Position just after the last complete record
+    qint64 _followScanned;    // How much of the file has been read, including any incomplete record at the end
+    int _followWatch;         // inotify descriptor, on Linux
+
+    bool _parallelLoad;
+
+    // Used with columnar storage
+    bool _columnarStorage;     // Should data be stored in columns?
+    bool _columnar;            // Is data currently stored in columns (in _columns), rather than in _data?
+    QCsvColumnStore _columns;
+
+    // Used with the binary cache
+    bool _useCache;
+    bool _loadedFromCache;
+    QString _cacheSaveError;
+
+    // Used to validate rows as they are read
+    QCsvRowValidator* _validator;
+    QCsvRowBuffer* _validationRow; // Created when first needed, and reused for every row
+
+    // Used for random access in other modes
+    QCsvRowIndex _rowIndex;
+    QString _rowIndexSaveError;
+
+    // Used when only some fields are selected
+    QStringList _selectedFieldNames;
+    QList<int> _selectedFieldIndexes;
+    QVector<int> _projection;   // The position in the file of each selected field, once the file is open
+    int _sourceFieldCount;      // The number of fields in each row of the file, if known
+    QVector<CSV::FieldSpan> _projectedSpans; // Reused to hold the selected spans of each row
+
+    // Used when rows are filtered
+    QList<RowFilter> _rowFilters;
+    int _maxFilterField;        // The last field in the file that any filter needs
+    bool _rowRejected;          // Was the row just read rejected by a filter?
+    qint64 _nRowsFiltered;
+    bool _autoFieldTypes;
+
+    // Used with hash indexes
+    QSet<int> _indexedFields;               // Fields that should be indexed
+    QHash<int, FieldIndex> _fieldIndexes;   // Indexes that have actually been built
 };
 
 
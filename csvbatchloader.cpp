@@ -0,0 +1,277 @@
+/*
+csvbatchloader.h/cpp
+--------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvbatchloader.h"
+
+#include <QtConcurrent>
+
+QCsvBatchLoader::QCsvBatchLoader() {
+  initialize();
+}
+
+
+QCsvBatchLoader::QCsvBatchLoader( const CFileList& files ) {
+  initialize();
+  setFiles( files );
+}
+
+
+QCsvBatchLoader::QCsvBatchLoader( const QCsvBatchLoader& other ) {
+  assign( other );
+}
+
+
+QCsvBatchLoader& QCsvBatchLoader::operator=( const QCsvBatchLoader& other ) {
+  assign( other );
+  return *this;
+}
+
+
+void QCsvBatchLoader::initialize() {
+  _files.clear();
+  _settings = QCsv();
+  _maxThreads = qMax( 1, QThread::idealThreadCount() );
+
+  _fieldNames.clear();
+  _nRowsLoaded = 0;
+
+  clearError();
+}
+
+
+void QCsvBatchLoader::assign( const QCsvBatchLoader& other ) {
+  _files = other._files;
+  _settings = other._settings;
+  _maxThreads = other._maxThreads;
+
+  _fieldNames = other._fieldNames;
+  _nRowsLoaded = other._nRowsLoaded;
+
+  _error = other._error;
+  _errorMsg = other._errorMsg;
+  _errorFileName = other._errorFileName;
+}
+
+
+void QCsvBatchLoader::setFiles( const CFileList& files ) {
+  const CFileList list = files.files();
+
+  _files.clear();
+  for( int i = 0; i < list.count(); ++i )
+    _files.append( list.at(i) );
+
+  _fieldNames.clear();
+}
+
+
+void QCsvBatchLoader::clearError() {
+  _error = QCsv::ERROR_NONE;
+  _errorMsg.clear();
+  _errorFileName.clear();
+}
+
+
+void QCsvBatchLoader::setError( const QCsv::CSVErrorCode error, const QString& msg, const QString& fileName ) {
+  _error = error;
+  _errorMsg = msg;
+  _errorFileName = fileName;
+}
+
+
+// Only the first row of each file is read, so this is cheap even for a large number of large files.
+bool QCsvBatchLoader::checkHeaders() {
+  clearError();
+  _fieldNames.clear();
+
+  if( _files.isEmpty() ) {
+    setError( QCsv::ERROR_OPEN, QStringLiteral( "There are no files to load." ), QString() );
+    return false;
+  }
+
+  // Copies of the settings would quietly drop it.
+  if( nullptr != _settings.validator() ) {
+    setError( QCsv::ERROR_WRONG_MODE, QStringLiteral( "Files can't be validated while they are loaded in parallel." ), QString() );
+    return false;
+  }
+
+  // Without field lists, there is nothing to compare: mismatched rows are found as the files are loaded.
+  if( !_settings.containsFieldList() )
+    return true;
+
+  for( int i = 0; i < _files.count(); ++i ) {
+    QCsv csv( _settings );
+    csv.setFilename( _files.at(i) );
+    csv.setMode( QCsv::LineByLine );
+    csv.setFollow( false );
+
+    if( !csv.open() ) {
+      setError( csv.error(), QStringLiteral( "%1: %2" ).arg( _files.at(i), csv.errorMsg() ), _files.at(i) );
+      return false;
+    }
+
+    if( 0 == i ) {
+      _fieldNames = csv.fieldNames();
+    }
+    else if( csv.fieldNames() != _fieldNames ) {
+      setError(
+        QCsv::ERROR_INVALID_FIELD_NAME,
+        QStringLiteral( "Field names in %1 do not match those in %2." ).arg( _files.at(i), _files.at(0) ),
+        _files.at(i)
+      );
+      _fieldNames.clear();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+bool QCsvBatchLoader::load( QCsv& result ) {
+  _nRowsLoaded = 0;
+
+  if( !checkHeaders() )
+    return false;
+
+  if( _settings.containsFieldList() )
+    result = QCsv( _fieldNames );
+  else
+    result = QCsv( QList<QStringList>() );
+
+  result.setDictionaryLimit( _settings.dictionaryLimit() );
+  result.setColumnarStorage( _settings.columnarStorage() );
+
+  if( !loadFiles( &result, nullptr ) )
+    return false;
+
+  if( _settings.autoFieldTypes() )
+    result.inferFieldTypes();
+
+  result.toFront();
+
+  return true;
+}
+
+
+bool QCsvBatchLoader::load( QCsvBatchRowHandler& handler ) {
+  _nRowsLoaded = 0;
+
+  if( !checkHeaders() )
+    return false;
+
+  return loadFiles( nullptr, &handler );
+}
+
+
+QCsv* QCsvBatchLoader::readFile( const QString& fileName ) const {
+  QCsv* csv = new QCsv( _settings );
+
+  csv->setFilename( fileName );
+  csv->setMode( QCsv::EntireFile );
+  csv->setFollow( false );
+
+  // The files are already being read at the same time as each other.
+  csv->setParallelLoad( false );
+
+  // Field types are worked out once, for the combined data.
+  csv->setAutoFieldTypes( false );
+
+  csv->open();
+
+  return csv;
+}
+
+
+bool QCsvBatchLoader::loadFiles( QCsv* result, QCsvBatchRowHandler* handler ) {
+  Q_ASSERT( ( nullptr == result ) != ( nullptr == handler ) );
+
+  QThreadPool pool;
+  pool.setMaxThreadCount( _maxThreads );
+
+  // Files are passed on in order, so one slow file holds up the rest.  Starting a few more files than there
+  // are threads keeps the threads busy in the meantime, without holding every parsed file in memory at once.
+  const int window = 2 * _maxThreads;
+
+  QList< QFuture<QCsv*> > futures;
+  int nStarted = 0;
+  bool ok = true;
+
+  for( int i = 0; i < _files.count(); ++i ) {
+    while( ok && ( nStarted < _files.count() ) && ( nStarted < i + window ) ) {
+      futures.append( QtConcurrent::run( &pool, this, &QCsvBatchLoader::readFile, _files.at( nStarted ) ) );
+      ++nStarted;
+    }
+
+    // After a problem, the files that were already started are waited for and thrown away.
+    if( i >= futures.count() )
+      break;
+
+    QCsv* csv = futures.at(i).result();
+
+    if( ok ) {
+      if( QCsv::ERROR_NONE != csv->error() ) {
+        setError( csv->error(), QStringLiteral( "%1: %2" ).arg( _files.at(i), csv->errorMsg() ), _files.at(i) );
+        ok = false;
+      }
+      else if( nullptr != result ) {
+        ok = appendFile( *result, *csv );
+      }
+      else {
+        ok = streamFile( *handler, *csv, _files.at(i) );
+      }
+    }
+
+    delete csv;
+  }
+
+  return ok;
+}
+
+
+bool QCsvBatchLoader::appendFile( QCsv& result, QCsv& csv ) {
+  // A file may have changed since its field list was checked.
+  if( _settings.containsFieldList() && ( csv.fieldNames() != _fieldNames ) ) {
+    setError( QCsv::ERROR_INVALID_FIELD_NAME, QStringLiteral( "Field names in %1 do not match." ).arg( csv.filename() ), csv.filename() );
+    return false;
+  }
+
+  const int nRows = csv.nRows();
+
+  for( int i = 0; i < nRows; ++i ) {
+    if( !result.append( csv.rowData( i ) ) ) {
+      setError( result.error(), QStringLiteral( "%1: %2" ).arg( csv.filename(), result.errorMsg() ), csv.filename() );
+      return false;
+    }
+  }
+
+  _nRowsLoaded = _nRowsLoaded + nRows;
+
+  return true;
+}
+
+
+bool QCsvBatchLoader::streamFile( QCsvBatchRowHandler& handler, QCsv& csv, const QString& fileName ) {
+  if( !handler.beginFile( fileName, csv.fieldNames() ) )
+    return false;
+
+  QCsvRowBuffer row;
+
+  while( -1 != csv.moveNext( row ) ) {
+    ++_nRowsLoaded;
+
+    if( !handler.handleRow( fileName, row ) )
+      return false;
+  }
+
+  return handler.endFile( fileName );
+}
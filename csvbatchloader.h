@@ -0,0 +1,123 @@
+/*
+csvbatchloader.h/cpp
+--------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVBATCHLOADER_H
+#define CSVBATCHLOADER_H
+
+#include <QtCore>
+
+#include <ar_general_purpose/cfilelist.h>
+#include <ar_general_purpose/csv.h>
+#include <ar_general_purpose/csvrowbuffer.h>
+
+/* Receives the rows of a set of files read by QCsvBatchLoader, one file after another in the order in which
+ * the files were listed.  Subclass and override handleRow() and, if necessary, the other functions.
+ * Return false from any of them to stop loading: QCsvBatchLoader::load() then returns false, without setting an error.
+ *
+ * Calls are made on the thread that called QCsvBatchLoader::load(), so a handler needs no locking of its own.
+ */
+class QCsvBatchRowHandler {
+  public:
+    virtual ~QCsvBatchRowHandler() { /* Nothing to do here */ }
+
+    virtual bool beginFile( const QString& fileName, const QStringList& fieldNames ) { Q_UNUSED( fileName ); Q_UNUSED( fieldNames ); return true; }
+    virtual bool handleRow( const QString& fileName, const QCsvRowBuffer& row ) = 0; // The row is valid only until this returns
+    virtual bool endFile( const QString& fileName ) { Q_UNUSED( fileName ); return true; }
+};
+
+
+/* Loads many CSV files (e.g., the shards of a single data set, listed by CFileList) at once.
+ *
+ *   QCsvBatchLoader loader( CFileList( dir, "*.csv", false ) );
+ *   loader.settings().setContainsFieldList( true );
+ *   loader.settings().setColumnarStorage( true );
+ *
+ *   QCsv all;
+ *   if( !loader.load( all ) )
+ *     qDb() << loader.errorMsg();
+ *
+ * Every file is read with the settings of settings() (delimiter, selected fields, filters, codec, etc.).
+ * Before anything is parsed, the field list of every file is read and compared with that of the first file:
+ * if any differ, nothing is loaded.
+ *
+ * Files are then parsed in EntireFile mode on a pool of at most maxThreads() threads, several at a time.
+ * Their rows are either appended to a single QCsv object (as QCsv::append() would do), or passed to a
+ * QCsvBatchRowHandler.  Either way, rows arrive in file order, and only a few files more than the number
+ * of threads are held in memory at once.
+ */
+class QCsvBatchLoader {
+  public:
+    QCsvBatchLoader();
+    QCsvBatchLoader( const CFileList& files );
+    QCsvBatchLoader( const QCsvBatchLoader& other );
+    QCsvBatchLoader& operator=( const QCsvBatchLoader& other );
+    ~QCsvBatchLoader() { /* Nothing to do here */ }
+
+    // The files to load.  Directories in the list are ignored.
+    void setFiles( const CFileList& files );
+    QStringList files() const { return _files; }
+
+    // The settings used to read every file.  Change these as for any other QCsv object, but don't open it.
+    // The mode, follow(), and parallelLoad() are ignored.  A validator (see QCsv::setValidator()) can't be used,
+    // since files are parsed several at a time and a validator isn't shared between threads: if one is set,
+    // checkHeaders() and load() fail with ERROR_WRONG_MODE.  To validate a set of files, open each one in turn.
+    QCsv& settings() { return _settings; }
+    const QCsv& settings() const { return _settings; }
+
+    // The number of files parsed at once.  Default value is QThread::idealThreadCount().
+    void setMaxThreads( const int val ) { _maxThreads = qMax( 1, val ); }
+    int maxThreads() const { return _maxThreads; }
+
+    // Reads the field list of every file, and checks that they all match.  This is done by load() as well.
+    bool checkHeaders();
+
+    // Reads all of the files into result, which is replaced.  With columnar storage, the result is kept in columns.
+    bool load( QCsv& result );
+
+    // Reads all of the files, passing their rows to handler.
+    bool load( QCsvBatchRowHandler& handler );
+
+    QStringList fieldNames() const { return _fieldNames; } // Of the first file, once headers have been checked
+    qint64 nRowsLoaded() const { return _nRowsLoaded; }
+
+    QCsv::CSVErrorCode error() const { return _error; }
+    QString errorMsg() const { return _errorMsg; }
+    QString errorFileName() const { return _errorFileName; } // The file that caused the error, if any
+
+  protected:
+    void initialize();
+    void assign( const QCsvBatchLoader& other );
+
+    void clearError();
+    void setError( const QCsv::CSVErrorCode error, const QString& msg, const QString& fileName );
+
+    QCsv* readFile( const QString& fileName ) const; // Run on the thread pool.  The caller takes ownership.
+
+    // Parses the files on a pool of threads, and passes each parsed file to either result or handler, in order.
+    bool loadFiles( QCsv* result, QCsvBatchRowHandler* handler );
+    bool appendFile( QCsv& result, QCsv& csv );
+    bool streamFile( QCsvBatchRowHandler& handler, QCsv& csv, const QString& fileName );
+
+    QStringList _files;
+    QCsv _settings;
+    int _maxThreads;
+
+    QStringList _fieldNames;
+    qint64 _nRowsLoaded;
+
+    QCsv::CSVErrorCode _error;
+    QString _errorMsg;
+    QString _errorFileName;
+};
+
+#endif // CSVBATCHLOADER_H
@@ -0,0 +1,196 @@
+/*
+csvcache.h/cpp
+--------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvcache.h"
+
+#include <limits>
+
+#include <ar_general_purpose/csvsidecar.h>
+
+namespace {
+  const quint32 cacheMagic = 0x51434343; // "QCCC"
+  const quint32 cacheVersion = 1;
+  const qint64 fingerprintBytes = 64 * 1024; // Hashed from each end of the file
+}
+
+
+QCsvCache::QCsvCache() {
+  clear();
+}
+
+
+QCsvCache::QCsvCache( const QCsvCache& other ) {
+  assign( other );
+}
+
+
+QCsvCache& QCsvCache::operator=( const QCsvCache& other ) {
+  assign( other );
+  return *this;
+}
+
+
+void QCsvCache::assign( const QCsvCache& other ) {
+  _fieldNames = other._fieldNames;
+  _comments = other._comments;
+  _nRowsFiltered = other._nRowsFiltered;
+  _columns = other._columns;
+  _errorMsg = other._errorMsg;
+}
+
+
+void QCsvCache::clear() {
+  _fieldNames.clear();
+  _comments.clear();
+  _nRowsFiltered = 0;
+  _columns.clear();
+  _errorMsg.clear();
+}
+
+
+void QCsvCache::setContents( const QStringList& fieldNames, const QStringList& comments, const qint64 nRowsFiltered, const QCsvColumnStore& columns ) {
+  _fieldNames = fieldNames;
+  _comments = comments;
+  _nRowsFiltered = nRowsFiltered;
+  _columns = columns;
+}
+
+
+// A file that is rewritten with the same size and modification time (e.g., copied with its time preserved)
+// will almost always differ somewhere near its start or its end.  Hashing the whole file would cost
+// nearly as much as parsing it.
+QByteArray QCsvCache::fingerprint( QFile& file ) {
+  QCryptographicHash hash( QCryptographicHash::Sha1 );
+  const qint64 size = file.size();
+
+  if( !file.seek( 0 ) )
+    return QByteArray();
+
+  hash.addData( file.read( fingerprintBytes ) );
+
+  if( size > fingerprintBytes ) {
+    if( !file.seek( qMax( fingerprintBytes, size - fingerprintBytes ) ) )
+      return QByteArray();
+
+    hash.addData( file.read( fingerprintBytes ) );
+  }
+
+  return hash.result();
+}
+
+
+bool QCsvCache::load( const QString& csvFileName, const QString& settings ) {
+  clear();
+
+  QFile csvFile( csvFileName );
+  QFile file( cacheFileName( csvFileName ) );
+
+  if( !file.open( QIODevice::ReadOnly ) ) {
+    _errorMsg = QStringLiteral( "There is no cache for %1" ).arg( csvFileName );
+    return false;
+  }
+  else if( !csvFile.open( QIODevice::ReadOnly ) ) {
+    _errorMsg = QStringLiteral( "File could not be opened: %1" ).arg( csvFileName );
+    return false;
+  }
+
+  const qint64 mapSize = file.size();
+  uchar* map = ( 0 < mapSize ? file.map( 0, mapSize ) : nullptr );
+
+  if( nullptr == map ) {
+    _errorMsg = QStringLiteral( "The cache for %1 could not be read" ).arg( csvFileName );
+    return false;
+  }
+
+  // The mapped file is read in place: QByteArray::fromRawData() doesn't copy it.
+  QByteArray bytes = QByteArray::fromRawData( reinterpret_cast<const char*>( map ), int( qMin( mapSize, qint64( std::numeric_limits<int>::max() ) ) ) );
+  QBuffer buffer( &bytes );
+  buffer.open( QIODevice::ReadOnly );
+
+  QDataStream stream( &buffer );
+  stream.setVersion( QDataStream::Qt_5_0 );
+  stream.setByteOrder( QDataStream::LittleEndian );
+
+  const QCsvSidecarHeader::Status status = QCsvSidecarHeader::read( stream, cacheMagic, cacheVersion, csvFileName );
+
+  QByteArray savedFingerprint;
+  QString savedSettings;
+
+  stream >> savedFingerprint >> savedSettings;
+
+  bool result = false;
+
+  if( ( QCsvSidecarHeader::Invalid == status ) || ( QDataStream::Ok != stream.status() ) ) {
+    _errorMsg = QStringLiteral( "The cache for %1 is not valid" ).arg( csvFileName );
+  }
+  else if( ( QCsvSidecarHeader::OutOfDate == status ) || ( fingerprint( csvFile ) != savedFingerprint ) ) {
+    _errorMsg = QStringLiteral( "The cache for %1 is out of date" ).arg( csvFileName );
+  }
+  else if( settings != savedSettings ) {
+    _errorMsg = QStringLiteral( "The cache for %1 was written with different settings" ).arg( csvFileName );
+  }
+  else {
+    stream >> _fieldNames >> _comments >> _nRowsFiltered;
+
+    result = ( ( QDataStream::Ok == stream.status() ) && _columns.readFrom( stream ) );
+
+    if( !result ) {
+      clear();
+      _errorMsg = QStringLiteral( "The cache for %1 is not valid" ).arg( csvFileName );
+    }
+  }
+
+  buffer.close();
+  file.unmap( map );
+
+  return result;
+}
+
+
+bool QCsvCache::save( const QString& csvFileName, const QString& settings ) const {
+  _errorMsg.clear();
+
+  QFile csvFile( csvFileName );
+  if( !csvFile.open( QIODevice::ReadOnly ) ) {
+    _errorMsg = QStringLiteral( "File could not be opened: %1" ).arg( csvFileName );
+    return false;
+  }
+
+  const QFileInfo fi( csvFile );
+
+  QSaveFile file( cacheFileName( csvFileName ) );
+  if( !file.open( QIODevice::WriteOnly ) ) {
+    _errorMsg = QStringLiteral( "The cache could not be saved: %1" ).arg( file.fileName() );
+    return false;
+  }
+
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_0 );
+  stream.setByteOrder( QDataStream::LittleEndian );
+
+  QCsvSidecarHeader::write( stream, cacheMagic, cacheVersion, fi.size(), fi.lastModified().toMSecsSinceEpoch() );
+
+  stream
+    << fingerprint( csvFile ) << settings
+    << _fieldNames << _comments << _nRowsFiltered
+  ;
+
+  _columns.writeTo( stream );
+
+  if( ( QDataStream::Ok != stream.status() ) || !file.commit() ) {
+    _errorMsg = QStringLiteral( "The cache could not be saved: %1" ).arg( file.fileName() );
+    return false;
+  }
+
+  return true;
+}
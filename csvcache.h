@@ -0,0 +1,78 @@
+/*
+csvcache.h/cpp
+--------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVCACHE_H
+#define CSVCACHE_H
+
+#include <QtCore>
+
+#include <ar_general_purpose/csvcolumnstore.h>
+
+/* The parsed contents of a CSV file, saved in a compact binary file next to it (e.g. data.csv.colcache)
+ * so that the file doesn't have to be parsed again the next time it is loaded.
+ *
+ * The cache holds the field names, any comments, and the columns of a QCsvColumnStore, typed columns
+ * included (see QCsvColumnStore::writeTo()).  It also records:
+ *  - the size and modification time of the CSV file, and a hash of its first and last 64 KB, so that a
+ *    cache is ignored once the file has changed;
+ *  - a description of the settings used to read the file (delimiter, selected fields, filters, etc.),
+ *    so that a cache is ignored if the same file is read in a different way.
+ *
+ * A cache is read by mapping it into memory, so loading it costs little more than copying its columns.
+ *
+ * There should be little reason to use this class directly: see QCsv::setUseCache().
+ */
+class QCsvCache {
+  public:
+    QCsvCache();
+    QCsvCache( const QCsvCache& other );
+    QCsvCache& operator=( const QCsvCache& other );
+    ~QCsvCache() { /* Nothing to do here */ }
+
+    void clear();
+
+    // Reads the cache for csvFileName.  Returns false if there isn't one, or if it's out of date or was
+    // written with different settings.
+    bool load( const QString& csvFileName, const QString& settings );
+    bool save( const QString& csvFileName, const QString& settings ) const;
+
+    static QString cacheFileName( const QString& csvFileName ) { return csvFileName + QStringLiteral(".colcache"); }
+
+    // The contents of the cache
+    void setContents( const QStringList& fieldNames, const QStringList& comments, const qint64 nRowsFiltered, const QCsvColumnStore& columns );
+    QStringList fieldNames() const { return _fieldNames; }
+    QStringList comments() const { return _comments; }
+    qint64 nRowsFiltered() const { return _nRowsFiltered; }
+    const QCsvColumnStore& columns() const { return _columns; }
+
+    // String columns that were saved as dictionaries are loaded as DictionaryColumns only within this limit.
+    // See QCsvColumnStore::readFrom().  Set before load().
+    void setDictionaryLimit( const int val ) { _columns.setDictionaryLimit( val ); }
+
+    QString errorMsg() const { return _errorMsg; }
+
+  protected:
+    void assign( const QCsvCache& other );
+
+    // Identifies the contents of a file, without reading all of it.
+    static QByteArray fingerprint( QFile& file );
+
+    QStringList _fieldNames;
+    QStringList _comments;
+    qint64 _nRowsFiltered;
+    QCsvColumnStore _columns;
+
+    mutable QString _errorMsg;
+};
+
+#endif // CSVCACHE_H
@@ -0,0 +1,871 @@
+/*
+csvcolumnstore.h/cpp
+--------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvcolumnstore.h"
+
+#include <cstring>
+#include <limits>
+
+namespace {
+  // A number is only kept as a number if it prints as exactly the text that it came from (e.g., not "007" or "1.50"),
+  // so that storing it never changes what is seen.  See also QCsvColumnStore::value().
+  bool printsAs( const qint64 i, const QString& text ) {
+    return ( QString::number( i ) == text );
+  }
+
+  bool printsAs( const double d, const QString& text ) {
+    return ( QString::number( d, 'g', QLocale::FloatingPointShortest ) == text );
+  }
+
+  const int arrayChunk = 1024 * 1024; // Elements per raw read or write, which is limited to an int's worth of bytes
+
+  enum StringEncoding {
+    PlainStrings,
+    DictionaryStrings
+  };
+
+  template <typename T>
+  void writeArray( QDataStream& stream, const T* data, const qint64 n ) {
+    for( qint64 first = 0; first < n; first = first + arrayChunk ) {
+      const int count = int( qMin( qint64( arrayChunk ), n - first ) );
+
+      #if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        QVector<T> swapped( count );
+        for( int i = 0; i < count; ++i )
+          swapped[i] = qToLittleEndian( data[first + i] );
+        stream.writeRawData( reinterpret_cast<const char*>( swapped.constData() ), count * int( sizeof( T ) ) );
+      #else
+        stream.writeRawData( reinterpret_cast<const char*>( data + first ), count * int( sizeof( T ) ) );
+      #endif
+    }
+  }
+
+  template <typename T>
+  bool readArray( QDataStream& stream, T* data, const qint64 n ) {
+    for( qint64 first = 0; first < n; first = first + arrayChunk ) {
+      const int nBytes = int( qMin( qint64( arrayChunk ), n - first ) * qint64( sizeof( T ) ) );
+
+      if( nBytes != stream.readRawData( reinterpret_cast<char*>( data + first ), nBytes ) )
+        return false;
+    }
+
+    #if Q_BYTE_ORDER == Q_BIG_ENDIAN
+      for( qint64 i = 0; i < n; ++i )
+        data[i] = qFromLittleEndian( data[i] );
+    #endif
+
+    return true;
+  }
+
+  // Dictionary codes are written with as few bytes as will hold them.
+  template <typename T>
+  void writeCodes( QDataStream& stream, const QVector<int>& codes ) {
+    QVector<T> narrow( codes.count() );
+    for( int i = 0; i < codes.count(); ++i )
+      narrow[i] = T( codes.at(i) );
+    writeArray( stream, narrow.constData(), narrow.count() );
+  }
+
+  template <typename T>
+  bool readCodes( QDataStream& stream, QVector<int>& codes ) {
+    QVector<T> narrow( codes.count() );
+    if( !readArray( stream, narrow.data(), narrow.count() ) )
+      return false;
+    for( int i = 0; i < codes.count(); ++i )
+      codes[i] = narrow.at(i);
+    return true;
+  }
+
+  void writeDictionary( QDataStream& stream, const QVector<int>& offsets, const QByteArray& text, const QVector<int>& codes ) {
+    const int nDistinct = offsets.count() - 1;
+    const quint8 codeSize = ( 256 >= nDistinct ? 1 : ( 65536 >= nDistinct ? 2 : 4 ) );
+
+    stream << quint8( DictionaryStrings ) << qint32( nDistinct ) << codeSize;
+    writeArray( stream, offsets.constData(), offsets.count() );
+    stream << text;
+
+    if( 1 == codeSize )
+      writeCodes<quint8>( stream, codes );
+    else if( 2 == codeSize )
+      writeCodes<quint16>( stream, codes );
+    else
+      writeCodes<quint32>( stream, codes );
+  }
+
+  // Are offsets into a buffer of textSize bytes in order, starting from 0 and finishing at the end?
+  bool offsetsAreValid( const QVector<int>& offsets, const int textSize ) {
+    if( offsets.isEmpty() || ( 0 != offsets.first() ) || ( textSize != offsets.last() ) )
+      return false;
+
+    for( int i = 1; i < offsets.count(); ++i ) {
+      if( offsets.at(i) < offsets.at(i - 1) )
+        return false;
+    }
+
+    return true;
+  }
+}
+
+QCsvColumnStore::QCsvColumnStore() {
+  _nRows = 0;
+  _dictionaryLimit = 0;
+}
+
+
+QCsvColumnStore::QCsvColumnStore( const QCsvColumnStore& other ) {
+  assign( other );
+}
+
+
+QCsvColumnStore& QCsvColumnStore::operator=( const QCsvColumnStore& other ) {
+  assign( other );
+  return *this;
+}
+
+
+void QCsvColumnStore::assign( const QCsvColumnStore& other ) {
+  _columns = other._columns;
+  _nRows = other._nRows;
+  _dictionaryLimit = other._dictionaryLimit;
+}
+
+
+void QCsvColumnStore::clear() {
+  _columns.clear();
+  _nRows = 0;
+}
+
+
+void QCsvColumnStore::initColumn( Column& column, const ColumnType type ) {
+  column.type = type;
+  column.text.clear();
+  column.offsets.clear();
+  column.codes.clear();
+  column.strings.clear();
+  column.lookup.clear();
+  column.maxDistinct = std::numeric_limits<int>::max();
+  column.ints.clear();
+  column.doubles.clear();
+  column.nulls.clear();
+  column.dateFmt = UKDateFormat;
+  column.defaultCentury = 2000;
+  column.trueText.clear();
+  column.falseText.clear();
+
+  if( isText( type ) ) {
+    column.offsets.append( 0 );
+  }
+}
+
+
+// Adds val to the end of column.  Returns false if val can't be stored in a column of this type,
+// including a number that wouldn't print as val again.
+bool QCsvColumnStore::appendValue( Column& column, const QString& val ) const {
+  bool ok = true;
+
+  switch( column.type ) {
+    case StringColumn:
+      column.text.append( val.toUtf8() );
+      column.offsets.append( column.text.size() );
+      break;
+
+    case DictionaryColumn: {
+        const QByteArray utf8 = val.toUtf8();
+        QHash<QByteArray, int>::const_iterator it = column.lookup.constFind( utf8 );
+
+        if( column.lookup.constEnd() != it ) {
+          column.codes.append( it.value() );
+        }
+        else if( column.strings.count() < column.maxDistinct ) {
+          const int code = column.strings.count();
+          column.text.append( utf8 );
+          column.offsets.append( column.text.size() );
+          column.strings.append( val );
+          column.lookup.insert( utf8, code );
+          column.codes.append( code );
+        }
+        else {
+          ok = false;
+        }
+      }
+      break;
+
+    case IntegerColumn:
+      if( val.isEmpty() ) {
+        column.ints.append( 0 );
+      }
+      else {
+        const qint64 i = fastStrToInt64( val, &ok );
+        ok = ( ok && printsAs( i, val ) );
+        if( ok )
+          column.ints.append( i );
+      }
+      break;
+
+    case DoubleColumn:
+      if( val.isEmpty() ) {
+        column.doubles.append( 0.0 );
+      }
+      else {
+        const double d = fastStrToDouble( val, &ok );
+        ok = ( ok && printsAs( d, val ) );
+        if( ok )
+          column.doubles.append( d );
+      }
+      break;
+
+    case DateColumn:
+      if( val.isEmpty() ) {
+        column.ints.append( 0 );
+      }
+      else {
+        const QDate date = guessDateFromString( val, column.dateFmt, column.defaultCentury );
+        ok = date.isValid();
+        if( ok )
+          column.ints.append( date.toJulianDay() );
+      }
+      break;
+
+    case BoolColumn:
+      if( val.isEmpty() ) {
+        column.ints.append( 0 );
+      }
+      else {
+        const bool b = strToBool( val, &ok );
+        QString& text = ( b ? column.trueText : column.falseText );
+
+        if( ok && text.isEmpty() )
+          text = val;
+        else if( ok )
+          ok = ( text == val );
+
+        if( ok )
+          column.ints.append( b ? 1 : 0 );
+      }
+      break;
+  }
+
+  if( ok && !isText( column.type ) ) {
+    const int n = column.nulls.size();
+    column.nulls.resize( n + 1 );
+    column.nulls.setBit( n, val.isEmpty() );
+  }
+
+  return ok;
+}
+
+
+// As appendValue(), for a number that is still in UTF-8 (e.g., a value of a text column).  No string is made.
+bool QCsvColumnStore::appendNumber( Column& column, const char* data, const int length ) const {
+  Q_ASSERT( ( IntegerColumn == column.type ) || ( DoubleColumn == column.type ) );
+
+  bool ok = true;
+
+  if( IntegerColumn == column.type ) {
+    const qint64 i = ( 0 == length ? 0 : bytesToInt64( data, length, &ok ) );
+    if( ok )
+      column.ints.append( i );
+  }
+  else {
+    const double d = ( 0 == length ? 0.0 : bytesToDouble( data, length, &ok ) );
+    if( ok )
+      column.doubles.append( d );
+  }
+
+  if( ok ) {
+    const int n = column.nulls.size();
+    column.nulls.resize( n + 1 );
+    column.nulls.setBit( n, 0 == length );
+  }
+
+  return ok;
+}
+
+
+void QCsvColumnStore::appendRow( const QStringList& values ) {
+  if( 0 == _nRows ) {
+    _columns.resize( values.count() );
+    for( int c = 0; c < _columns.count(); ++c ) {
+      if( 0 < _dictionaryLimit ) {
+        initColumn( _columns[c], DictionaryColumn );
+        _columns[c].maxDistinct = _dictionaryLimit;
+      }
+      else {
+        initColumn( _columns[c], StringColumn );
+      }
+    }
+  }
+
+  for( int c = 0; c < _columns.count(); ++c ) {
+    const QString val = ( c < values.count() ) ? values.at(c) : QString();
+
+    // A value that doesn't match a typed column turns it back into a string column.
+    if( !appendValue( _columns[c], val ) ) {
+      setColumnType( c, StringColumn );
+      appendValue( _columns[c], val );
+    }
+  }
+
+  ++_nRows;
+}
+
+
+void QCsvColumnStore::setRows( const QList<QStringList>& rows ) {
+  clear();
+
+  for( int r = 0; r < rows.count(); ++r ) {
+    appendRow( rows.at(r) );
+  }
+}
+
+
+QList<QStringList> QCsvColumnStore::toRows() const {
+  QList<QStringList> result;
+  result.reserve( _nRows );
+
+  for( int r = 0; r < _nRows; ++r ) {
+    result.append( row( r ) );
+  }
+
+  return result;
+}
+
+
+void QCsvColumnStore::setColumn( const int col, const QStringList& values ) {
+  Q_ASSERT( values.count() == _nRows );
+
+  Column& column = _columns[col];
+  initColumn( column, StringColumn );
+
+  for( int r = 0; r < values.count(); ++r ) {
+    appendValue( column, values.at(r) );
+  }
+}
+
+
+QString QCsvColumnStore::value( const int col, const int row ) const {
+  Q_ASSERT( ( 0 <= col ) && ( col < _columns.count() ) );
+  Q_ASSERT( ( 0 <= row ) && ( row < _nRows ) );
+
+  const Column& column = _columns.at( col );
+
+  if( StringColumn == column.type ) {
+    const int start = column.offsets.at( row );
+    return QString::fromUtf8( column.text.constData() + start, column.offsets.at( row + 1 ) - start );
+  }
+  else if( DictionaryColumn == column.type ) {
+    return column.strings.at( column.codes.at( row ) );
+  }
+  else if( column.nulls.testBit( row ) ) {
+    return QString();
+  }
+
+  switch( column.type ) {
+    case IntegerColumn:
+      return QString::number( column.ints.at( row ) );
+    case DoubleColumn:
+      return QString::number( column.doubles.at( row ), 'g', QLocale::FloatingPointShortest );
+    case DateColumn:
+      return QDate::fromJulianDay( column.ints.at( row ) ).toString( QStringLiteral("yyyy-MM-dd") );
+    case BoolColumn:
+      return ( column.ints.at( row ) ? column.trueText : column.falseText );
+    default:
+      Q_UNREACHABLE();
+      return QString();
+  }
+}
+
+
+bool QCsvColumnStore::rawValue( const int col, const int row, const char*& data, int& length ) const {
+  Q_ASSERT( ( 0 <= col ) && ( col < _columns.count() ) );
+  Q_ASSERT( ( 0 <= row ) && ( row < _nRows ) );
+
+  const Column& column = _columns.at( col );
+
+  if( !isText( column.type ) )
+    return false;
+
+  const int i = ( DictionaryColumn == column.type ? column.codes.at( row ) : row );
+  const int start = column.offsets.at( i );
+  data = column.text.constData() + start;
+  length = column.offsets.at( i + 1 ) - start;
+
+  return true;
+}
+
+
+QStringList QCsvColumnStore::row( const int row ) const {
+  QStringList result;
+  result.reserve( _columns.count() );
+
+  for( int c = 0; c < _columns.count(); ++c ) {
+    result.append( value( c, row ) );
+  }
+
+  return result;
+}
+
+
+QStringList QCsvColumnStore::column( const int col ) const {
+  QStringList result;
+  result.reserve( _nRows );
+
+  for( int r = 0; r < _nRows; ++r ) {
+    result.append( value( col, r ) );
+  }
+
+  return result;
+}
+
+
+bool QCsvColumnStore::setColumnType( const int col, const ColumnType type, const StrUtilsDateFormat dateFmt /* = UKDateFormat */, const int defaultCentury /* = 2000 */ ) {
+  Q_ASSERT( ( 0 <= col ) && ( col < _columns.count() ) );
+
+  if( ( type == _columns.at( col ).type ) && ( DateColumn != type ) ) {
+    return true;
+  }
+
+  Column newColumn;
+  initColumn( newColumn, type );
+  newColumn.dateFmt = dateFmt;
+  newColumn.defaultCentury = defaultCentury;
+
+  const bool isNumber = ( ( IntegerColumn == type ) || ( DoubleColumn == type ) );
+  const char* data;
+  int length;
+
+  for( int r = 0; r < _nRows; ++r ) {
+    // Numbers are converted straight from the stored text.
+    const bool ok = ( ( isNumber && rawValue( col, r, data, length ) ) ? appendNumber( newColumn, data, length ) : appendValue( newColumn, value( col, r ) ) );
+
+    if( !ok ) {
+      return false;
+    }
+  }
+
+  _columns[col] = newColumn;
+
+  return true;
+}
+
+
+QCsvColumnStore::ColumnType QCsvColumnStore::inferColumnType( const int col ) {
+  Q_ASSERT( ( 0 <= col ) && ( col < _columns.count() ) );
+
+  const Column& column = _columns.at( col );
+
+  if( !isText( column.type ) ) {
+    return column.type;
+  }
+
+  // Every value in a dictionary column is one of its distinct values, so only those need to be checked.
+  const bool isDictionary = ( DictionaryColumn == column.type );
+  const int nValues = ( isDictionary ? column.strings.count() : _nRows );
+
+  bool couldBeInt = true;
+  bool couldBeDouble = true;
+  bool couldBeBool = true;
+  bool couldBeDate = true;
+  bool hasValues = false;
+  QString trueText, falseText;
+
+  for( int r = 0; ( r < nValues ) && ( couldBeInt || couldBeDouble || couldBeBool || couldBeDate ); ++r ) {
+    const QString val = ( isDictionary ? column.strings.at( r ) : value( col, r ) );
+    bool ok;
+
+    if( val.isEmpty() )
+      continue;
+
+    hasValues = true;
+
+    // Each candidate type must give back exactly the original string, so that nothing visibly changes.
+    if( couldBeInt ) {
+      couldBeInt = strIsInt( val );
+      if( couldBeInt ) {
+        const qint64 i = fastStrToInt64( val, &ok );
+        couldBeInt = printsAs( i, val );
+      }
+    }
+
+    if( couldBeDouble ) {
+      couldBeDouble = strIsDouble( val );
+      if( couldBeDouble ) {
+        const double d = fastStrToDouble( val, &ok );
+        couldBeDouble = printsAs( d, val );
+      }
+    }
+
+    if( couldBeBool ) {
+      const bool b = strToBool( val, &ok );
+      QString& text = ( b ? trueText : falseText );
+
+      if( !ok )
+        couldBeBool = false;
+      else if( text.isEmpty() )
+        text = val;
+      else
+        couldBeBool = ( text == val );
+    }
+
+    // Only unambiguous dates can be recognized this way.  Others can be converted with setColumnType().
+    if( couldBeDate && !couldBeInt && !couldBeDouble ) {
+      const QDate date = guessDateFromString( val, UKDateFormat );
+      couldBeDate = ( date.isValid() && ( date.toString( QStringLiteral("yyyy-MM-dd") ) == val ) );
+    }
+  }
+
+  ColumnType type = StringColumn;
+
+  if( !hasValues )
+    type = StringColumn;
+  else if( couldBeInt )
+    type = IntegerColumn;
+  else if( couldBeDouble )
+    type = DoubleColumn;
+  else if( couldBeBool )
+    type = BoolColumn;
+  else if( couldBeDate )
+    type = DateColumn;
+
+  if( ( StringColumn != type ) && !setColumnType( col, type ) ) {
+    type = StringColumn;
+  }
+
+  return ( StringColumn == type ? _columns.at( col ).type : type );
+}
+
+
+bool QCsvColumnStore::isNull( const int col, const int row ) const {
+  const Column& column = _columns.at( col );
+
+  if( StringColumn == column.type )
+    return( column.offsets.at( row ) == column.offsets.at( row + 1 ) );
+  else if( DictionaryColumn == column.type )
+    return column.strings.at( column.codes.at( row ) ).isEmpty();
+  else
+    return column.nulls.testBit( row );
+}
+
+
+qint64 QCsvColumnStore::intValue( const int col, const int row ) const {
+  Q_ASSERT( IntegerColumn == _columns.at( col ).type );
+  return _columns.at( col ).ints.at( row );
+}
+
+
+double QCsvColumnStore::doubleValue( const int col, const int row ) const {
+  Q_ASSERT( DoubleColumn == _columns.at( col ).type );
+  return _columns.at( col ).doubles.at( row );
+}
+
+
+QDate QCsvColumnStore::dateValue( const int col, const int row ) const {
+  Q_ASSERT( DateColumn == _columns.at( col ).type );
+
+  if( _columns.at( col ).nulls.testBit( row ) )
+    return QDate();
+  else
+    return QDate::fromJulianDay( _columns.at( col ).ints.at( row ) );
+}
+
+
+bool QCsvColumnStore::boolValue( const int col, const int row ) const {
+  Q_ASSERT( BoolColumn == _columns.at( col ).type );
+  return ( 0 != _columns.at( col ).ints.at( row ) );
+}
+
+
+void QCsvColumnStore::appendRowKey( const int row, QByteArray& key ) const {
+  for( int c = 0; c < _columns.count(); ++c ) {
+    const Column& column = _columns.at(c);
+
+    switch( column.type ) {
+      case StringColumn: {
+          // The length comes first, so that values can't run into each other.
+          const int start = column.offsets.at( row );
+          const int length = column.offsets.at( row + 1 ) - start;
+          key.append( reinterpret_cast<const char*>( &length ), int( sizeof( int ) ) );
+          key.append( column.text.constData() + start, length );
+        }
+        break;
+      case DictionaryColumn:
+        key.append( reinterpret_cast<const char*>( &column.codes.at( row ) ), int( sizeof( int ) ) );
+        break;
+      case DoubleColumn: {
+          // 0.0 and -0.0 are written the same way.
+          const double d = ( column.nulls.testBit( row ) || ( 0.0 == column.doubles.at( row ) ) ? 0.0 : column.doubles.at( row ) );
+          key.append( reinterpret_cast<const char*>( &d ), int( sizeof( double ) ) );
+          key.append( column.nulls.testBit( row ) ? '\1' : '\0' );
+        }
+        break;
+      default: {
+          const qint64 i = ( column.nulls.testBit( row ) ? 0 : column.ints.at( row ) );
+          key.append( reinterpret_cast<const char*>( &i ), int( sizeof( qint64 ) ) );
+          key.append( column.nulls.testBit( row ) ? '\1' : '\0' );
+        }
+        break;
+    }
+  }
+}
+
+
+qint64 QCsvColumnStore::bytesUsed() const {
+  qint64 result = 0;
+
+  for( int c = 0; c < _columns.count(); ++c ) {
+    const Column& column = _columns.at(c);
+    result = result
+      + column.text.capacity()
+      + column.offsets.capacity() * qint64( sizeof( int ) )
+      + column.codes.capacity() * qint64( sizeof( int ) )
+      + column.ints.capacity() * qint64( sizeof( qint64 ) )
+      + column.doubles.capacity() * qint64( sizeof( double ) )
+      + column.nulls.size()/8
+      + ( DictionaryColumn == column.type ? 3 * qint64( column.text.size() ) : 0 ) // Decoded strings and lookup keys
+    ;
+  }
+
+  return result;
+}
+
+
+void QCsvColumnStore::writeTo( QDataStream& stream ) const {
+  stream << qint32( _columns.count() ) << qint32( _nRows );
+
+  for( int c = 0; c < _columns.count(); ++c ) {
+    const Column& column = _columns.at(c);
+
+    // A dictionary column is written as a string column that happens to use a dictionary.
+    stream << qint32( isText( column.type ) ? StringColumn : column.type );
+
+    switch( column.type ) {
+      case StringColumn:
+        writeStringColumn( stream, column );
+        break;
+      case DictionaryColumn:
+        writeDictionary( stream, column.offsets, column.text, column.codes );
+        break;
+      case DoubleColumn:
+        writeArray( stream, reinterpret_cast<const quint64*>( column.doubles.constData() ), column.doubles.count() );
+        stream << column.nulls;
+        break;
+      default:
+        writeArray( stream, column.ints.constData(), column.ints.count() );
+        stream << column.nulls;
+        break;
+    }
+
+    if( DateColumn == column.type )
+      stream << qint32( column.dateFmt ) << qint32( column.defaultCentury );
+    else if( BoolColumn == column.type )
+      stream << column.trueText << column.falseText;
+  }
+}
+
+
+// Rows are given codes in the order in which their values first appear.  If more than half of the rows
+// have different values, a dictionary saves nothing, so the column is written as it is.
+void QCsvColumnStore::writeStringColumn( QDataStream& stream, const Column& column ) const {
+  const char* text = column.text.constData();
+  const int maxDistinct = _nRows / 2;
+
+  QHash<QByteArray, int> lookup;
+  QVector<int> dictOffsets;
+  QByteArray dictText;
+  QVector<int> codes( _nRows );
+  bool useDictionary = ( 0 < maxDistinct );
+
+  dictOffsets.append( 0 );
+
+  for( int r = 0; useDictionary && ( r < _nRows ); ++r ) {
+    const int start = column.offsets.at( r );
+    const QByteArray value = QByteArray::fromRawData( text + start, column.offsets.at( r + 1 ) - start );
+    QHash<QByteArray, int>::const_iterator it = lookup.constFind( value );
+
+    if( lookup.constEnd() != it ) {
+      codes[r] = it.value();
+    }
+    else if( lookup.count() < maxDistinct ) {
+      codes[r] = lookup.count();
+      lookup.insert( value, codes.at(r) );
+      dictText.append( value );
+      dictOffsets.append( dictText.size() );
+    }
+    else {
+      useDictionary = false;
+    }
+  }
+
+  if( !useDictionary ) {
+    stream << quint8( PlainStrings );
+    writeArray( stream, column.offsets.constData(), column.offsets.count() );
+    stream << column.text;
+  }
+  else {
+    writeDictionary( stream, dictOffsets, dictText, codes );
+  }
+}
+
+
+bool QCsvColumnStore::readFrom( QDataStream& stream ) {
+  clear();
+
+  qint32 nCols, nRows;
+  stream >> nCols >> nRows;
+
+  if( ( QDataStream::Ok != stream.status() ) || ( 0 > nCols ) || ( 0 > nRows ) )
+    return false;
+
+  QVector<Column> columns( nCols );
+  _nRows = nRows;
+
+  bool ok = true;
+
+  for( int c = 0; ok && ( c < nCols ); ++c ) {
+    Column& column = columns[c];
+    qint32 type;
+
+    stream >> type;
+
+    if( ( StringColumn > type ) || ( BoolColumn < type ) ) {
+      ok = false;
+      break;
+    }
+
+    initColumn( column, ColumnType( type ) );
+
+    switch( column.type ) {
+      case StringColumn:
+        ok = readStringColumn( stream, column );
+        break;
+      case DoubleColumn:
+        column.doubles.resize( nRows );
+        ok = readArray( stream, reinterpret_cast<quint64*>( column.doubles.data() ), nRows );
+        stream >> column.nulls;
+        break;
+      default:
+        column.ints.resize( nRows );
+        ok = readArray( stream, column.ints.data(), nRows );
+        stream >> column.nulls;
+        break;
+    }
+
+    if( DateColumn == column.type ) {
+      qint32 dateFmt, defaultCentury;
+      stream >> dateFmt >> defaultCentury;
+      column.dateFmt = StrUtilsDateFormat( dateFmt );
+      column.defaultCentury = defaultCentury;
+    }
+    else if( BoolColumn == column.type ) {
+      stream >> column.trueText >> column.falseText;
+    }
+
+    ok = ( ok && ( QDataStream::Ok == stream.status() ) && ( isText( column.type ) || ( nRows == column.nulls.size() ) ) );
+  }
+
+  if( ok ) {
+    _columns = columns;
+  }
+  else {
+    clear();
+  }
+
+  return ok;
+}
+
+
+bool QCsvColumnStore::readStringColumn( QDataStream& stream, Column& column ) const {
+  quint8 encoding;
+  stream >> encoding;
+
+  if( PlainStrings == encoding ) {
+    column.offsets.resize( _nRows + 1 );
+    if( !readArray( stream, column.offsets.data(), _nRows + 1 ) )
+      return false;
+
+    stream >> column.text;
+
+    return ( ( QDataStream::Ok == stream.status() ) && offsetsAreValid( column.offsets, column.text.size() ) );
+  }
+  else if( DictionaryStrings != encoding ) {
+    return false;
+  }
+
+  qint32 nDistinct;
+  quint8 codeSize;
+  stream >> nDistinct >> codeSize;
+
+  if( ( QDataStream::Ok != stream.status() ) || ( 0 > nDistinct ) )
+    return false;
+
+  // Strings written with a dictionary are kept that way.
+  initColumn( column, DictionaryColumn );
+  column.offsets.resize( nDistinct + 1 );
+  column.codes.resize( _nRows );
+
+  if( !readArray( stream, column.offsets.data(), column.offsets.count() ) )
+    return false;
+
+  stream >> column.text;
+
+  if( ( QDataStream::Ok != stream.status() ) || !offsetsAreValid( column.offsets, column.text.size() ) )
+    return false;
+
+  bool ok;
+  if( 1 == codeSize )
+    ok = readCodes<quint8>( stream, column.codes );
+  else if( 2 == codeSize )
+    ok = readCodes<quint16>( stream, column.codes );
+  else if( 4 == codeSize )
+    ok = readCodes<quint32>( stream, column.codes );
+  else
+    ok = false;
+
+  for( int r = 0; ok && ( r < _nRows ); ++r )
+    ok = ( ( 0 <= column.codes.at(r) ) && ( column.codes.at(r) < nDistinct ) );
+
+  if( !ok )
+    return false;
+
+  const char* text = column.text.constData();
+
+  // The writer uses a dictionary whenever it saves space on disk, but in memory each distinct value also costs
+  // a QString and a hash entry.  Only columns within this store's limit are kept that way, as when they're built.
+  if( ( 0 < _dictionaryLimit ) && ( nDistinct <= _dictionaryLimit ) ) {
+    column.maxDistinct = _dictionaryLimit;
+    column.strings.reserve( nDistinct );
+
+    for( int i = 0; i < nDistinct; ++i ) {
+      const QByteArray utf8( text + column.offsets.at(i), column.offsets.at( i + 1 ) - column.offsets.at(i) );
+      column.strings.append( QString::fromUtf8( utf8 ) );
+      column.lookup.insert( utf8, i );
+    }
+
+    return true;
+  }
+
+  Column plain;
+  initColumn( plain, StringColumn );
+  plain.offsets.reserve( _nRows + 1 );
+
+  for( int r = 0; r < _nRows; ++r ) {
+    const int code = column.codes.at(r);
+    const int start = column.offsets.at( code );
+    plain.text.append( text + start, column.offsets.at( code + 1 ) - start );
+    plain.offsets.append( plain.text.size() );
+  }
+
+  column = plain;
+
+  return true;
+}
@@ -0,0 +1,169 @@
+/*
+csvcolumnstore.h/cpp
+--------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVCOLUMNSTORE_H
+#define CSVCOLUMNSTORE_H
+
+#include <QtCore>
+
+#include <ar_general_purpose/strutils.h>
+
+/* Column-oriented storage for the contents of a QCsv object.
+ *
+ * QCsv normally keeps every cell as a separate QString in a QList<QStringList>.  This class
+ * instead keeps the values of each column one after another in a single UTF-8 buffer, with
+ * an array of offsets marking where each value starts.  Columns may also be converted to
+ * native integer, floating-point, date, or boolean values.
+ *
+ * This uses a fraction of the memory of QList<QStringList>, and operations that work on one
+ * column at a time (filtering, sorting, finding unique values) read memory in order instead of
+ * chasing pointers from row to row.
+ *
+ * Columns with only a few distinct values (codes, categories, etc.) may instead be kept as a dictionary:
+ * each distinct value is stored once, and each row holds the position of its value in the dictionary.
+ * With a dictionary limit (see setDictionaryLimit()), every new column starts out this way, and becomes an
+ * ordinary string column if it turns out to have more distinct values than the limit.
+ *
+ * There should be little reason to use this class directly: see QCsv::setColumnarStorage().
+ */
+class QCsvColumnStore {
+  public:
+    enum ColumnType {
+      StringColumn,
+      IntegerColumn,
+      DoubleColumn,
+      DateColumn,
+      BoolColumn,
+      DictionaryColumn
+    };
+
+    QCsvColumnStore();
+    QCsvColumnStore( const QCsvColumnStore& other );
+    QCsvColumnStore& operator=( const QCsvColumnStore& other );
+    ~QCsvColumnStore() { /* Nothing to do here */ }
+
+    void clear(); // Removes all columns and rows.  The dictionary limit is kept.
+
+    int nCols() const { return _columns.count(); }
+    int nRows() const { return _nRows; }
+    bool isEmpty() const { return ( 0 == _nRows ); }
+
+    // Adds a row to the end of the store.  Values are stored as they are, so they should already be trimmed.
+    // The first row added determines the number of columns.  Missing values are treated as empty strings.
+    // A value that a typed column can't hold exactly as it is written (e.g. "007" in an IntegerColumn)
+    // turns that column back into a StringColumn.
+    void appendRow( const QStringList& values );
+
+    // Replaces the entire contents of the store, or converts the store back to rows.
+    void setRows( const QList<QStringList>& rows );
+    QList<QStringList> toRows() const;
+
+    // Replaces all values in a column, which becomes a StringColumn.  'values' must contain nRows() items.
+    void setColumn( const int col, const QStringList& values );
+
+    QString value( const int col, const int row ) const;
+
+    // The UTF-8 bytes of a value in a StringColumn or DictionaryColumn, without copying them.  Returns false for typed columns.
+    bool rawValue( const int col, const int row, const char*& data, int& length ) const;
+
+    QStringList row( const int row ) const;
+    QStringList column( const int col ) const;
+
+    // Typed columns
+    //--------------
+    ColumnType columnType( const int col ) const { return _columns.at( col ).type; }
+    bool isTextColumn( const int col ) const { return isText( _columns.at( col ).type ); } // A StringColumn or DictionaryColumn
+
+    // Converts a column to native values of the indicated type.  Empty values are kept as nulls.
+    // If any other value can't be converted, returns false and leaves the column unchanged.
+    // Dates are interpreted with guessDateFromString(), and are subsequently rendered as yyyy-MM-dd.
+    // Booleans are interpreted with strToBool().  A boolean column keeps the first spelling it sees for
+    // true and for false (e.g. "Y" and "N"), and can't hold any other spelling.
+    bool setColumnType( const int col, const ColumnType type, const StrUtilsDateFormat dateFmt = UKDateFormat, const int defaultCentury = 2000 );
+
+    // Converts a string column to the first of IntegerColumn, DoubleColumn, BoolColumn, or DateColumn
+    // that can hold every value in the column exactly as it is written, so that value() returns the
+    // same strings as before.  Returns the resulting type.  Columns with no values are left alone.
+    // Only the distinct values of a DictionaryColumn need to be checked.
+    ColumnType inferColumnType( const int col );
+
+    // Native values from typed columns.  These should only be used with columns of the matching type.
+    bool isNull( const int col, const int row ) const;
+    qint64 intValue( const int col, const int row ) const;
+    double doubleValue( const int col, const int row ) const;
+    QDate dateValue( const int col, const int row ) const;
+    bool boolValue( const int col, const int row ) const;
+
+    // Dictionary columns
+    //-------------------
+    // New columns with no more than this many distinct values are kept as a DictionaryColumn.  0 (the default) turns this off.
+    // Columns converted to DictionaryColumn with setColumnType() have no limit.
+    void setDictionaryLimit( const int val ) { _dictionaryLimit = val; }
+    int dictionaryLimit() const { return _dictionaryLimit; }
+
+    // These should only be used with a DictionaryColumn.  Codes run from 0 to dictionarySize() - 1, in the order in
+    // which values first appeared.
+    int dictionarySize( const int col ) const { return _columns.at( col ).strings.count(); }
+    QString dictionaryValue( const int col, const int code ) const { return _columns.at( col ).strings.at( code ); }
+    int code( const int col, const int row ) const { return _columns.at( col ).codes.at( row ); }
+
+    // Appends a binary key for all of the values in a row to 'key'.  Two rows have the same key only if value()
+    // gives the same strings for both.  Dictionary codes and typed values are used as they are.
+    void appendRowKey( const int row, QByteArray& key ) const;
+
+    // Approximately how much memory is used by the contents of the store?
+    qint64 bytesUsed() const;
+
+    // Binary form of the store, as used by QCsvCache.  Numbers are written as raw little-endian arrays.  A string
+    // column with many repeated values is written as a dictionary of distinct values and a code for each row.
+    // readFrom() replaces the contents of the store, and returns false (leaving the store empty) if the data are damaged.
+    // A column written as a dictionary is read as a DictionaryColumn only if it fits within dictionaryLimit():
+    // otherwise it is expanded to a StringColumn, which takes less memory when most values are different.
+    void writeTo( QDataStream& stream ) const;
+    bool readFrom( QDataStream& stream );
+
+  protected:
+    void assign( const QCsvColumnStore& other );
+
+    struct Column {
+      ColumnType type;
+      QByteArray text;         // StringColumn: UTF-8 values, one after the other.  DictionaryColumn: the distinct values.
+      QVector<int> offsets;    // StringColumn, DictionaryColumn: the start of each value in text, plus a final entry marking the end
+      QVector<int> codes;      // DictionaryColumn: for each row, the position of its value in the dictionary
+      QVector<QString> strings;          // DictionaryColumn: the distinct values, decoded, so that value() needn't create new strings
+      QHash<QByteArray, int> lookup;     // DictionaryColumn: the code for each distinct value
+      int maxDistinct;                   // DictionaryColumn: more distinct values than this turn the column into a StringColumn
+      QVector<qint64> ints;    // IntegerColumn, DateColumn (as Julian day numbers), or BoolColumn (as 0 or 1)
+      QVector<double> doubles; // DoubleColumn
+      QBitArray nulls;         // Typed columns: set where the original value was empty
+      StrUtilsDateFormat dateFmt; // DateColumn: used to interpret values that are added later
+      int defaultCentury;         // DateColumn: as above
+      QString trueText;           // BoolColumn: the spellings of true and false values
+      QString falseText;
+    };
+
+    static bool isText( const ColumnType type ) { return ( ( StringColumn == type ) || ( DictionaryColumn == type ) ); }
+
+    void initColumn( Column& column, const ColumnType type );
+    bool appendValue( Column& column, const QString& val ) const;
+    bool appendNumber( Column& column, const char* data, const int length ) const; // For IntegerColumn or DoubleColumn, from UTF-8
+
+    void writeStringColumn( QDataStream& stream, const Column& column ) const;
+    bool readStringColumn( QDataStream& stream, Column& column ) const;
+
+    QVector<Column> _columns;
+    int _nRows;
+    int _dictionaryLimit;
+};
+
+#endif // CSVCOLUMNSTORE_H
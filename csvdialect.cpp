@@ -0,0 +1,516 @@
+/*
+csvdialect.h/cpp
+----------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvdialect.h"
+
+#include <cctype>
+#include <cstring>
+
+#include <QTextCodec>
+
+#include <ar_general_purpose/csv.h>
+#include <ar_general_purpose/compressedio.h>
+#include <ar_general_purpose/strutils.h>
+#include <ar_general_purpose/qcout.h>
+
+namespace {
+  const char candidateDelimiters[] = { ',', ';', '\t', '|' };
+  const int nCandidateDelimiters = 4;
+  const int maxHeaderRows = 100; // Rows compared with the first one, to decide whether it's a field list
+  const qint64 transcodingBlockSize = 256 * 1024;
+
+  // Is data[0, length) valid UTF-8?  If the data may have been cut short, a sequence that is
+  // incomplete only because it runs off the end is accepted.
+  bool isValidUtf8( const uchar* data, const int length, const bool isComplete ) {
+    int i = 0;
+
+    while( i < length ) {
+      const uint c = data[i];
+      int extra;
+
+      if( 0x80 > c )
+        extra = 0;
+      else if( ( 0xC2 <= c ) && ( c <= 0xDF ) )
+        extra = 1;
+      else if( 0xE0 == ( c & 0xF0 ) )
+        extra = 2;
+      else if( ( 0xF0 <= c ) && ( c <= 0xF4 ) )
+        extra = 3;
+      else
+        return false;
+
+      if( i + extra >= length )
+        return ( !isComplete && ( 0 < extra ) );
+
+      for( int k = 1; k <= extra; ++k ) {
+        if( 0x80 != ( data[i + k] & 0xC0 ) )
+          return false;
+      }
+
+      i = i + extra + 1;
+    }
+
+    return true;
+  }
+}
+
+
+QCsvDialect::QCsvDialect() {
+  clear();
+}
+
+
+QCsvDialect::QCsvDialect( const QCsvDialect& other ) {
+  assign( other );
+}
+
+
+QCsvDialect& QCsvDialect::operator=( const QCsvDialect& other ) {
+  assign( other );
+  return *this;
+}
+
+
+void QCsvDialect::assign( const QCsvDialect& other ) {
+  _isValid = other._isValid;
+  _delimiter = other._delimiter;
+  _hasHeader = other._hasHeader;
+  _hasQuotes = other._hasQuotes;
+  _encoding = other._encoding;
+  _hasBom = other._hasBom;
+  _nFields = other._nFields;
+  _nRowsSampled = other._nRowsSampled;
+  _consistency = other._consistency;
+  _errorMsg = other._errorMsg;
+}
+
+
+void QCsvDialect::clear() {
+  _isValid = false;
+  _delimiter = ',';
+  _hasHeader = true;
+  _hasQuotes = false;
+  _encoding = UnknownEncoding;
+  _hasBom = false;
+  _nFields = 0;
+  _nRowsSampled = 0;
+  _consistency = 0.0;
+  _errorMsg.clear();
+}
+
+
+QString QCsvDialect::codecName() const {
+  switch( _encoding ) {
+    case Utf8Encoding: return QStringLiteral( "UTF-8" );
+    case Windows1252Encoding: return QStringLiteral( "windows-1252" );
+    case Utf16LEEncoding: return QStringLiteral( "UTF-16LE" );
+    case Utf16BEEncoding: return QStringLiteral( "UTF-16BE" );
+    default: return QString();
+  }
+}
+
+
+void QCsvDialect::debug() const {
+  qDb() << "QCsvDialect:";
+  qDb() << "  valid:" << _isValid;
+  qDb() << "  delimiter:" << _delimiter;
+  qDb() << "  header:" << _hasHeader;
+  qDb() << "  quotes:" << _hasQuotes;
+  qDb() << "  encoding:" << codecName() << ( _hasBom ? "(with BOM)" : "" );
+  qDb() << "  fields:" << _nFields << "in" << _consistency * 100.0 << "% of" << _nRowsSampled << "rows";
+  if( !_errorMsg.isEmpty() )
+    qDb() << "  error:" << _errorMsg;
+}
+
+
+bool QCsvDialect::sniffFile( const QString& fileName, const int sampleSize /* = defaultSampleSize */, const bool checkForComments /* = false */, const int linesToSkip /* = 0 */ ) {
+  clear();
+
+  QFile file( fileName );
+  if( !file.open( QIODevice::ReadOnly ) ) {
+    _errorMsg = QStringLiteral( "File could not be opened: %1" ).arg( fileName );
+    return false;
+  }
+
+  const CompressionFormat compression = compressionFormat( file.peek( 4 ) );
+  QByteArray sample;
+  bool isComplete;
+
+  if( NoCompression == compression ) {
+    sample = file.read( sampleSize );
+    isComplete = file.atEnd();
+  }
+  else {
+    // Only as much as is needed is decompressed: closing the reader stops the rest.
+    QDecompressingReader reader( &file, compression );
+
+    if( !reader.open( QIODevice::ReadOnly ) ) {
+      _errorMsg = reader.errorString();
+      return false;
+    }
+
+    while( sample.size() < sampleSize ) {
+      const QByteArray block = reader.read( sampleSize - sample.size() );
+
+      if( block.isEmpty() )
+        break;
+
+      sample.append( block );
+    }
+
+    isComplete = reader.atEnd();
+    reader.close();
+  }
+
+  return sniff( sample, isComplete, checkForComments, linesToSkip );
+}
+
+
+bool QCsvDialect::sniff( const QByteArray& sample, const bool isComplete, const bool checkForComments /* = false */, const int linesToSkip /* = 0 */ ) {
+  clear();
+
+  _encoding = detectEncoding( sample, isComplete );
+
+  // Everything else is worked out from UTF-8.
+  const int bomLength = ( !_hasBom ? 0 : ( Utf8Encoding == _encoding ? 3 : 2 ) );
+  QByteArray text;
+
+  if( Utf8Encoding == _encoding ) {
+    text = sample.mid( bomLength );
+  }
+  else {
+    int length = sample.size() - bomLength;
+    if( ( Utf16LEEncoding == _encoding ) || ( Utf16BEEncoding == _encoding ) )
+      length = length - ( length % 2 );
+
+    const QTextCodec* codec = QTextCodec::codecForName( codecName().toLatin1() );
+    text = codec->toUnicode( sample.constData() + bomLength, length ).toUtf8();
+  }
+
+  text.replace( '\0', "" );
+
+  // Find the complete rows, without their line breaks.  As with QCsv, a blank line ends the data.
+  const char* data = text.constData();
+  const qint64 size = text.size();
+  QVector<int> starts;
+  QVector<int> lengths;
+  int nSkipped = 0;
+  qint64 pos = 0;
+
+  while( pos < size ) {
+    const qint64 end = CSV::findRecordEnd( data, size, pos );
+    const bool hasLineBreak = ( '\n' == data[end - 1] );
+
+    if( !hasLineBreak && !isComplete )
+      break;
+
+    int length = int( end - pos ) - ( hasLineBreak ? 1 : 0 );
+    while( ( 0 < length ) && ( '\r' == data[pos + length - 1] ) )
+      --length;
+
+    int firstChar = 0;
+    while( ( firstChar < length ) && isspace( static_cast<unsigned char>( data[pos + firstChar] ) ) )
+      ++firstChar;
+
+    if( nSkipped < linesToSkip ) {
+      ++nSkipped;
+    }
+    else if( firstChar == length ) {
+      break;
+    }
+    else if( checkForComments && starts.isEmpty() && ( '#' == data[pos + firstChar] ) ) {
+      // Comments at the top of the file are ignored.
+    }
+    else {
+      starts.append( int( pos ) );
+      lengths.append( length );
+    }
+
+    pos = end;
+  }
+
+  _nRowsSampled = starts.count();
+
+  if( 0 == _nRowsSampled )
+    return false;
+
+  for( int i = 0; ( i < _nRowsSampled ) && !_hasQuotes; ++i )
+    _hasQuotes = ( nullptr != memchr( data + starts.at(i), '"', size_t( lengths.at(i) ) ) );
+
+  chooseDelimiter( text, starts, lengths );
+  detectHeader( text, starts, lengths );
+
+  _isValid = true;
+
+  return true;
+}
+
+
+QCsvDialect::Encoding QCsvDialect::detectEncoding( const QByteArray& sample, const bool isComplete ) {
+  if( sample.startsWith( "\xEF\xBB\xBF" ) ) {
+    _hasBom = true;
+    return Utf8Encoding;
+  }
+  else if( sample.startsWith( "\xFF\xFE" ) ) {
+    _hasBom = true;
+    return Utf16LEEncoding;
+  }
+  else if( sample.startsWith( "\xFE\xFF" ) ) {
+    _hasBom = true;
+    return Utf16BEEncoding;
+  }
+
+  // Mostly ASCII text in UTF-16 has a NUL in every other byte.
+  const int nPairs = qMin( sample.size(), 4096 ) / 2;
+  int evenNuls = 0;
+  int oddNuls = 0;
+
+  for( int i = 0; i < nPairs; ++i ) {
+    if( '\0' == sample.at( 2*i ) )
+      ++evenNuls;
+    if( '\0' == sample.at( 2*i + 1 ) )
+      ++oddNuls;
+  }
+
+  if( ( 0 < nPairs ) && ( oddNuls > nPairs / 2 ) && ( evenNuls < nPairs / 10 ) )
+    return Utf16LEEncoding;
+  else if( ( 0 < nPairs ) && ( evenNuls > nPairs / 2 ) && ( oddNuls < nPairs / 10 ) )
+    return Utf16BEEncoding;
+  else if( isValidUtf8( reinterpret_cast<const uchar*>( sample.constData() ), sample.size(), isComplete ) )
+    return Utf8Encoding;
+  else
+    return Windows1252Encoding;
+}
+
+
+void QCsvDialect::chooseDelimiter( const QByteArray& text, const QVector<int>& starts, const QVector<int>& lengths ) {
+  const char* data = text.constData();
+  const int nRows = starts.count();
+  QVector<CSV::FieldSpan> spans;
+
+  int bestCandidate = -1;
+  int bestFields = 1;
+  int bestCount = 0;
+
+  for( int c = 0; c < nCandidateDelimiters; ++c ) {
+    QHash<int, int> counts; // Key is a number of fields, value is the number of rows with that many
+
+    for( int i = 0; i < nRows; ++i )
+      counts[ CSV::splitRecord( data + starts.at(i), lengths.at(i), candidateDelimiters[c], spans ) ] += 1;
+
+    // The most common number of fields, preferring more fields if two are equally common
+    int nFields = 0;
+    int count = 0;
+    QHashIterator<int, int> it( counts );
+    while( it.hasNext() ) {
+      it.next();
+      if( ( it.value() > count ) || ( ( it.value() == count ) && ( it.key() > nFields ) ) ) {
+        nFields = it.key();
+        count = it.value();
+      }
+    }
+
+    if( ( 1 < nFields ) && ( ( count > bestCount ) || ( ( count == bestCount ) && ( nFields > bestFields ) ) ) ) {
+      bestCandidate = c;
+      bestFields = nFields;
+      bestCount = count;
+    }
+  }
+
+  if( -1 == bestCandidate ) {
+    // A file with a single column: any delimiter will do.
+    _delimiter = ',';
+    _nFields = 1;
+
+    for( int i = 0; i < nRows; ++i ) {
+      if( 1 == CSV::splitRecord( data + starts.at(i), lengths.at(i), ',', spans ) )
+        ++bestCount;
+    }
+  }
+  else {
+    _delimiter = QLatin1Char( candidateDelimiters[bestCandidate] );
+    _nFields = bestFields;
+  }
+
+  _consistency = double( bestCount ) / double( nRows );
+}
+
+
+void QCsvDialect::detectHeader( const QByteArray& text, const QVector<int>& starts, const QVector<int>& lengths ) {
+  const char* data = text.constData();
+  const char delimiter = char( _delimiter.toLatin1() );
+  QVector<CSV::FieldSpan> spans;
+
+  QStringList first;
+  CSV::splitRecord( data + starts.at(0), lengths.at(0), delimiter, spans );
+  for( int j = 0; j < spans.count(); ++j )
+    first.append( CSV::spanToString( data + starts.at(0), spans.at(j) ) );
+
+  // Rows with the usual number of fields are compared with the first one.
+  QList<QStringList> rows;
+  for( int i = 1; ( i < starts.count() ) && ( rows.count() < maxHeaderRows ); ++i ) {
+    if( _nFields == CSV::splitRecord( data + starts.at(i), lengths.at(i), delimiter, spans ) ) {
+      QStringList row;
+      for( int j = 0; j < spans.count(); ++j )
+        row.append( CSV::spanToString( data + starts.at(i), spans.at(j) ) );
+      rows.append( row );
+    }
+  }
+
+  int votes = 0;
+
+  for( int j = 0; ( j < first.count() ) && ( j < _nFields ); ++j ) {
+    const QString& top = first.at(j);
+
+    if( top.isEmpty() )
+      continue;
+    else if( strIsDouble( top ) ) {
+      --votes;
+      continue;
+    }
+
+    int nValues = 0;
+    bool allNumeric = true;
+    bool sameLength = true;
+    int length = -1;
+
+    for( int i = 0; i < rows.count(); ++i ) {
+      const QString& val = rows.at(i).at(j);
+
+      if( val.isEmpty() )
+        continue;
+
+      ++nValues;
+
+      if( allNumeric && !strIsDouble( val ) )
+        allNumeric = false;
+
+      if( -1 == length )
+        length = val.length();
+      else if( length != val.length() )
+        sameLength = false;
+    }
+
+    if( 0 == nValues )
+      continue;
+    else if( allNumeric )
+      ++votes;
+    else if( sameLength )
+      votes = votes + ( length != top.length() ? 1 : -1 );
+  }
+
+  if( 0 != votes ) {
+    _hasHeader = ( 0 < votes );
+  }
+  else {
+    // No evidence either way (e.g., every value is text of varying length).  Field names are all different.
+    _hasHeader = ( first.toSet().count() == first.count() );
+    for( int j = 0; ( j < first.count() ) && _hasHeader; ++j )
+      _hasHeader = !first.at(j).isEmpty();
+  }
+}
+
+
+QTranscodingReader::QTranscodingReader( QIODevice* source, QTextCodec* codec, QObject* parent /* = nullptr */ ) : QIODevice( parent ) {
+  _source = source;
+  _codec = codec;
+  _decoder = nullptr;
+  _currentPos = 0;
+}
+
+
+QTranscodingReader::~QTranscodingReader() {
+  close();
+}
+
+
+bool QTranscodingReader::open( OpenMode mode ) {
+  if( isOpen() || ( mode & QIODevice::WriteOnly ) ) {
+    return false;
+  }
+  else if( ( nullptr == _source ) || !_source->isReadable() ) {
+    setErrorString( QStringLiteral("The source is not open for reading.") );
+    return false;
+  }
+  else if( nullptr == _codec ) {
+    setErrorString( QStringLiteral("The encoding of the source is not supported.") );
+    return false;
+  }
+
+  _decoder = _codec->makeDecoder();
+  _current.clear();
+  _currentPos = 0;
+
+  QIODevice::open( mode );
+
+  return true;
+}
+
+
+void QTranscodingReader::close() {
+  if( !isOpen() )
+    return;
+
+  delete _decoder;
+  _decoder = nullptr;
+  _current.clear();
+  _currentPos = 0;
+
+  QIODevice::close();
+}
+
+
+bool QTranscodingReader::atEnd() const {
+  if( !isOpen() )
+    return true;
+  else if( 0 < QIODevice::bytesAvailable() )
+    return false;
+  else
+    return !( const_cast<QTranscodingReader*>( this )->loadBlock() );
+}
+
+
+qint64 QTranscodingReader::bytesAvailable() const {
+  return QIODevice::bytesAvailable() + ( _current.size() - _currentPos );
+}
+
+
+qint64 QTranscodingReader::readData( char* data, qint64 maxSize ) {
+  if( !loadBlock() )
+    return -1;
+
+  const qint64 n = qMin( maxSize, qint64( _current.size() - _currentPos ) );
+  memcpy( data, _current.constData() + _currentPos, size_t( n ) );
+  _currentPos = _currentPos + int( n );
+
+  return n;
+}
+
+
+bool QTranscodingReader::loadBlock() {
+  // A block may decode to nothing (e.g. if it ends part way through a character), so keep going until it doesn't.
+  while( _currentPos >= _current.size() ) {
+    const QByteArray raw = _source->read( transcodingBlockSize );
+
+    if( raw.isEmpty() ) {
+      _current.clear();
+      _currentPos = 0;
+      return false;
+    }
+
+    _current = _decoder->toUnicode( raw ).toUtf8();
+    _currentPos = 0;
+  }
+
+  return true;
+}
@@ -0,0 +1,135 @@
+/*
+csvdialect.h/cpp
+----------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVDIALECT_H
+#define CSVDIALECT_H
+
+#include <QtCore>
+
+/* The "dialect" of a CSV file: its delimiter, whether it starts with a field list, and its encoding,
+ * worked out from a sample taken from the start of the file.
+ *
+ * - The encoding comes from a byte order mark, if there is one.  Otherwise, a sample with many NULs in
+ *   alternate positions is taken to be UTF-16, one that is valid UTF-8 is UTF-8, and anything else is
+ *   taken to be Windows-1252 (a superset of Latin-1).
+ * - Each candidate delimiter (comma, semicolon, tab, and pipe) is used to split every complete row of the
+ *   sample, quotation marks included.  The delimiter that gives the most consistent number of fields (more
+ *   than one) wins.  Ties go to the delimiter that gives more fields, then to the earlier candidate.
+ * - The first row is compared with the rows below it, column by column.  A non-numeric value at the top of
+ *   a numeric column, or a value of a different length at the top of a column whose values all have the
+ *   same length, suggests a field list.  A number at the top of a column suggests data.  If the evidence
+ *   is balanced, the first row is taken to be a field list if its values are all different and not empty.
+ *
+ * Only the sample is read (64 KB by default, decompressed if necessary), so this is cheap enough to do for
+ * every file in a directory.  See QCsv::setAutoDetectDialect() and QCsv::detectDialect().
+ */
+class QCsvDialect {
+  public:
+    enum Encoding {
+      UnknownEncoding,
+      Utf8Encoding,
+      Windows1252Encoding,
+      Utf16LEEncoding,
+      Utf16BEEncoding
+    };
+
+    static const int defaultSampleSize = 64 * 1024;
+
+    QCsvDialect();
+    QCsvDialect( const QCsvDialect& other );
+    QCsvDialect& operator=( const QCsvDialect& other );
+    ~QCsvDialect() { /* Nothing to do here */ }
+
+    void clear();
+
+    // Samples the start of a file.  Returns false if the file can't be read.
+    // If checkForComments is true, lines that start with '#' are ignored, as they are by QCsv.
+    bool sniffFile( const QString& fileName, const int sampleSize = defaultSampleSize, const bool checkForComments = false, const int linesToSkip = 0 );
+
+    // As above, from a sample that has already been read.  If the sample is the whole file, set isComplete:
+    // otherwise, the last row of the sample is assumed to be cut short, and is ignored.
+    bool sniff( const QByteArray& sample, const bool isComplete, const bool checkForComments = false, const int linesToSkip = 0 );
+
+    bool isValid() const { return _isValid; }
+
+    QChar delimiter() const { return _delimiter; }
+    bool hasHeader() const { return _hasHeader; }
+    bool hasQuotes() const { return _hasQuotes; } // Did any row of the sample contain quotation marks?
+
+    Encoding encoding() const { return _encoding; }
+    bool hasBom() const { return _hasBom; }
+    QString codecName() const; // The encoding, as a name that QTextCodec (and QCsv::setCodec()) recognizes
+
+    int nFields() const { return _nFields; }
+    int nRowsSampled() const { return _nRowsSampled; }
+    double consistency() const { return _consistency; } // The proportion of sampled rows that have nFields() fields
+
+    QString errorMsg() const { return _errorMsg; }
+
+    void debug() const;
+
+  protected:
+    void assign( const QCsvDialect& other );
+
+    Encoding detectEncoding( const QByteArray& sample, const bool isComplete );
+    void chooseDelimiter( const QByteArray& text, const QVector<int>& starts, const QVector<int>& lengths );
+    void detectHeader( const QByteArray& text, const QVector<int>& starts, const QVector<int>& lengths );
+
+    bool _isValid;
+    QChar _delimiter;
+    bool _hasHeader;
+    bool _hasQuotes;
+    Encoding _encoding;
+    bool _hasBom;
+    int _nFields;
+    int _nRowsSampled;
+    double _consistency;
+    QString _errorMsg;
+};
+
+
+/* A sequential, read-only device that converts the text of another device from some other encoding to UTF-8.
+ *
+ * Used by QCsv to read files that aren't UTF-8.  Open it with QIODevice::Text to have line endings
+ * converted as well: the source device should then be in binary mode, so that multi-byte encodings
+ * like UTF-16 aren't damaged.  The source device must already be open, and must outlast this object.
+ */
+class QTranscodingReader : public QIODevice {
+  public:
+    QTranscodingReader( QIODevice* source, QTextCodec* codec, QObject* parent = nullptr );
+    virtual ~QTranscodingReader();
+
+    virtual bool open( OpenMode mode ) override; // ReadOnly, optionally with Text
+    virtual void close() override;
+
+    virtual bool isSequential() const override { return true; }
+    virtual bool atEnd() const override;
+    virtual qint64 bytesAvailable() const override;
+
+  protected:
+    virtual qint64 readData( char* data, qint64 maxSize ) override;
+    virtual qint64 writeData( const char* data, qint64 maxSize ) override { Q_UNUSED( data ); Q_UNUSED( maxSize ); return -1; }
+
+    bool loadBlock(); // Makes sure that _current has unread data.  Returns false at the end.
+
+    QIODevice* _source;
+    QTextCodec* _codec;
+    QTextDecoder* _decoder;
+    QByteArray _current;
+    int _currentPos;
+
+  private:
+    Q_DISABLE_COPY( QTranscodingReader )
+};
+
+#endif // CSVDIALECT_H
@@ -0,0 +1,166 @@
+/*
+csvrowbuffer.h/cpp
+------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvrowbuffer.h"
+
+// Space is reserved (rather than simply allocated) so that Qt keeps it when the containers are emptied.
+QCsvRowBuffer::QCsvRowBuffer( const int expectedChars /* = 4096 */, const int expectedFields /* = 64 */ ) {
+  _text.reserve( qMax( 16, expectedChars ) );
+  _fields.reserve( qMax( 1, expectedFields ) );
+  _scratch.reserve( qMax( 16, expectedChars ) );
+}
+
+
+void QCsvRowBuffer::clear() {
+  _text.resize( 0 );
+  _fields.resize( 0 );
+}
+
+
+void QCsvRowBuffer::appendRef( const QString* str ) {
+  _fields.append( QStringRef( str ) );
+}
+
+
+void QCsvRowBuffer::appendString( const QString& str ) {
+  const int start = _text.size();
+
+  _text.resize( start + str.size() );
+  memcpy( _text.data() + start, str.constData(), size_t( str.size() ) * sizeof( QChar ) );
+
+  appendTrimmed( start );
+}
+
+
+// Follows the same rules as CSV::spanToString(), but without creating a new string for each field.
+void QCsvRowBuffer::appendSpan( const char* record, const CSV::FieldSpan& span, const QString& eolDelimiter, const bool isAscii ) {
+  const int start = _text.size();
+
+  if( span.escaped ) {
+    if( eolDelimiter != _eolDelimiter ) {
+      _eolDelimiter = eolDelimiter;
+      _eolBytes = eolDelimiter.toUtf8();
+    }
+
+    CSV::unescapeSpan( record, span, _eolBytes, _scratch );
+    appendUtf8( _scratch.constData(), _scratch.size() );
+  }
+  else if( isAscii ) {
+    const char* src = record + span.start;
+
+    _text.resize( start + span.length );
+    QChar* dst = _text.data() + start;
+
+    for( int i = 0; i < span.length; ++i )
+      dst[i] = QChar( ushort( uchar( src[i] ) ) );
+  }
+  else {
+    appendUtf8( record + span.start, span.length );
+  }
+
+  appendTrimmed( start );
+}
+
+
+// Decodes UTF-8 straight into the buffer.  As with QString::fromUtf8(), invalid sequences become U+FFFD.
+void QCsvRowBuffer::appendUtf8( const char* data, const int length ) {
+  const int start = _text.size();
+
+  // UTF-8 never needs more UTF-16 code units than it has bytes.
+  _text.resize( start + length );
+
+  const uchar* src = reinterpret_cast<const uchar*>( data );
+  QChar* dst = _text.data() + start;
+  int n = 0;
+  int i = 0;
+
+  while( i < length ) {
+    const uint c = src[i];
+
+    if( 0x80 > c ) {
+      dst[n++] = QChar( ushort( c ) );
+      ++i;
+      continue;
+    }
+
+    int extra;
+    uint cp;
+    uint minimum;
+
+    if( 0xC0 == ( c & 0xE0 ) ) {
+      extra = 1;
+      cp = c & 0x1F;
+      minimum = 0x80;
+    }
+    else if( 0xE0 == ( c & 0xF0 ) ) {
+      extra = 2;
+      cp = c & 0x0F;
+      minimum = 0x800;
+    }
+    else if( 0xF0 == ( c & 0xF8 ) ) {
+      extra = 3;
+      cp = c & 0x07;
+      minimum = 0x10000;
+    }
+    else {
+      dst[n++] = QChar( QChar::ReplacementCharacter );
+      ++i;
+      continue;
+    }
+
+    bool ok = ( i + extra < length );
+
+    for( int k = 1; ok && ( k <= extra ); ++k ) {
+      const uint cc = src[i + k];
+
+      if( 0x80 == ( cc & 0xC0 ) )
+        cp = ( cp << 6 ) | ( cc & 0x3F );
+      else
+        ok = false;
+    }
+
+    // Overlong forms, surrogates, and values beyond the last code point aren't valid.
+    if( !ok || ( minimum > cp ) || ( 0x10FFFF < cp ) || ( ( 0xD800 <= cp ) && ( cp <= 0xDFFF ) ) ) {
+      dst[n++] = QChar( QChar::ReplacementCharacter );
+      ++i;
+      continue;
+    }
+
+    i = i + extra + 1;
+
+    if( QChar::requiresSurrogates( cp ) ) {
+      dst[n++] = QChar( QChar::highSurrogate( cp ) );
+      dst[n++] = QChar( QChar::lowSurrogate( cp ) );
+    }
+    else {
+      dst[n++] = QChar( ushort( cp ) );
+    }
+  }
+
+  _text.resize( start + n );
+}
+
+
+void QCsvRowBuffer::appendTrimmed( const int start ) {
+  const QChar* chars = _text.constData();
+  int first = start;
+  int end = _text.size();
+
+  while( ( first < end ) && chars[first].isSpace() )
+    ++first;
+
+  while( ( end > first ) && chars[end - 1].isSpace() )
+    --end;
+
+  _fields.append( QStringRef( &_text, first, end - first ) );
+}
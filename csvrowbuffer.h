@@ -0,0 +1,74 @@
+/*
+csvrowbuffer.h/cpp
+------------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVROWBUFFER_H
+#define CSVROWBUFFER_H
+
+#include <QtCore>
+
+#include <ar_general_purpose/csv.h>
+
+/* The fields of one row of a QCsv object, as views (QStringRefs) into storage that is reused from row to row.
+ *
+ * Use with QCsv::moveNext( QCsvRowBuffer& ):
+ *
+ *   QCsvRowBuffer row;
+ *   while( -1 != csv.moveNext( row ) ) {
+ *     if( row.at(3) == QLatin1String("yes") )
+ *       ...
+ *   }
+ *
+ * Fields read from raw bytes (the usual case in LineByLine and MemoryMapped modes) are decoded straight into
+ * a single character buffer.  Fields of rows that are already held as strings (EntireFile mode) aren't copied
+ * at all: the views point at the stored strings.  Once the buffer has grown to fit the longest row, reading
+ * further rows allocates no memory.  The exceptions are rows read as strings in the first place (with space
+ * or non-ASCII delimiters, or when stringsContainDelimiters is false), and typed columns with columnar storage.
+ *
+ * Views are valid only until the next row is read into the buffer.  Use QStringRef::toString() to keep a value.
+ */
+class QCsvRowBuffer {
+  friend class QCsv;
+
+  public:
+    // Space is reserved up front for rows of about this size.  The buffer grows as necessary.
+    QCsvRowBuffer( const int expectedChars = 4096, const int expectedFields = 64 );
+    ~QCsvRowBuffer() { /* Nothing to do here */ }
+
+    int count() const { return _fields.count(); }
+    bool isEmpty() const { return _fields.isEmpty(); }
+
+    const QStringRef& at( const int i ) const { return _fields.at(i); }
+    const QStringRef& operator[]( const int i ) const { return _fields.at(i); }
+
+  protected:
+    void clear();
+
+    // Used by QCsv to fill the buffer
+    void appendRef( const QString* str );
+    void appendSpan( const char* record, const CSV::FieldSpan& span, const QString& eolDelimiter, const bool isAscii );
+    void appendUtf8( const char* data, const int length );
+    void appendString( const QString& str ); // Copies str into the buffer
+
+    void appendTrimmed( const int start ); // Adds a view of the buffer from start to its end, without surrounding white space
+
+    QString _text;                // Decoded characters of every field that isn't already a string
+    QVector<QStringRef> _fields;
+    QByteArray _scratch;          // Used to remove quote marks from escaped fields
+    QString _eolDelimiter;
+    QByteArray _eolBytes;
+
+  private:
+    Q_DISABLE_COPY( QCsvRowBuffer )
+};
+
+#endif // CSVROWBUFFER_H
@@ -0,0 +1,249 @@
+/*
+csvrowindex.h/cpp
+-----------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvrowindex.h"
+
+#include <cctype>
+#include <cstring>
+
+#include <ar_general_purpose/csvsidecar.h>
+
+namespace {
+  const quint32 indexMagic = 0x51435249; // "QCRI"
+  const quint32 indexVersion = 1;
+  const qint64 blockSize = 4 * 1024 * 1024;
+  const int chunkRows = 1024 * 1024;
+}
+
+
+QCsvRowIndex::QCsvRowIndex() {
+  clear();
+}
+
+
+QCsvRowIndex::QCsvRowIndex( const QCsvRowIndex& other ) {
+  assign( other );
+}
+
+
+QCsvRowIndex& QCsvRowIndex::operator=( const QCsvRowIndex& other ) {
+  assign( other );
+  return *this;
+}
+
+
+void QCsvRowIndex::assign( const QCsvRowIndex& other ) {
+  _csvFileName = other._csvFileName;
+  _fileSize = other._fileSize;
+  _lastModified = other._lastModified;
+  _dataStart = other._dataStart;
+  _offsets = other._offsets;
+  _errorMsg = other._errorMsg;
+}
+
+
+void QCsvRowIndex::clear() {
+  _csvFileName.clear();
+  _fileSize = 0;
+  _lastModified = 0;
+  _dataStart = 0;
+  _offsets.clear();
+  _errorMsg.clear();
+}
+
+
+// The file is read in large blocks.  Line breaks are found with memchr(), and the quote marks before each
+// line break are counted to tell whether it ends a row or falls inside a quoted value.  Blocks are
+// independent of rows: the state of the current row (inside quotes or not, blank so far or not) is
+// simply carried over from one block to the next.
+bool QCsvRowIndex::build( const QString& csvFileName, const qint64 dataStart ) {
+  clear();
+
+  QFile file( csvFileName );
+  if( !file.open( QIODevice::ReadOnly ) ) {
+    _errorMsg = QStringLiteral( "File could not be opened: %1" ).arg( csvFileName );
+    return false;
+  }
+
+  const QFileInfo fi( file );
+  const qint64 fileSize = fi.size();
+  const qint64 lastModified = fi.lastModified().toMSecsSinceEpoch();
+
+  if( !file.seek( dataStart ) ) {
+    _errorMsg = QStringLiteral( "File could not be read: %1" ).arg( csvFileName );
+    return false;
+  }
+
+  QVector<qint64> offsets;
+  QByteArray block( int( blockSize ), '\0' );
+  qint64 blockStart = dataStart;
+  qint64 rowStart = dataStart;
+  bool inQuotes = false;
+  bool blankSoFar = true; // Only white space has been seen in the current row (which isn't yet in the index)
+  bool finished = false;
+
+  while( !finished ) {
+    const qint64 n = file.read( block.data(), blockSize );
+
+    if( 0 > n ) {
+      _errorMsg = QStringLiteral( "File could not be read: %1" ).arg( csvFileName );
+      return false;
+    }
+    else if( 0 == n ) {
+      break;
+    }
+
+    const char* data = block.constData();
+    qint64 i = 0;
+
+    while( i < n ) {
+      if( blankSoFar ) {
+        const char ch = data[i];
+
+        // As with QCsv::readNext(), a blank line ends the data.
+        if( '\n' == ch ) {
+          finished = true;
+          break;
+        }
+        else if( ( '\0' == ch ) || isspace( static_cast<unsigned char>( ch ) ) ) {
+          ++i;
+          continue;
+        }
+
+        blankSoFar = false;
+        offsets.append( rowStart );
+      }
+
+      const char* lineBreak = static_cast<const char*>( memchr( data + i, '\n', size_t( n - i ) ) );
+      const char* segmentEnd = ( nullptr == lineBreak ? data + n : lineBreak );
+
+      const char* quote = data + i;
+      while( nullptr != ( quote = static_cast<const char*>( memchr( quote, '"', size_t( segmentEnd - quote ) ) ) ) ) {
+        inQuotes = !inQuotes;
+        ++quote;
+      }
+
+      if( nullptr == lineBreak )
+        break;
+
+      i = ( lineBreak - data ) + 1;
+
+      if( !inQuotes ) {
+        rowStart = blockStart + i;
+        blankSoFar = true;
+      }
+    }
+
+    blockStart = blockStart + n;
+  }
+
+  _csvFileName = csvFileName;
+  _fileSize = fileSize;
+  _lastModified = lastModified;
+  _dataStart = dataStart;
+  _offsets = offsets;
+
+  return true;
+}
+
+
+bool QCsvRowIndex::load( const QString& csvFileName, const qint64 dataStart ) {
+  clear();
+
+  QFile file( indexFileName( csvFileName ) );
+  if( !file.open( QIODevice::ReadOnly ) ) {
+    _errorMsg = QStringLiteral( "There is no row index for %1" ).arg( csvFileName );
+    return false;
+  }
+
+  QDataStream stream( &file );
+  stream.setByteOrder( QDataStream::LittleEndian );
+
+  qint64 fileSize, lastModified;
+  const QCsvSidecarHeader::Status status = QCsvSidecarHeader::read( stream, indexMagic, indexVersion, csvFileName, &fileSize, &lastModified );
+
+  qint64 savedDataStart;
+  qint32 nRows;
+
+  stream >> savedDataStart >> nRows;
+
+  if( ( QCsvSidecarHeader::Invalid == status ) || ( QDataStream::Ok != stream.status() ) || ( 0 > nRows ) ) {
+    _errorMsg = QStringLiteral( "The row index for %1 is not valid" ).arg( csvFileName );
+    return false;
+  }
+  else if( ( QCsvSidecarHeader::OutOfDate == status ) || ( dataStart != savedDataStart ) ) {
+    _errorMsg = QStringLiteral( "The row index for %1 is out of date" ).arg( csvFileName );
+    return false;
+  }
+
+  // Offsets are read (and written) in chunks, since the size of a single raw read is limited to an int.
+  QVector<qint64> offsets( nRows );
+
+  for( int first = 0; first < nRows; first = first + chunkRows ) {
+    const int nBytes = qMin( chunkRows, nRows - first ) * int( sizeof( qint64 ) );
+
+    if( nBytes != stream.readRawData( reinterpret_cast<char*>( offsets.data() + first ), nBytes ) ) {
+      _errorMsg = QStringLiteral( "The row index for %1 is not valid" ).arg( csvFileName );
+      return false;
+    }
+  }
+
+  for( int i = 0; i < nRows; ++i )
+    offsets[i] = qFromLittleEndian( offsets.at(i) );
+
+  _csvFileName = csvFileName;
+  _fileSize = fileSize;
+  _lastModified = lastModified;
+  _dataStart = dataStart;
+  _offsets = offsets;
+
+  return true;
+}
+
+
+bool QCsvRowIndex::save() const {
+  _errorMsg.clear();
+
+  if( !isValid() ) {
+    _errorMsg = QStringLiteral( "There is no row index to save" );
+    return false;
+  }
+
+  QSaveFile file( indexFileName( _csvFileName ) );
+  if( !file.open( QIODevice::WriteOnly ) ) {
+    _errorMsg = QStringLiteral( "The row index could not be saved: %1" ).arg( file.fileName() );
+    return false;
+  }
+
+  QDataStream stream( &file );
+  stream.setByteOrder( QDataStream::LittleEndian );
+
+  QCsvSidecarHeader::write( stream, indexMagic, indexVersion, _fileSize, _lastModified );
+  stream << _dataStart << qint32( _offsets.count() );
+
+  QVector<qint64> offsets( _offsets.count() );
+  for( int i = 0; i < _offsets.count(); ++i )
+    offsets[i] = qToLittleEndian( _offsets.at(i) );
+
+  for( int first = 0; first < offsets.count(); first = first + chunkRows ) {
+    const int nBytes = qMin( chunkRows, offsets.count() - first ) * int( sizeof( qint64 ) );
+    stream.writeRawData( reinterpret_cast<const char*>( offsets.constData() + first ), nBytes );
+  }
+
+  if( ( QDataStream::Ok != stream.status() ) || !file.commit() ) {
+    _errorMsg = QStringLiteral( "The row index could not be saved: %1" ).arg( file.fileName() );
+    return false;
+  }
+
+  return true;
+}
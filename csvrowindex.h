@@ -0,0 +1,66 @@
+/*
+csvrowindex.h/cpp
+-----------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVROWINDEX_H
+#define CSVROWINDEX_H
+
+#include <QtCore>
+
+/* The position in a CSV file at which each row of data starts.
+ *
+ * An index is built in a single pass over the file, reading it in large blocks, and may be saved
+ * in a small binary file next to the CSV file (e.g. data.csv.rowidx).  A saved index records the size
+ * and modification time of the CSV file, and is ignored once either of these has changed.
+ *
+ * Rows follow the same rules as QCsv: line breaks inside quotation marks don't end a row, and a blank
+ * line marks the end of the data.
+ *
+ * There should be little reason to use this class directly: see QCsv::useRowIndex().
+ */
+class QCsvRowIndex {
+  public:
+    QCsvRowIndex();
+    QCsvRowIndex( const QCsvRowIndex& other );
+    QCsvRowIndex& operator=( const QCsvRowIndex& other );
+    ~QCsvRowIndex() { /* Nothing to do here */ }
+
+    void clear();
+
+    // Indexes the rows of csvFileName that start at or after dataStart (i.e. after any header).
+    bool build( const QString& csvFileName, const qint64 dataStart );
+
+    // Reads a saved index.  Returns false if there isn't one, or if it's out of date.
+    bool load( const QString& csvFileName, const qint64 dataStart );
+    bool save() const;
+
+    static QString indexFileName( const QString& csvFileName ) { return csvFileName + QStringLiteral(".rowidx"); }
+
+    bool isValid() const { return !_csvFileName.isEmpty(); }
+    int nRows() const { return _offsets.count(); }
+    qint64 offset( const int row ) const { return _offsets.at( row ); }
+
+    QString errorMsg() const { return _errorMsg; }
+
+  protected:
+    void assign( const QCsvRowIndex& other );
+
+    QString _csvFileName;
+    qint64 _fileSize;
+    qint64 _lastModified; // Milliseconds since the epoch, UTC
+    qint64 _dataStart;
+    QVector<qint64> _offsets;
+
+    mutable QString _errorMsg;
+};
+
+#endif // CSVROWINDEX_H
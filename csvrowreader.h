@@ -0,0 +1,173 @@
+/*
+csvrowreader.h
+--------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVROWREADER_H
+#define CSVROWREADER_H
+
+#include <limits>
+#include <tuple>
+
+#include <QtCore>
+
+#include <ar_general_purpose/csv.h>
+
+/* Reads a field of the current row of a QCsv object as a value of type T.  Defined for QString, qint64,
+ * int, double, QDate, and bool, with the same conversions as QCsv::field() and QCsv::fieldAsInt(), etc.
+ * Other types can be supported by adding a specialization.
+ */
+template <typename T>
+struct QCsvFieldReader;
+
+template <>
+struct QCsvFieldReader<QString> {
+  static QString read( QCsv& csv, const QCsv::FieldHandle& handle, bool* ok ) { *ok = true; return csv.field( handle ); }
+};
+
+template <>
+struct QCsvFieldReader<qint64> {
+  static qint64 read( QCsv& csv, const QCsv::FieldHandle& handle, bool* ok ) { return csv.fieldAsInt( handle, ok ); }
+};
+
+template <>
+struct QCsvFieldReader<int> {
+  static int read( QCsv& csv, const QCsv::FieldHandle& handle, bool* ok ) {
+    const qint64 result = csv.fieldAsInt( handle, ok );
+
+    if( ( result < std::numeric_limits<int>::min() ) || ( result > std::numeric_limits<int>::max() ) ) {
+      *ok = false;
+      return 0;
+    }
+
+    return int( result );
+  }
+};
+
+template <>
+struct QCsvFieldReader<double> {
+  static double read( QCsv& csv, const QCsv::FieldHandle& handle, bool* ok ) { return csv.fieldAsDouble( handle, ok ); }
+};
+
+template <>
+struct QCsvFieldReader<QDate> {
+  static QDate read( QCsv& csv, const QCsv::FieldHandle& handle, bool* ok ) { return csv.fieldAsDate( handle, ok ); }
+};
+
+template <>
+struct QCsvFieldReader<bool> {
+  static bool read( QCsv& csv, const QCsv::FieldHandle& handle, bool* ok ) { return csv.fieldAsBool( handle, ok ); }
+};
+
+
+// Fills elements [0, N) of a tuple, one field per element.  Used by QCsvRowReader.
+template <int N, typename Tuple>
+struct QCsvTupleReader {
+  static void read( QCsv& csv, const QVector<QCsv::FieldHandle>& handles, Tuple& values, bool& ok ) {
+    QCsvTupleReader<N - 1, Tuple>::read( csv, handles, values, ok );
+
+    bool fieldOk;
+    std::get<N - 1>( values ) = QCsvFieldReader< typename std::tuple_element<N - 1, Tuple>::type >::read( csv, handles.at( N - 1 ), &fieldOk );
+    ok = ( ok && fieldOk );
+  }
+};
+
+template <typename Tuple>
+struct QCsvTupleReader<0, Tuple> {
+  static void read( QCsv& csv, const QVector<QCsv::FieldHandle>& handles, Tuple& values, bool& ok ) {
+    Q_UNUSED( csv ); Q_UNUSED( handles ); Q_UNUSED( values ); Q_UNUSED( ok );
+  }
+};
+
+
+/* Reads several fields of each row of a QCsv object at once, as typed values.  Fields are located by name
+ * when the reader is constructed, so nothing is looked up by name inside the loop:
+ *
+ *   QCsv csv( fileName, true );
+ *   csv.open();
+ *
+ *   QCsvRowReader<qint64, QString, double> reader( csv, QStringList() << "herdID" << "holding" << "herdSize" );
+ *   if( !reader.isValid() )
+ *     qDb() << reader.errorMsg();
+ *
+ *   qint64 herdID;
+ *   QString holding;
+ *   double herdSize;
+ *
+ *   while( -1 != csv.moveNext() ) {
+ *     if( reader.read( herdID, holding, herdSize ) )
+ *       ...
+ *   }
+ *
+ * row() returns the same values as a std::tuple.  A row is read successfully if every field could be
+ * converted to its type (see QCsvFieldReader): empty values can't be converted to anything but a QString.
+ * The reader works with the current row of csv, in any mode, and keeps a reference to it: see also
+ * QCsv::FieldHandle for when handles become invalid.
+ */
+template <typename... Types>
+class QCsvRowReader {
+  public:
+    typedef std::tuple<Types...> Row;
+
+    QCsvRowReader( QCsv& csv, const QStringList& fieldNames ) : _csv( csv ) {
+      if( int( sizeof...( Types ) ) != fieldNames.count() ) {
+        _errorMsg = QStringLiteral( "%1 field names were given for %2 types." ).arg( fieldNames.count() ).arg( int( sizeof...( Types ) ) );
+        return;
+      }
+
+      for( int i = 0; i < fieldNames.count(); ++i ) {
+        const QCsv::FieldHandle handle = _csv.fieldHandle( fieldNames.at(i) );
+
+        if( !handle.isValid() ) {
+          _errorMsg = _csv.errorMsg();
+          _handles.clear();
+          return;
+        }
+
+        _handles.append( handle );
+      }
+    }
+
+    bool isValid() const { return ( _handles.count() == int( sizeof...( Types ) ) ); }
+    QString errorMsg() const { return _errorMsg; }
+    const QVector<QCsv::FieldHandle>& handles() const { return _handles; }
+
+    // The fields of the current row.  If ok is given, it is set to false if any field couldn't be read.
+    Row row( bool* ok = nullptr ) {
+      Row result;
+      bool success = isValid();
+
+      if( success )
+        QCsvTupleReader<int( sizeof...( Types ) ), Row>::read( _csv, _handles, result, success );
+
+      if( nullptr != ok )
+        *ok = success;
+
+      return result;
+    }
+
+    // As above, into separate variables.
+    bool read( Types&... values ) {
+      bool success;
+      std::tie( values... ) = row( &success );
+      return success;
+    }
+
+  protected:
+    QCsv& _csv;
+    QVector<QCsv::FieldHandle> _handles;
+    QString _errorMsg;
+
+  private:
+    Q_DISABLE_COPY( QCsvRowReader )
+};
+
+#endif // CSVROWREADER_H
@@ -0,0 +1,309 @@
+/*
+csvschema.h/cpp
+---------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvschema.h"
+
+#include <ar_general_purpose/qcout.h>
+
+QCsvSchema::QCsvSchema() {
+  initialize();
+}
+
+
+QCsvSchema::QCsvSchema( const QCsvSchema& other ) {
+  assign( other );
+}
+
+
+QCsvSchema& QCsvSchema::operator=( const QCsvSchema& other ) {
+  assign( other );
+  return *this;
+}
+
+
+void QCsvSchema::initialize() {
+  _rules.clear();
+  _fieldsLookup.clear();
+
+  _maxErrors = 1000;
+
+  clearResults();
+}
+
+
+void QCsvSchema::assign( const QCsvSchema& other ) {
+  _rules = other._rules;
+  _fieldsLookup = other._fieldsLookup;
+
+  _maxErrors = other._maxErrors;
+
+  _errors = other._errors;
+  _nErrors = other._nErrors;
+  _nRowsChecked = other._nRowsChecked;
+  _nInvalidRows = other._nInvalidRows;
+}
+
+
+void QCsvSchema::clear() {
+  initialize();
+}
+
+
+void QCsvSchema::clearResults() {
+  _errors.clear();
+  _nErrors = 0;
+  _nRowsChecked = 0;
+  _nInvalidRows = 0;
+}
+
+
+QStringList QCsvSchema::fieldNames() const {
+  QStringList result;
+
+  for( int i = 0; i < _rules.count(); ++i )
+    result.append( _rules.at(i).name );
+
+  return result;
+}
+
+
+QCsvSchema::FieldRule& QCsvSchema::rule( const QString& fieldName ) {
+  const QString key = fieldName.toLower();
+
+  if( !_fieldsLookup.contains( key ) ) {
+    FieldRule rule;
+    rule.name = fieldName;
+    rule.required = false;
+    rule.type = AnyType;
+    rule.dateFormat = UKDateFormat;
+    rule.hasRange = false;
+    rule.minValue = 0.0;
+    rule.maxValue = 0.0;
+    rule.allowedValuesCaseSensitive = true;
+    rule.sourceIndex = -1;
+
+    _fieldsLookup.insert( key, _rules.count() );
+    _rules.append( rule );
+  }
+
+  return _rules[ _fieldsLookup.value( key ) ];
+}
+
+
+void QCsvSchema::addField( const QString& fieldName, const bool required /* = true */ ) {
+  rule( fieldName ).required = required;
+}
+
+
+void QCsvSchema::setRequired( const QString& fieldName, const bool required ) {
+  rule( fieldName ).required = required;
+}
+
+
+void QCsvSchema::setType( const QString& fieldName, const FieldType type, const StrUtilsDateFormat dateFormat /* = UKDateFormat */ ) {
+  FieldRule& r = rule( fieldName );
+  r.type = type;
+  r.dateFormat = dateFormat;
+}
+
+
+void QCsvSchema::setRange( const QString& fieldName, const double minValue, const double maxValue ) {
+  FieldRule& r = rule( fieldName );
+  r.hasRange = true;
+  r.minValue = qMin( minValue, maxValue );
+  r.maxValue = qMax( minValue, maxValue );
+}
+
+
+bool QCsvSchema::setPattern( const QString& fieldName, const QString& pattern ) {
+  FieldRule& r = rule( fieldName );
+
+  if( pattern.isEmpty() ) {
+    r.pattern = QRegularExpression();
+    return true;
+  }
+
+  r.pattern = QRegularExpression( QStringLiteral( "\\A(?:%1)\\z" ).arg( pattern ) );
+
+  if( !r.pattern.isValid() ) {
+    r.pattern = QRegularExpression();
+    return false;
+  }
+
+  r.pattern.optimize();
+  return true;
+}
+
+
+void QCsvSchema::setAllowedValues( const QString& fieldName, const QStringList& values, const bool caseSensitive /* = true */ ) {
+  FieldRule& r = rule( fieldName );
+  r.allowedValues.clear();
+  r.allowedValuesCaseSensitive = caseSensitive;
+
+  for( int i = 0; i < values.count(); ++i )
+    r.allowedValues.insert( caseSensitive ? values.at(i) : values.at(i).toLower() );
+}
+
+
+void QCsvSchema::addError( const QString& msg, const int lineNumber ) {
+  ++_nErrors;
+
+  if( ( -1 == _maxErrors ) || ( _errors.count() < _maxErrors ) )
+    _errors.append( CError( CError::Critical, msg, -1, lineNumber ) );
+}
+
+
+// Fields are located once per file, so that each row is checked by position.
+void QCsvSchema::beginValidation( const QStringList& fieldNames, const int headerLineNumber ) {
+  QHash<QString, int> sourceIndexes;
+  for( int i = 0; i < fieldNames.count(); ++i ) {
+    const QString key = fieldNames.at(i).toLower();
+    if( !sourceIndexes.contains( key ) )
+      sourceIndexes.insert( key, i );
+  }
+
+  for( int i = 0; i < _rules.count(); ++i ) {
+    FieldRule& r = _rules[i];
+    r.sourceIndex = sourceIndexes.value( r.name.toLower(), -1 );
+
+    if( r.required && ( -1 == r.sourceIndex ) )
+      addError( QStringLiteral( "Required field '%1' is not present." ).arg( r.name ), headerLineNumber );
+  }
+}
+
+
+void QCsvSchema::validateRow( const QCsvRowBuffer& row, const int lineNumber ) {
+  ++_nRowsChecked;
+
+  bool rowIsValid = true;
+
+  for( int i = 0; i < _rules.count(); ++i ) {
+    const FieldRule& r = _rules.at(i);
+
+    if( -1 == r.sourceIndex )
+      continue;
+
+    if( r.sourceIndex < row.count() ) {
+      if( !checkValue( r, row.at( r.sourceIndex ), lineNumber ) )
+        rowIsValid = false;
+    }
+    else if( r.required ) {
+      addError( QStringLiteral( "Field '%1' is missing." ).arg( r.name ), lineNumber );
+      rowIsValid = false;
+    }
+  }
+
+  if( !rowIsValid )
+    ++_nInvalidRows;
+}
+
+
+// The cheapest checks come first, and only the first failure for a value is reported.
+bool QCsvSchema::checkValue( const FieldRule& r, const QStringRef& value, const int lineNumber ) {
+  if( value.isEmpty() ) {
+    if( r.required ) {
+      addError( QStringLiteral( "Field '%1' requires a value." ).arg( r.name ), lineNumber );
+      return false;
+    }
+    else {
+      return true;
+    }
+  }
+
+  if( !r.allowedValues.isEmpty() ) {
+    bool allowed;
+
+    if( r.allowedValuesCaseSensitive )
+      allowed = r.allowedValues.contains( QString::fromRawData( value.unicode(), value.length() ) );
+    else
+      allowed = r.allowedValues.contains( value.toString().toLower() );
+
+    if( !allowed ) {
+      addError( QStringLiteral( "Field '%1': '%2' is not an allowed value." ).arg( r.name, value.toString() ), lineNumber );
+      return false;
+    }
+  }
+
+  bool ok = true;
+  double number = 0.0;
+
+  switch( r.type ) {
+    case IntegerType:
+      number = double( fastStrToInt64( value, &ok ) );
+      if( !ok ) {
+        addError( QStringLiteral( "Field '%1': '%2' is not an integer." ).arg( r.name, value.toString() ), lineNumber );
+        return false;
+      }
+      break;
+    case DoubleType:
+      number = fastStrToDouble( value, &ok );
+      if( !ok ) {
+        addError( QStringLiteral( "Field '%1': '%2' is not a number." ).arg( r.name, value.toString() ), lineNumber );
+        return false;
+      }
+      break;
+    case DateType:
+      if( !guessDateFromString( value.toString(), r.dateFormat ).isValid() ) {
+        addError( QStringLiteral( "Field '%1': '%2' is not a date." ).arg( r.name, value.toString() ), lineNumber );
+        return false;
+      }
+      break;
+    case BoolType:
+      strToBool( value.toString(), &ok );
+      if( !ok ) {
+        addError( QStringLiteral( "Field '%1': '%2' is not a Boolean value." ).arg( r.name, value.toString() ), lineNumber );
+        return false;
+      }
+      break;
+    case AnyType:
+      break;
+  }
+
+  if( r.hasRange ) {
+    if( ( IntegerType != r.type ) && ( DoubleType != r.type ) ) {
+      number = fastStrToDouble( value, &ok );
+      if( !ok ) {
+        addError( QStringLiteral( "Field '%1': '%2' is not a number." ).arg( r.name, value.toString() ), lineNumber );
+        return false;
+      }
+    }
+
+    if( ( number < r.minValue ) || ( number > r.maxValue ) ) {
+      addError(
+        QStringLiteral( "Field '%1': %2 is outside the range %3 to %4." ).arg( r.name, value.toString(), QString::number( r.minValue ), QString::number( r.maxValue ) ),
+        lineNumber
+      );
+      return false;
+    }
+  }
+
+  if( !r.pattern.pattern().isEmpty() && !r.pattern.match( value ).hasMatch() ) {
+    addError( QStringLiteral( "Field '%1': '%2' does not match the expected pattern." ).arg( r.name, value.toString() ), lineNumber );
+    return false;
+  }
+
+  return true;
+}
+
+
+void QCsvSchema::debug() const {
+  qDb() << "QCsvSchema:";
+
+  for( int i = 0; i < _rules.count(); ++i ) {
+    const FieldRule& r = _rules.at(i);
+    qDb() << "  " << r.name << "required:" << r.required << "type:" << r.type << "range:" << r.hasRange << r.minValue << r.maxValue
+      << "pattern:" << r.pattern.pattern() << "allowed values:" << r.allowedValues.count();
+  }
+
+  qDb() << "  rows checked:" << _nRowsChecked << "invalid rows:" << _nInvalidRows << "errors:" << _nErrors;
+}
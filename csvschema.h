@@ -0,0 +1,125 @@
+/*
+csvschema.h/cpp
+---------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVSCHEMA_H
+#define CSVSCHEMA_H
+
+#include <QtCore>
+
+#include <ar_general_purpose/cerror.h>
+#include <ar_general_purpose/csv.h>
+#include <ar_general_purpose/csvrowbuffer.h>
+#include <ar_general_purpose/strutils.h>
+
+/* Describes the fields that a CSV file should contain, and checks each row against that description as the
+ * file is read by QCsv, so that every problem in a file can be reported after a single pass:
+ *
+ *   QCsvSchema schema;
+ *   schema.addField( "herdID" );
+ *   schema.setType( "herdID", QCsvSchema::IntegerType );
+ *   schema.setRange( "herdSize", 0, 100000 );
+ *   schema.setPattern( "cph", "\\d{2}/\\d{3}/\\d{4}" );
+ *   schema.setAllowedValues( "status", QStringList() << "active" << "closed", false );
+ *
+ *   QCsv csv( fileName, true );
+ *   csv.setValidator( &schema );
+ *   csv.open();
+ *
+ *   if( !schema.isValid() )
+ *     schema.errors().writeFile( errorFileName, CErrorList::ErrorFileCSV );
+ *
+ * Fields are identified by name (without regard to case), so the file must contain a field list.
+ * Each field can have any combination of rules.  A required field must be present in the file, and must
+ * have a value in every row.  Otherwise, an empty value passes every rule.
+ *
+ * Every failure is recorded as a critical CError, with the line number (see QCsv::setValidator())
+ * at which it occurred.
+ */
+class QCsvSchema : public QCsvRowValidator {
+  public:
+    enum FieldType {
+      AnyType,
+      IntegerType,
+      DoubleType,
+      DateType, // As understood by guessDateFromString()
+      BoolType  // As understood by strToBool()
+    };
+
+    QCsvSchema();
+    QCsvSchema( const QCsvSchema& other );
+    QCsvSchema& operator=( const QCsvSchema& other );
+    virtual ~QCsvSchema() { /* Nothing to do here */ }
+
+    // Rules.  Setting any rule for a field that hasn't been added adds it as an optional field.
+    void addField( const QString& fieldName, const bool required = true );
+    void setRequired( const QString& fieldName, const bool required );
+    void setType( const QString& fieldName, const FieldType type, const StrUtilsDateFormat dateFormat = UKDateFormat );
+    void setRange( const QString& fieldName, const double minValue, const double maxValue ); // Inclusive.  Implies at least DoubleType.
+    bool setPattern( const QString& fieldName, const QString& pattern ); // The whole value must match.  False if pattern is invalid.
+    void setAllowedValues( const QString& fieldName, const QStringList& values, const bool caseSensitive = true );
+
+    bool hasField( const QString& fieldName ) const { return _fieldsLookup.contains( fieldName.toLower() ); }
+    QStringList fieldNames() const;
+    void clear(); // Removes all rules, and clears results
+
+    // No more than this many errors are kept (the rest are only counted).  Default value is 1000.  Use -1 for no limit.
+    void setMaxErrors( const int val ) { _maxErrors = val; }
+    int maxErrors() const { return _maxErrors; }
+
+    // Results, which accumulate until cleared: several files can be checked with the same schema.
+    const CErrorList& errors() const { return _errors; }
+    int nErrors() const { return _nErrors; } // Including those that weren't kept
+    int nRowsChecked() const { return _nRowsChecked; }
+    int nInvalidRows() const { return _nInvalidRows; }
+    bool isValid() const { return ( 0 == _nErrors ); }
+    void clearResults();
+
+    // Reimplemented from QCsvRowValidator
+    virtual void beginValidation( const QStringList& fieldNames, const int headerLineNumber );
+    virtual void validateRow( const QCsvRowBuffer& row, const int lineNumber );
+
+    void debug() const;
+
+  protected:
+    struct FieldRule {
+      QString name;
+      bool required;
+      FieldType type;
+      StrUtilsDateFormat dateFormat;
+      bool hasRange;
+      double minValue;
+      double maxValue;
+      QRegularExpression pattern;
+      QSet<QString> allowedValues;
+      bool allowedValuesCaseSensitive;
+      int sourceIndex; // Column in the row being checked, or -1 if it isn't present
+    };
+
+    void initialize();
+    void assign( const QCsvSchema& other );
+
+    FieldRule& rule( const QString& fieldName );
+    bool checkValue( const FieldRule& rule, const QStringRef& value, const int lineNumber );
+    void addError( const QString& msg, const int lineNumber );
+
+    QVector<FieldRule> _rules;
+    QHash<QString, int> _fieldsLookup; // Lower-case field name -> index in _rules
+
+    int _maxErrors;
+    CErrorList _errors;
+    int _nErrors;
+    int _nRowsChecked;
+    int _nInvalidRows;
+};
+
+#endif // CSVSCHEMA_H
@@ -0,0 +1,41 @@
+/*
+csvsidecar.h/cpp
+----------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvsidecar.h"
+
+void QCsvSidecarHeader::write( QDataStream& stream, const quint32 magic, const quint32 version, const qint64 fileSize, const qint64 lastModified ) {
+  stream << magic << version << fileSize << lastModified;
+}
+
+
+QCsvSidecarHeader::Status QCsvSidecarHeader::read( QDataStream& stream, const quint32 magic, const quint32 version, const QString& csvFileName, qint64* fileSize /* = nullptr */, qint64* lastModified /* = nullptr */ ) {
+  quint32 savedMagic, savedVersion;
+  qint64 savedFileSize, savedLastModified;
+
+  stream >> savedMagic >> savedVersion >> savedFileSize >> savedLastModified;
+
+  if( nullptr != fileSize )
+    *fileSize = savedFileSize;
+  if( nullptr != lastModified )
+    *lastModified = savedLastModified;
+
+  if( ( QDataStream::Ok != stream.status() ) || ( magic != savedMagic ) || ( version != savedVersion ) )
+    return Invalid;
+
+  const QFileInfo fi( csvFileName );
+
+  if( ( fi.size() != savedFileSize ) || ( fi.lastModified().toMSecsSinceEpoch() != savedLastModified ) )
+    return OutOfDate;
+
+  return Valid;
+}
@@ -0,0 +1,38 @@
+/*
+csvsidecar.h/cpp
+----------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVSIDECAR_H
+#define CSVSIDECAR_H
+
+#include <QtCore>
+
+/* The start of each of the small binary files that are kept next to a CSV file (see QCsvCache and
+ * QCsvRowIndex): a magic number and format version, then the size and modification time of the CSV
+ * file that the contents describe.  A file whose CSV file has since changed is out of date.
+ *
+ * These files are written with QSaveFile, so that a reader never sees one that is only half written.
+ */
+class QCsvSidecarHeader {
+  public:
+    enum Status {
+      Valid,
+      Invalid,  // Not a file of the expected kind and version, or unreadable
+      OutOfDate // The CSV file has changed since
+    };
+
+    // lastModified is in milliseconds since the epoch, UTC.  read() also returns the saved size and time, if asked.
+    static void write( QDataStream& stream, const quint32 magic, const quint32 version, const qint64 fileSize, const qint64 lastModified );
+    static Status read( QDataStream& stream, const quint32 magic, const quint32 version, const QString& csvFileName, qint64* fileSize = nullptr, qint64* lastModified = nullptr );
+};
+
+#endif // CSVSIDECAR_H
@@ -0,0 +1,527 @@
+/*
+csvsorter.h/cpp
+---------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvsorter.h"
+
+#include <algorithm>
+
+//---------------------------------------------------------------------------------------
+// Helpers for comparing rows
+//---------------------------------------------------------------------------------------
+namespace {
+  enum KeyRank {
+    EmptyRank,
+    NumberRank,
+    TextRank
+  };
+
+
+  int compareKeys( const QVector<QCsvSorter::KeyValue>& a, const QVector<QCsvSorter::KeyValue>& b, const QVector<bool>& descending ) {
+    for( int i = 0; i < a.count(); ++i ) {
+      const QCsvSorter::KeyValue& x = a.at(i);
+      const QCsvSorter::KeyValue& y = b.at(i);
+      int cmp;
+
+      if( x.rank != y.rank )
+        cmp = ( x.rank < y.rank ) ? -1 : 1;
+      else if( NumberRank == x.rank )
+        cmp = ( x.number < y.number ) ? -1 : ( ( y.number < x.number ) ? 1 : 0 );
+      else
+        cmp = x.text.compare( y.text );
+
+      if( 0 != cmp )
+        return ( descending.at(i) ? -cmp : cmp );
+    }
+
+    return 0;
+  }
+
+
+  // Orders the rows held in memory, for std::stable_sort().
+  class RowLess {
+    public:
+      RowLess( const QVector<QCsvSorter::Row>& rows, const QVector<bool>& descending ) : _rows( rows ), _descending( descending ) { /* Nothing else to do here */ }
+
+      bool operator()( const int a, const int b ) const {
+        return ( 0 > compareKeys( _rows.at(a).key, _rows.at(b).key, _descending ) );
+      }
+
+    protected:
+      const QVector<QCsvSorter::Row>& _rows;
+      const QVector<bool>& _descending;
+  };
+
+
+  // Orders the current rows of the runs being merged, for use with a heap.  std::push_heap() and
+  // friends put the greatest element first, so this returns true if the row from run a should come
+  // AFTER the row from run b.  Ties go to the earlier run, which keeps the merge stable.
+  class RunGreater {
+    public:
+      RunGreater( const QVector<QCsvSorter::Row>& rows, const QVector<bool>& descending ) : _rows( rows ), _descending( descending ) { /* Nothing else to do here */ }
+
+      bool operator()( const int a, const int b ) const {
+        const int cmp = compareKeys( _rows.at(a).key, _rows.at(b).key, _descending );
+        return ( ( 0 < cmp ) || ( ( 0 == cmp ) && ( a > b ) ) );
+      }
+
+    protected:
+      const QVector<QCsvSorter::Row>& _rows;
+      const QVector<bool>& _descending;
+  };
+
+
+  // A rough estimate of the memory used by a row held for sorting.
+  qint64 rowBytes( const QCsvSorter::Row& row ) {
+    qint64 result = 64 + ( row.key.count() * qint64( sizeof( QCsvSorter::KeyValue ) ) );
+
+    for( int i = 0; i < row.values.count(); ++i ) {
+      result = result + 32 + ( 2 * row.values.at(i).size() );
+    }
+
+    return result;
+  }
+
+
+  // Rows are written as by CSV::writeLine(), except that values with quote marks are always quoted as well:
+  // temporary runs are read back by QCsv, which would otherwise lose the doubled quote marks.
+  QString sortedLine( const QStringList& values, const QChar delimiter ) {
+    QString result;
+
+    for( int i = 0; i < values.count(); ++i ) {
+      QString value = values.at(i);
+
+      if( 0 < i )
+        result.append( delimiter );
+
+      const bool hasQuote = value.contains( QLatin1Char( '"' ) );
+      value.replace( QLatin1String("\""), QLatin1String("\"\"") );
+
+      bool needsQuotes = hasQuote || value.contains( delimiter );
+      for( int j = 0; !needsQuotes && ( j < value.length() ); ++j )
+        needsQuotes = value.at(j).isSpace();
+
+      if( needsQuotes )
+        result.append( QLatin1Char( '"' ) ).append( value ).append( QLatin1Char( '"' ) );
+      else
+        result.append( value );
+    }
+
+    return result;
+  }
+}
+//---------------------------------------------------------------------------------------
+
+
+QCsvSorter::QCsvSorter() {
+  _delimiter = ',';
+  _containsFieldList = true;
+  _memoryBudget = 256 * 1024 * 1024;
+  _maxMergeFiles = 64;
+  _distinct = false;
+  _tempPath = QDir::tempPath();
+
+  _error = QCsv::ERROR_NONE;
+  _errorMsg = QStringLiteral("(No error)");
+  _nRowsRead = 0;
+  _nRowsWritten = 0;
+  _nRuns = 0;
+  _hasLastWritten = false;
+}
+
+
+QCsvSorter::~QCsvSorter() {
+  removeTempFiles();
+}
+
+
+void QCsvSorter::addKey( const int fieldIdx, const Qt::SortOrder order /* = Qt::AscendingOrder */ ) {
+  _keys.append( QCsv::SortKey( fieldIdx, order ) );
+}
+
+
+void QCsvSorter::addKey( const QString& fieldName, const Qt::SortOrder order /* = Qt::AscendingOrder */ ) {
+  _keyNames.insert( _keys.count(), fieldName );
+  _keys.append( QCsv::SortKey( -1, order ) );
+}
+
+
+// Looks up keys given by name, once the input file is open.
+bool QCsvSorter::resolveKeys( QCsv* csv ) {
+  QHash<int, QString>::const_iterator it;
+
+  for( it = _keyNames.constBegin(); it != _keyNames.constEnd(); ++it ) {
+    const int idx = csv->fieldIndexOf( it.value() );
+
+    if( -1 == idx ) {
+      setError( QCsv::ERROR_INVALID_FIELD_NAME, "Invalid Field Name: " + it.value() );
+      return false;
+    }
+
+    _keys[it.key()].field = idx;
+  }
+
+  return true;
+}
+
+
+// Builds the sort key for a row of values.
+bool QCsvSorter::makeRow( const QStringList& values, Row& row ) {
+  const int nKeys = _keys.isEmpty() ? values.count() : _keys.count();
+  const int nExtra = _distinct ? values.count() : 0;
+
+  // The comparison rules are set up with the first row.
+  if( _descending.isEmpty() ) {
+    for( int i = 0; i < nKeys; ++i ) {
+      _descending.append( !_keys.isEmpty() && ( Qt::DescendingOrder == _keys.at(i).order ) );
+      _textOnly.append( false );
+    }
+    for( int i = 0; i < nExtra; ++i ) {
+      _descending.append( false );
+      _textOnly.append( true );
+    }
+  }
+
+  if( ( nKeys + nExtra ) != _descending.count() ) {
+    setError( QCsv::ERROR_INVALID_FIELD_COUNT, QStringLiteral( "Row %1 has %2 fields, which does not match earlier rows." ).arg( _nRowsRead + 1 ).arg( values.count() ) );
+    return false;
+  }
+
+  row.values = values;
+  row.key.resize( nKeys + nExtra );
+
+  for( int i = 0; i < row.key.count(); ++i ) {
+    int field;
+    if( i >= nKeys )
+      field = i - nKeys;
+    else if( _keys.isEmpty() )
+      field = i;
+    else
+      field = _keys.at(i).field;
+
+    if( ( 0 > field ) || ( values.count() <= field ) ) {
+      setError( QCsv::ERROR_INDEX_OUT_OF_RANGE, QStringLiteral( "There is no column %1" ).arg( field ) );
+      return false;
+    }
+
+    KeyValue& kv = row.key[i];
+    kv.text = values.at( field );
+    kv.number = 0.0;
+
+    if( _textOnly.at(i) ) {
+      kv.rank = TextRank;
+    }
+    else if( kv.text.isEmpty() ) {
+      kv.rank = EmptyRank;
+    }
+    else {
+      bool ok;
+      kv.number = kv.text.toDouble( &ok );
+      kv.rank = ( ( ok && !qIsNaN( kv.number ) ) ? NumberRank : TextRank );
+    }
+  }
+
+  return true;
+}
+
+
+QString QCsvSorter::newTempFile() {
+  QTemporaryFile file( QDir( _tempPath ).filePath( QStringLiteral("qcsvsort_XXXXXX.tmp") ) );
+  file.setAutoRemove( false );
+
+  if( !file.open() ) {
+    setError( QCsv::ERROR_OPEN, QStringLiteral( "Could not create a temporary file in %1" ).arg( _tempPath ) );
+    return QString();
+  }
+
+  _tempFiles.append( file.fileName() );
+  return file.fileName();
+}
+
+
+void QCsvSorter::removeTempFiles() {
+  for( int i = 0; i < _tempFiles.count(); ++i ) {
+    QFile::remove( _tempFiles.at(i) );
+  }
+
+  _tempFiles.clear();
+}
+
+
+bool QCsvSorter::writeRow( QTextStream* out, const QStringList& values ) {
+  if( _distinct ) {
+    if( _hasLastWritten && ( values == _lastWritten ) )
+      return true;
+
+    _lastWritten = values;
+    _hasLastWritten = true;
+  }
+
+  // A single empty field would otherwise be written as a blank line, which QCsv treats as the end of the data.
+  if( ( 1 == values.count() ) && values.at(0).isEmpty() )
+    *out << "\"\"";
+  else
+    *out << sortedLine( values, _delimiter );
+
+  *out << "\r\n";
+
+  if( QTextStream::Ok != out->status() ) {
+    setError( QCsv::ERROR_OTHER, QStringLiteral("Could not write to output file.") );
+    return false;
+  }
+
+  ++_nRowsWritten;
+  return true;
+}
+
+
+// Sorts the rows held in memory and writes them to a new temporary file.
+bool QCsvSorter::writeRun( QVector<Row>& rows ) {
+  const QString filename = newTempFile();
+  if( filename.isEmpty() )
+    return false;
+
+  QFile file( filename );
+  if( !file.open( QIODevice::WriteOnly ) ) {
+    setError( QCsv::ERROR_OPEN, QStringLiteral( "Could not open temporary file %1" ).arg( filename ) );
+    return false;
+  }
+
+  QTextStream out( &file );
+  out.setCodec( "UTF-8" );
+
+  QVector<int> order( rows.count() );
+  for( int i = 0; i < rows.count(); ++i ) {
+    order[i] = i;
+  }
+  std::stable_sort( order.begin(), order.end(), RowLess( rows, _descending ) );
+
+  // Duplicates within a run can be dropped now.  Others will be dropped during the merge.
+  _hasLastWritten = false;
+  for( int i = 0; i < order.count(); ++i ) {
+    if( !writeRow( &out, rows.at( order.at(i) ).values ) )
+      return false;
+  }
+
+  out.flush();
+  file.close();
+  rows.clear();
+
+  ++_nRuns;
+  return true;
+}
+
+
+// Merges sorted runs (in order) into out.
+bool QCsvSorter::mergeRuns( const QStringList& runs, QTextStream* out ) {
+  QVector<QCsv*> sources( runs.count() );
+  QVector<Row> current( runs.count() );
+  QVector<int> heap;
+  bool result = true;
+
+  for( int i = 0; i < runs.count(); ++i ) {
+    sources[i] = new QCsv( runs.at(i), false, true, QCsv::LineByLine );
+    sources[i]->setDelimiter( _delimiter );
+
+    if( !sources[i]->open() ) {
+      setError( sources[i]->error(), sources[i]->errorMsg() );
+      result = false;
+    }
+  }
+
+  RunGreater greater( current, _descending );
+
+  // Start with the first row of each run.
+  for( int i = 0; result && ( i < runs.count() ); ++i ) {
+    if( -1 != sources.at(i)->moveNext() ) {
+      result = makeRow( sources.at(i)->rowData(), current[i] );
+      heap.append( i );
+      std::push_heap( heap.begin(), heap.end(), greater );
+    }
+  }
+
+  _hasLastWritten = false;
+
+  while( result && !heap.isEmpty() ) {
+    std::pop_heap( heap.begin(), heap.end(), greater );
+    const int i = heap.takeLast();
+
+    result = writeRow( out, current.at(i).values );
+
+    if( result && ( -1 != sources.at(i)->moveNext() ) ) {
+      result = makeRow( sources.at(i)->rowData(), current[i] );
+      heap.append( i );
+      std::push_heap( heap.begin(), heap.end(), greater );
+    }
+  }
+
+  for( int i = 0; i < sources.count(); ++i ) {
+    if( result && ( QCsv::ERROR_NONE != sources.at(i)->error() ) ) {
+      setError( sources.at(i)->error(), sources.at(i)->errorMsg() );
+      result = false;
+    }
+
+    sources.at(i)->close();
+    delete sources.at(i);
+  }
+
+  return result;
+}
+
+
+bool QCsvSorter::sort( const QString& inFilename, const QString& outFilename ) {
+  _error = QCsv::ERROR_NONE;
+  _errorMsg = QStringLiteral("(No error)");
+  _nRowsRead = 0;
+  _nRowsWritten = 0;
+  _nRuns = 0;
+  _descending.clear();
+  _textOnly.clear();
+  _hasLastWritten = false;
+  removeTempFiles();
+
+  // Read the input, writing sorted runs whenever the memory budget is used up.
+  //---------------------------------------------------------------------------
+  QCsv csv( inFilename, _containsFieldList, true, QCsv::LineByLine );
+  csv.setDelimiter( _delimiter );
+
+  if( !csv.open() ) {
+    setError( csv.error(), csv.errorMsg() );
+    return false;
+  }
+
+  if( !resolveKeys( &csv ) ) {
+    csv.close();
+    return false;
+  }
+
+  QVector<Row> rows;
+  qint64 bytes = 0;
+  bool ok = true;
+
+  while( ok && ( -1 != csv.moveNext() ) ) {
+    Row row;
+    ok = makeRow( csv.rowData(), row );
+
+    if( ok ) {
+      ++_nRowsRead;
+      bytes = bytes + rowBytes( row );
+      rows.append( row );
+
+      if( bytes >= _memoryBudget ) {
+        ok = writeRun( rows );
+        bytes = 0;
+      }
+    }
+  }
+
+  if( ok && ( QCsv::ERROR_NONE != csv.error() ) ) {
+    setError( csv.error(), csv.errorMsg() );
+    ok = false;
+  }
+
+  const QStringList fieldNames = csv.fieldNames();
+  csv.close();
+
+  // If there are runs on disk, the remaining rows become one more, so that everything can be merged.
+  if( ok && ( 0 < _nRuns ) && !rows.isEmpty() ) {
+    ok = writeRun( rows );
+  }
+
+  // Merge runs until few enough remain to be merged straight into the output.
+  //---------------------------------------------------------------------------
+  QStringList runs = _tempFiles;
+
+  while( ok && ( runs.count() > _maxMergeFiles ) ) {
+    QStringList merged;
+
+    for( int first = 0; ok && ( first < runs.count() ); first = first + _maxMergeFiles ) {
+      const QStringList group = runs.mid( first, _maxMergeFiles );
+
+      if( 1 == group.count() ) {
+        merged.append( group.first() );
+        continue;
+      }
+
+      const QString filename = newTempFile();
+      QFile file( filename );
+      ok = ( !filename.isEmpty() && file.open( QIODevice::WriteOnly ) );
+
+      if( !ok ) {
+        if( QCsv::ERROR_NONE == _error )
+          setError( QCsv::ERROR_OPEN, QStringLiteral( "Could not open temporary file %1" ).arg( filename ) );
+      }
+      else {
+        QTextStream out( &file );
+        out.setCodec( "UTF-8" );
+        ok = mergeRuns( group, &out );
+        out.flush();
+        file.close();
+
+        merged.append( filename );
+
+        // Runs that have been merged are no longer needed.
+        for( int i = 0; i < group.count(); ++i ) {
+          QFile::remove( group.at(i) );
+          _tempFiles.removeAll( group.at(i) );
+        }
+      }
+    }
+
+    runs = merged;
+  }
+
+  // Write the output
+  //-----------------
+  if( ok ) {
+    QFile file( outFilename );
+
+    if( !file.open( QIODevice::WriteOnly ) ) {
+      setError( QCsv::ERROR_OPEN, QStringLiteral( "Could not open output file %1" ).arg( outFilename ) );
+      ok = false;
+    }
+    else {
+      QTextStream out( &file );
+      out.setCodec( "UTF-8" );
+
+      // Only rows written from here on are counted.
+      _nRowsWritten = 0;
+
+      if( _containsFieldList ) {
+        out << sortedLine( fieldNames, _delimiter ) << "\r\n";
+      }
+
+      if( 0 == _nRuns ) {
+        // Everything fit in memory.
+        QVector<int> order( rows.count() );
+        for( int i = 0; i < rows.count(); ++i ) {
+          order[i] = i;
+        }
+        std::stable_sort( order.begin(), order.end(), RowLess( rows, _descending ) );
+
+        for( int i = 0; ok && ( i < order.count() ); ++i ) {
+          ok = writeRow( &out, rows.at( order.at(i) ).values );
+        }
+      }
+      else {
+        ok = mergeRuns( runs, &out );
+      }
+
+      out.flush();
+      file.close();
+    }
+  }
+
+  removeTempFiles();
+
+  return ok;
+}
@@ -0,0 +1,140 @@
+/*
+csvsorter.h/cpp
+---------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVSORTER_H
+#define CSVSORTER_H
+
+#include <QtCore>
+
+#include <ar_general_purpose/csv.h>
+
+/* Sorts (and optionally removes duplicate rows from) CSV files that are too large to be held in memory.
+ *
+ * QCsv::sorted() and QCsv::distinct() need the whole file in memory (EntireFile mode).  This class
+ * instead reads the file line by line, sorts as many rows at a time as fit in the memory budget,
+ * and writes each sorted batch (a "run") to a temporary file.  The runs are then merged into the
+ * output file.  If there are very many runs, they are merged in several passes.
+ *
+ * Sorts are stable: rows with equal keys stay in the order in which they appear in the input file.
+ * Values that are numbers are compared as numbers, and come after empty values but before any
+ * other text, which is compared as text.
+ *
+ * If distinct() is true, rows that are identical to another row are dropped.  To make duplicates
+ * adjacent, rows with equal keys are ordered by the text of all of their fields rather than
+ * by their position in the input file.
+ *
+ * Basic use:
+ *   QCsvSorter sorter;
+ *   sorter.addKey( "herdID" );
+ *   sorter.addKey( "date", Qt::DescendingOrder );
+ *   sorter.setMemoryBudget( 512 * 1024 * 1024 );
+ *   if( !sorter.sort( "huge.csv", "huge-sorted.csv" ) )
+ *     qDebug() << sorter.errorMsg();
+ */
+class QCsvSorter {
+  public:
+    QCsvSorter();
+    ~QCsvSorter();
+
+    // Properties of the input file.  Defaults are a comma delimiter and a header row with field names.
+    // If there are field names, they will also be written to the output file.
+    void setDelimiter( const QChar val ) { _delimiter = val; }
+    QChar delimiter() const { return _delimiter; }
+    void setContainsFieldList( const bool val ) { _containsFieldList = val; }
+    bool containsFieldList() const { return _containsFieldList; }
+
+    // Fields to sort on, in order of priority.  If no keys are given, rows are sorted on all of their
+    // fields, from first to last.  Keys given by name are looked up when the input file is opened.
+    void addKey( const int fieldIdx, const Qt::SortOrder order = Qt::AscendingOrder );
+    void addKey( const QString& fieldName, const Qt::SortOrder order = Qt::AscendingOrder );
+    void clearKeys() { _keys.clear(); _keyNames.clear(); }
+
+    // Approximately how much memory, in bytes, may be used to hold rows while sorting.  Default is 256 MB.
+    void setMemoryBudget( const qint64 val ) { _memoryBudget = qMax( qint64( 1024 ), val ); }
+    qint64 memoryBudget() const { return _memoryBudget; }
+
+    // The maximum number of temporary files to merge at once.  Default is 64.
+    void setMaxMergeFiles( const int val ) { _maxMergeFiles = qMax( 2, val ); }
+    int maxMergeFiles() const { return _maxMergeFiles; }
+
+    // If true, rows that exactly match an earlier row are not written.  Default is false.
+    void setDistinct( const bool val ) { _distinct = val; }
+    bool distinct() const { return _distinct; }
+
+    // Where temporary files are written.  Default is QDir::tempPath().
+    void setTempPath( const QString& val ) { _tempPath = val; }
+    QString tempPath() const { return _tempPath; }
+
+    // Sorts inFilename and writes the result to outFilename, which should be a different file.
+    bool sort( const QString& inFilename, const QString& outFilename );
+
+    QCsv::CSVErrorCode error() const { return _error; }
+    QString errorMsg() const { return _errorMsg; }
+
+    // Statistics from the last call to sort()
+    qint64 nRowsRead() const { return _nRowsRead; }
+    qint64 nRowsWritten() const { return _nRowsWritten; }
+    int nRuns() const { return _nRuns; } // The number of sorted runs written to temporary files (0 if everything fit in memory)
+
+    // Used internally, to compare rows.
+    struct KeyValue {
+      int rank; // Empty values come first, then numbers, then other text.
+      double number;
+      QString text;
+    };
+
+    struct Row {
+      QStringList values;
+      QVector<KeyValue> key;
+    };
+
+  protected:
+    void setError( const QCsv::CSVErrorCode error, const QString& msg ) { _error = error; _errorMsg = msg; }
+
+    bool resolveKeys( QCsv* csv );
+    bool makeRow( const QStringList& values, Row& row );
+
+    bool writeRun( QVector<Row>& rows );
+    bool mergeRuns( const QStringList& runs, QTextStream* out );
+    bool writeRow( QTextStream* out, const QStringList& values ); // Also counts rows in _nRowsWritten
+
+    QString newTempFile();
+    void removeTempFiles();
+
+    QChar _delimiter;
+    bool _containsFieldList;
+    QList<QCsv::SortKey> _keys;
+    QHash<int, QString> _keyNames; // Keys (by position in _keys) that were given by name
+    qint64 _memoryBudget;
+    int _maxMergeFiles;
+    bool _distinct;
+    QString _tempPath;
+
+    QCsv::CSVErrorCode _error;
+    QString _errorMsg;
+    qint64 _nRowsRead;
+    qint64 _nRowsWritten;
+    int _nRuns;
+
+    // State used during a sort
+    QVector<bool> _descending;   // One per entry in each row's key
+    QVector<bool> _textOnly;     // As above: compare these entries as text, even if they are numbers
+    QStringList _tempFiles;
+    QStringList _lastWritten;
+    bool _hasLastWritten;
+
+  private:
+    Q_DISABLE_COPY( QCsvSorter )
+};
+
+#endif // CSVSORTER_H
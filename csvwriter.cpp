@@ -0,0 +1,475 @@
+/*
+csvwriter.h/cpp
+---------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "csvwriter.h"
+
+#include <ar_general_purpose/compressedio.h>
+
+QCsvWriter::QCsvWriter() {
+  _delimiter = ',';
+  _lineEnding = QStringLiteral("\r\n");
+  _bufferSize = 1024 * 1024;
+  _legacyQuoting = false;
+
+  _device = nullptr;
+  _file = nullptr;
+  _compressor = nullptr;
+  _codec = nullptr;
+  _codecState.flags = QTextCodec::IgnoreHeader;
+
+  _used = 0;
+  _atRowStart = true;
+
+  _error = QCsv::ERROR_NONE;
+  _nRowsWritten = 0;
+}
+
+
+QCsvWriter::~QCsvWriter() {
+  close();
+}
+
+
+bool QCsvWriter::open( const QString& filename, const QIODevice::OpenMode mode /* = QIODevice::WriteOnly */ ) {
+  close();
+
+  // Files named *.gz or *.zst are compressed.  Any text-mode translation is done before compression.
+  const CompressionFormat compression = compressionFormatForFileName( filename );
+
+  if( ( NoCompression != compression ) && !compressionSupported( compression ) ) {
+    setError( QCsv::ERROR_OPEN, QStringLiteral( "Support for %1 compression is not available: %2" ).arg( compressionFormatName( compression ), filename ) );
+    return false;
+  }
+
+  _file = new QFile( filename );
+  if( !_file->open( ( NoCompression == compression ) ? mode : ( mode & ~QIODevice::Text ) ) ) {
+    setError( QCsv::ERROR_OPEN, QStringLiteral( "File could not be opened for writing: %1" ).arg( filename ) );
+    delete _file;
+    _file = nullptr;
+    return false;
+  }
+
+  if( NoCompression == compression ) {
+    _device = _file;
+  }
+  else {
+    _compressor = new QCompressingWriter( _file, compression );
+    if( !_compressor->open( QIODevice::WriteOnly | ( mode & QIODevice::Text ) ) ) {
+      setError( QCsv::ERROR_OPEN, QStringLiteral( "Compressed file could not be opened for writing: %1 (%2)" ).arg( filename, _compressor->errorString() ) );
+      delete _compressor;
+      _compressor = nullptr;
+      _file->close();
+      delete _file;
+      _file = nullptr;
+      return false;
+    }
+
+    _device = _compressor;
+  }
+
+  return start();
+}
+
+
+bool QCsvWriter::open( QIODevice* device ) {
+  close();
+
+  if( ( nullptr == device ) || !device->isWritable() ) {
+    setError( QCsv::ERROR_OPEN, QStringLiteral( "Device is not open for writing." ) );
+    return false;
+  }
+
+  _device = device;
+
+  return start();
+}
+
+
+bool QCsvWriter::start() {
+  _error = QCsv::ERROR_NONE;
+  _errorMsg.clear();
+  _nRowsWritten = 0;
+  _atRowStart = true;
+  _used = 0;
+
+  if( _codecName.isEmpty() )
+    _codec = QTextCodec::codecForLocale();
+  else
+    _codec = QTextCodec::codecForName( _codecName.toLatin1() );
+
+  if( nullptr == _codec ) {
+    setError( QCsv::ERROR_OPEN, QStringLiteral( "Unrecognized codec: %1" ).arg( _codecName ) );
+    close();
+    return false;
+  }
+
+  // UTF-8 is encoded directly into the buffer.  Other encodings go through the codec.
+  if( 106 == _codec->mibEnum() ) {
+    _codec = nullptr;
+    _delimiterBytes = QString( _delimiter ).toUtf8();
+    _lineEndingBytes = _lineEnding.toUtf8();
+  }
+  else {
+    _codecState.flags = QTextCodec::IgnoreHeader;
+    _codecState.remainingChars = 0;
+    _codecState.invalidChars = 0;
+    _codecState.state_data[0] = _codecState.state_data[1] = _codecState.state_data[2] = 0;
+    _delimiterBytes = _codec->fromUnicode( &_delimiter, 1, &_codecState );
+    _lineEndingBytes = _codec->fromUnicode( _lineEnding.constData(), _lineEnding.size(), &_codecState );
+  }
+
+  if( _buffer.size() != _bufferSize )
+    _buffer.resize( _bufferSize );
+
+  return true;
+}
+
+
+bool QCsvWriter::flush() {
+  if( nullptr == _device )
+    return false;
+
+  if( 0 < _used ) {
+    const qint64 written = _device->write( _buffer.constData(), _used );
+    _used = 0;
+
+    if( -1 == written ) {
+      setError( QCsv::ERROR_OTHER, QStringLiteral( "Could not write to file: %1" ).arg( _device->errorString() ) );
+      return false;
+    }
+  }
+
+  return ( QCsv::ERROR_NONE == _error );
+}
+
+
+bool QCsvWriter::close() {
+  if( nullptr == _device )
+    return false;
+
+  // A partial row is finished off rather than lost.
+  if( !_atRowStart )
+    endRow();
+
+  bool result = flush();
+
+  // Finishing the compressed stream writes whatever the compressor still holds.
+  if( nullptr != _compressor ) {
+    _compressor->close();
+
+    if( !_compressor->compressionError().isEmpty() ) {
+      if( result )
+        setError( QCsv::ERROR_OTHER, QStringLiteral( "Could not write compressed file: %1" ).arg( _compressor->compressionError() ) );
+      result = false;
+    }
+
+    delete _compressor;
+    _compressor = nullptr;
+  }
+
+  if( nullptr != _file ) {
+    _file->close();
+    delete _file;
+    _file = nullptr;
+  }
+
+  _device = nullptr;
+
+  return result;
+}
+
+
+void QCsvWriter::reserve( const int nBytes ) {
+  if( _used + nBytes > _buffer.size() ) {
+    flush();
+
+    if( nBytes > _buffer.size() )
+      _buffer.resize( nBytes );
+  }
+}
+
+
+void QCsvWriter::appendBytes( const QByteArray& bytes ) {
+  appendAscii( bytes.constData(), bytes.size() );
+}
+
+
+void QCsvWriter::appendAscii( const char* chars, const int len ) {
+  reserve( len );
+  memcpy( _buffer.data() + _used, chars, size_t( len ) );
+  _used = _used + len;
+}
+
+
+void QCsvWriter::startField() {
+  if( _atRowStart )
+    _atRowStart = false;
+  else
+    appendBytes( _delimiterBytes );
+}
+
+
+// Quote marks are left out of the test in legacy mode: see setLegacyQuoting().
+bool QCsvWriter::needsQuotes( const QChar* chars, const int len ) const {
+  const ushort delim = _delimiter.unicode();
+
+  for( int i = 0; i < len; ++i ) {
+    const ushort u = chars[i].unicode();
+
+    if( u < 0x80 ) {
+      if( ( ( '"' == u ) && !_legacyQuoting ) || ( delim == u ) || ( ' ' == u ) || ( ( '\t' <= u ) && ( u <= '\r' ) ) )
+        return true;
+    }
+    else if( ( delim == u ) || chars[i].isSpace() ) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+void QCsvWriter::writeField( const QChar* chars, const int len ) {
+  if( nullptr == _device )
+    return;
+
+  startField();
+
+  const bool quote = needsQuotes( chars, len );
+
+  if( nullptr != _codec ) {
+    // Quote marks are doubled, so the value must be copied first.  Quote marks are rare enough that this doesn't matter much.
+    // (In legacy mode, a value with quote marks may not itself be quoted.)
+    const QString val = QString::fromRawData( chars, len );
+
+    if( quote || val.contains( QLatin1Char( '"' ) ) ) {
+      QString escaped = val;
+      escaped.replace( QLatin1Char( '"' ), QLatin1String( "\"\"" ) );
+      if( quote ) {
+        escaped.prepend( QLatin1Char( '"' ) );
+        escaped.append( QLatin1Char( '"' ) );
+      }
+      appendBytes( _codec->fromUnicode( escaped.constData(), escaped.size(), &_codecState ) );
+    }
+    else {
+      appendBytes( _codec->fromUnicode( chars, len, &_codecState ) );
+    }
+
+    return;
+  }
+
+  // Encode UTF-8 straight into the buffer.  Each UTF-16 unit takes at most 3 bytes (a doubled quote mark takes 2),
+  // plus two for the surrounding quote marks.
+  reserve( 3 * len + 2 );
+  char* out = _buffer.data() + _used;
+
+  if( quote )
+    *out++ = '"';
+
+  for( int i = 0; i < len; ++i ) {
+    uint u = chars[i].unicode();
+
+    if( u < 0x80 ) {
+      if( '"' == u )
+        *out++ = '"';
+      *out++ = char( u );
+    }
+    else if( u < 0x800 ) {
+      *out++ = char( 0xC0 | ( u >> 6 ) );
+      *out++ = char( 0x80 | ( u & 0x3F ) );
+    }
+    else if( QChar::isHighSurrogate( u ) && ( i + 1 < len ) && chars[i + 1].isLowSurrogate() ) {
+      u = QChar::surrogateToUcs4( ushort( u ), chars[i + 1].unicode() );
+      ++i;
+      *out++ = char( 0xF0 | ( u >> 18 ) );
+      *out++ = char( 0x80 | ( ( u >> 12 ) & 0x3F ) );
+      *out++ = char( 0x80 | ( ( u >> 6 ) & 0x3F ) );
+      *out++ = char( 0x80 | ( u & 0x3F ) );
+    }
+    else {
+      // A lone surrogate can't be encoded: write the replacement character instead.
+      if( QChar::isSurrogate( u ) )
+        u = QChar::ReplacementCharacter;
+      *out++ = char( 0xE0 | ( u >> 12 ) );
+      *out++ = char( 0x80 | ( ( u >> 6 ) & 0x3F ) );
+      *out++ = char( 0x80 | ( u & 0x3F ) );
+    }
+  }
+
+  if( quote )
+    *out++ = '"';
+
+  _used = int( out - _buffer.constData() );
+}
+
+
+void QCsvWriter::writeField( const qint64 val ) {
+  if( nullptr == _device )
+    return;
+
+  startField();
+
+  // Digits are generated backwards into a buffer on the stack.
+  char digits[24];
+  int pos = int( sizeof( digits ) );
+  quint64 u = ( val < 0 ) ? ( quint64( 0 ) - quint64( val ) ) : quint64( val );
+
+  do {
+    digits[--pos] = char( '0' + ( u % 10 ) );
+    u = u / 10;
+  } while( 0 != u );
+
+  if( val < 0 )
+    digits[--pos] = '-';
+
+  if( nullptr == _codec )
+    appendAscii( digits + pos, int( sizeof( digits ) ) - pos );
+  else
+    appendBytes( _codec->fromUnicode( QString::fromLatin1( digits + pos, int( sizeof( digits ) ) - pos ) ) );
+}
+
+
+void QCsvWriter::writeField( const double val ) {
+  // Rendered as for typed columns in QCsvColumnStore, so that values written from either look the same.
+  // (snprintf() is not used because its decimal separator depends on the C locale.)
+  writeField( QString::number( val, 'g', QLocale::FloatingPointShortest ) );
+}
+
+
+void QCsvWriter::writeField( const QVariant& val ) {
+  if( val.isNull() ) {
+    writeField( static_cast<const QChar*>( nullptr ), 0 );
+    return;
+  }
+
+  switch( int( val.type() ) ) {
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+      writeField( val.toLongLong() );
+      break;
+    case QMetaType::Double:
+    case QMetaType::Float:
+      writeField( val.toDouble() );
+      break;
+    case QMetaType::QDateTime:
+      writeField( val.toDateTime().toString( QStringLiteral("yyyy-MM-dd hh:mm:ss") ) );
+      break;
+    default:
+      writeField( val.toString() );
+      break;
+  }
+}
+
+
+bool QCsvWriter::endRow() {
+  if( nullptr == _device )
+    return false;
+
+  appendBytes( _lineEndingBytes );
+  _atRowStart = true;
+  ++_nRowsWritten;
+
+  return ( QCsv::ERROR_NONE == _error );
+}
+
+
+bool QCsvWriter::writeRow( const QStringList& values ) {
+  for( int i = 0; i < values.count(); ++i ) {
+    const QString& val = values.at(i);
+    writeField( val.constData(), val.size() );
+  }
+
+  return endRow();
+}
+
+
+bool QCsvWriter::writeRow( const QVector<QVariant>& values ) {
+  for( int i = 0; i < values.count(); ++i ) {
+    writeField( values.at(i) );
+  }
+
+  return endRow();
+}
+
+
+bool QCsvWriter::write( QCsv& csv ) {
+  if( nullptr == _device )
+    return false;
+
+  if( !csv.isOpen() ) {
+    setError( QCsv::ERROR_OTHER, QStringLiteral( "CSV object is not open." ) );
+    return false;
+  }
+
+  if( csv.containsFieldList() )
+    writeRow( csv.fieldNames() );
+
+  if( QCsv::EntireFile == csv.mode() ) {
+    const QCsv& source = csv;
+    for( int i = 0; ( i < source.nRows() ) && ( QCsv::ERROR_NONE == _error ); ++i ) {
+      writeRow( source.rowData( i ) );
+    }
+  }
+  else {
+    while( ( QCsv::ERROR_NONE == _error ) && ( -1 != csv.moveNext() ) ) {
+      writeRow( csv.rowData() );
+    }
+
+    if( ( QCsv::ERROR_NONE == _error ) && ( QCsv::ERROR_NONE != csv.error() ) ) {
+      setError( csv.error(), csv.errorMsg() );
+    }
+  }
+
+  return ( QCsv::ERROR_NONE == _error );
+}
+
+
+#ifdef QSQL_USED
+bool QCsvWriter::write( QSqlQuery& query, const bool writeFieldNames /* = true */ ) {
+  if( nullptr == _device )
+    return false;
+
+  if( !query.isActive() ) {
+    setError( QCsv::ERROR_OTHER, QStringLiteral( "Query is not active." ) );
+    return false;
+  }
+
+  const QSqlRecord record = query.record();
+  const int nFields = record.count();
+
+  if( writeFieldNames ) {
+    for( int i = 0; i < nFields; ++i ) {
+      const QString name = record.fieldName( i );
+      writeField( name.constData(), name.size() );
+    }
+    endRow();
+  }
+
+  // Records are written one at a time, straight from the query.
+  bool more = ( query.isValid() || query.next() );
+
+  while( more && ( QCsv::ERROR_NONE == _error ) ) {
+    for( int i = 0; i < nFields; ++i ) {
+      writeField( query.value( i ) );
+    }
+    endRow();
+
+    more = query.next();
+  }
+
+  return ( QCsv::ERROR_NONE == _error );
+}
+#endif
@@ -0,0 +1,144 @@
+/*
+csvwriter.h/cpp
+---------------
+Begin: 2026-10-17
+Author: Aaron Reeves <aaron.reeves@sruc.ac.uk>
+---------------------------------------------------
+Copyright (C) 2026 Scotland's Rural College (SRUC)
+
+This program is free software; you can redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+
+#include <QtCore>
+
+#ifdef QSQL_USED
+#include <QtSql>
+#endif
+
+#include <ar_general_purpose/csv.h>
+
+class QCompressingWriter;
+
+/* Writes CSV files one row (or one field) at a time.
+ *
+ * Values are encoded straight into a reusable output buffer, which is written to the file in large
+ * blocks.  Once the buffer has been allocated, writing rows of strings in UTF-8 does not allocate
+ * any memory at all.  A value is quoted if it contains the delimiter, a quote mark, or white space,
+ * and quote marks are doubled.  See setLegacyQuoting() for the slightly different rules of
+ * CSV::writeLine().
+ *
+ * Basic use:
+ *   QCsvWriter writer;
+ *   writer.open( "output.csv" );
+ *   writer.writeRow( QStringList() << "ID" << "Name" );
+ *
+ *   while( ... ) {
+ *     writer.writeField( id );     // qint64
+ *     writer.writeField( name );   // QString
+ *     writer.endRow();
+ *   }
+ *
+ *   writer.close();
+ */
+class QCsvWriter {
+  public:
+    QCsvWriter();
+    ~QCsvWriter(); // Closes the output, if necessary.
+
+    // These should be set before open() is called.
+    void setDelimiter( const QChar val ) { _delimiter = val; } // Default is a comma.
+    QChar delimiter() const { return _delimiter; }
+    void setLineEnding( const QString& val ) { _lineEnding = val; } // Default is "\r\n".
+    QString lineEnding() const { return _lineEnding; }
+    void setCodec( const QString& codecName ) { _codecName = codecName; } // Default is the locale's codec, as for QTextStream.
+    QString codec() const { return _codecName; }
+    void setBufferSize( const int bytes ) { _bufferSize = qMax( 1024, bytes ); } // Default is 1 MB.
+    int bufferSize() const { return _bufferSize; }
+
+    // If true, values are quoted exactly as CSV::csvStringList() quotes them: quote marks are doubled, but
+    // a value is only quoted if it contains the delimiter or white space, so that a"b is written as a""b.
+    // Used by the older writers in this library, so that their output doesn't change.  Default is false.
+    void setLegacyQuoting( const bool val ) { _legacyQuoting = val; }
+    bool legacyQuoting() const { return _legacyQuoting; }
+
+    // Opens a file for writing.  Files named *.gz or *.zst are gzip- or zstd-compressed (see compressedio.h).
+    bool open( const QString& filename, const QIODevice::OpenMode mode = QIODevice::WriteOnly );
+
+    // Writes to a device that is already open.  The device is not closed or deleted by this object.
+    bool open( QIODevice* device );
+
+    bool isOpen() const { return ( nullptr != _device ); }
+    bool flush();
+    bool close();
+
+    // Writing a row one field at a time.  Fields are separated with the delimiter.  endRow() finishes the row.
+    void writeField( const QString& val ) { writeField( val.constData(), val.size() ); }
+    void writeField( const QStringRef& val ) { writeField( val.constData(), val.size() ); }
+    void writeField( const QChar* chars, const int len );
+    void writeField( const qint64 val );
+    void writeField( const int val ) { writeField( qint64( val ) ); }
+    void writeField( const double val );
+    void writeField( const QVariant& val ); // Dates/times are written as yyyy-MM-dd hh:mm:ss, as for CSpreadsheet.
+    bool endRow();
+
+    // Writing entire rows
+    bool writeRow( const QStringList& values );
+    bool writeRow( const QVector<QVariant>& values );
+
+    // Writes the field names (if there are any) and then the rows of csv, which must be open.
+    // In EntireFile mode, all rows are written.  In other modes, rows that haven't yet been read are written.
+    bool write( QCsv& csv );
+
+    #ifdef QSQL_USED
+    // Writes the field names (optionally) and then every remaining record of an active query.
+    bool write( QSqlQuery& query, const bool writeFieldNames = true );
+    #endif
+
+    QCsv::CSVErrorCode error() const { return _error; }
+    QString errorMsg() const { return _errorMsg; }
+
+    qint64 nRowsWritten() const { return _nRowsWritten; }
+
+  protected:
+    void setError( const QCsv::CSVErrorCode error, const QString& msg ) { _error = error; _errorMsg = msg; }
+
+    bool start();
+    void reserve( const int nBytes ); // Makes room for nBytes in the buffer, flushing it if necessary.
+    void appendBytes( const QByteArray& bytes );
+    void appendAscii( const char* chars, const int len );
+    void startField();
+    bool needsQuotes( const QChar* chars, const int len ) const;
+
+    QChar _delimiter;
+    QString _lineEnding;
+    QString _codecName;
+    int _bufferSize;
+    bool _legacyQuoting;
+
+    QIODevice* _device;
+    QFile* _file; // Set if this object opened the file itself.
+    QCompressingWriter* _compressor; // Set if that file is compressed.  Data are written through it to _file.
+
+    QTextCodec* _codec;  // Used only for encodings other than UTF-8
+    QTextCodec::ConverterState _codecState;
+    QByteArray _delimiterBytes;
+    QByteArray _lineEndingBytes;
+
+    QByteArray _buffer;
+    int _used;
+    bool _atRowStart;
+
+    QCsv::CSVErrorCode _error;
+    QString _errorMsg;
+    qint64 _nRowsWritten;
+
+  private:
+    Q_DISABLE_COPY( QCsvWriter )
+};
+
+#endif // CSVWRITER_H
@@ -78,8 +78,19 @@ class CTwoDArray {
 
     // Sorting, etc.
     //--------------
-    bool sortOnColumn( const int colIdx );
-    bool sortOnColumn( const QString& colName );
+    // Sorts are stable: rows with equal keys keep their original order.  Row names move with their rows.
+    // Values are compared with operator<, except that columns of strings or variants that contain only
+    // numbers are compared numerically.  For sortOnColumns(), 'orders' gives the direction of each
+    // key in turn: any keys without a direction are sorted in ascending order.
+    bool sortOnColumn( const int colIdx, const Qt::SortOrder order = Qt::AscendingOrder );
+    bool sortOnColumn( const QString& colName, const Qt::SortOrder order = Qt::AscendingOrder );
+    bool sortOnColumns( const QVector<int>& colIdxs, const QVector<Qt::SortOrder>& orders = QVector<Qt::SortOrder>() );
+
+    // The sorted order of the rows, as above, without moving anything: element i is the row that would be at position i.
+    QVector<int> sortOrder( const QVector<int>& colIdxs, const QVector<Qt::SortOrder>& orders = QVector<Qt::SortOrder>() ) const;
+
+    // Rearranges the rows in a single pass, so that row i becomes the row at rowOrder[i] (e.g. from sortOrder()).
+    void applyRowOrder( const QVector<int>& rowOrder );
 
     // Basic setter and getters
     //-------------------------
@@ -708,49 +708,163 @@ void CTwoDArray<T>::removeColumn( const QString& colName ) {
 //----------------------------------------------------------------------------------------------
 // Sorting, etc.
 //----------------------------------------------------------------------------------------------
+// Numeric sort keys: by default, values are compared with operator<.  Columns of strings or
+// variants that contain nothing but numbers (and empty values, which come first) are compared
+// as numbers instead, so that e.g. "9" comes before "10".
 template <class T>
-bool CTwoDArray<T>::sortOnColumn( const int colIdx ) {
+bool CTwoDArrayNumericKeys( const QVector<T>& /* values */, QVector<double>& /* keys */ ) {
+  return false;
+}
+
+
+inline bool CTwoDArrayNumericKeys( const QVector<QString>& values, QVector<double>& keys ) {
+  keys.resize( values.count() );
+
+  for( int i = 0; i < values.count(); ++i ) {
+    bool ok = true;
 
-  CTwoDArray<T> newArray( this->nCols(), 0 );
-  newArray.setColNames( this->colNames() );
+    if( values.at(i).isEmpty() )
+      keys[i] = -qInf();
+    else
+      keys[i] = values.at(i).toDouble( &ok );
 
-  QStringList newRowNames;
+    if( !ok || qIsNaN( keys.at(i) ) )
+      return false;
+  }
 
+  return true;
+}
+
+
+inline bool CTwoDArrayNumericKeys( const QVector<QVariant>& values, QVector<double>& keys ) {
+  keys.resize( values.count() );
 
-  QVector<T> values = this->column( colIdx );
-  QMultiHash<T, int> mhash;
   for( int i = 0; i < values.count(); ++i ) {
-    mhash.insert( values.at(i), i );
+    bool ok = true;
+
+    if( values.at(i).isNull() || ( values.at(i).toString().isEmpty() ) )
+      keys[i] = -qInf();
+    else
+      keys[i] = values.at(i).toDouble( &ok );
+
+    if( !ok || qIsNaN( keys.at(i) ) )
+      return false;
   }
 
-  QList<T> sortOrder = mhash.keys();
-  std::sort( sortOrder.begin(), sortOrder.end() );
+  return true;
+}
+
 
-  for( int i = 0; i < sortOrder.count(); ++i ) {
-    QList<int> rows = mhash.values( sortOrder.at(i) );
-    std::sort( rows.begin(), rows.end() );
-    for( int j = 0; j < rows.count(); ++j ) {
-      newArray.appendRow( this->row( rows.at(j) ) );
-      if( this->hasRowNames() ) {
-        newRowNames.append( this->rowNames().at( rows.at(j) ) );
+template <class T>
+struct CTwoDArraySortKey {
+  QVector<T> values; // One column, in row order
+  bool numeric;
+  QVector<double> numbers;
+  bool descending;
+};
+
+
+template <class T>
+class CTwoDArraySortComparator {
+  public:
+    explicit CTwoDArraySortComparator( const QVector< CTwoDArraySortKey<T> >& keys ) : _keys( keys ) { /* Nothing else to do here */ }
+
+    bool operator()( const int a, const int b ) const {
+      for( int i = 0; i < _keys.count(); ++i ) {
+        const CTwoDArraySortKey<T>& key = _keys.at(i);
+        int cmp;
+
+        if( key.numeric )
+          cmp = ( key.numbers.at(a) < key.numbers.at(b) ) ? -1 : ( ( key.numbers.at(b) < key.numbers.at(a) ) ? 1 : 0 );
+        else
+          cmp = ( key.values.at(a) < key.values.at(b) ) ? -1 : ( ( key.values.at(b) < key.values.at(a) ) ? 1 : 0 );
+
+        if( 0 != cmp )
+          return ( key.descending ? ( 0 < cmp ) : ( 0 > cmp ) );
       }
+
+      return false;
     }
+
+  protected:
+    const QVector< CTwoDArraySortKey<T> >& _keys;
+};
+
+
+template <class T>
+QVector<int> CTwoDArray<T>::sortOrder( const QVector<int>& colIdxs, const QVector<Qt::SortOrder>& orders /* = QVector<Qt::SortOrder>() */ ) const {
+  QVector<int> result( _nRows );
+  for( int r = 0; r < _nRows; ++r ) {
+    result[r] = r;
   }
 
-  newArray.updateRowNames();
-  newArray.updateColNames();
+  // _data holds rows, so each key column is gathered once from every row.
+  QVector< CTwoDArraySortKey<T> > keys( colIdxs.count() );
+  for( int i = 0; i < colIdxs.count(); ++i ) {
+    const int c = colIdxs.at(i);
+    Q_ASSERT( ( 0 <= c ) && ( c < _nCols ) );
 
-  this->assign( newArray );
+    keys[i].values.resize( _nRows );
+    for( int r = 0; r < _nRows; ++r ) {
+      keys[i].values[r] = _data.at(r).at(c);
+    }
+
+    keys[i].numeric = CTwoDArrayNumericKeys( keys.at(i).values, keys[i].numbers );
+    keys[i].descending = ( ( i < orders.count() ) && ( Qt::DescendingOrder == orders.at(i) ) );
+  }
+
+  std::stable_sort( result.begin(), result.end(), CTwoDArraySortComparator<T>( keys ) );
+
+  return result;
+}
+
+
+template <class T>
+void CTwoDArray<T>::applyRowOrder( const QVector<int>& rowOrder ) {
+  Q_ASSERT( rowOrder.count() == _nRows );
+
+  // Rows are implicitly shared, so moving them around copies no cells.
+  const QList< QVector<T> > oldData = _data;
+  for( int r = 0; r < _nRows; ++r ) {
+    _data[r] = oldData.at( rowOrder.at(r) );
+  }
+
+  if( this->hasRowNames() ) {
+    QStringList newRowNames;
+    for( int r = 0; r < _nRows; ++r ) {
+      newRowNames.append( _rowNames.at( rowOrder.at(r) ) );
+    }
+
+    _rowNames = newRowNames;
+    updateRowNames();
+  }
+}
+
+
+template <class T>
+bool CTwoDArray<T>::sortOnColumns( const QVector<int>& colIdxs, const QVector<Qt::SortOrder>& orders /* = QVector<Qt::SortOrder>() */ ) {
+  for( int i = 0; i < colIdxs.count(); ++i ) {
+    if( ( 0 > colIdxs.at(i) ) || ( _nCols <= colIdxs.at(i) ) )
+      return false;
+  }
+
+  applyRowOrder( sortOrder( colIdxs, orders ) );
 
   return true;
 }
 
+
+template <class T>
+bool CTwoDArray<T>::sortOnColumn( const int colIdx, const Qt::SortOrder order /* = Qt::AscendingOrder */ ) {
+  return sortOnColumns( QVector<int>() << colIdx, QVector<Qt::SortOrder>() << order );
+}
+
 template <class T>
-bool CTwoDArray<T>::sortOnColumn( const QString& colName ) {
+bool CTwoDArray<T>::sortOnColumn( const QString& colName, const Qt::SortOrder order /* = Qt::AscendingOrder */ ) {
   if( !_colNamesLookup.contains( colName.toLower().trimmed() ) )
     return false;
   else
-    return sortOnColumn( _colNamesLookup.value( colName.toLower().trimmed() ) );
+    return sortOnColumn( _colNamesLookup.value( colName.toLower().trimmed() ), order );
 }
 //----------------------------------------------------------------------------------------------
 
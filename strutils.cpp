@@ -13,6 +13,10 @@ Public License as published by the Free Software Foundation; either version 2 of
 
 #include "strutils.h"
 
+#include <cfloat>
+#include <limits>
+#include <type_traits>
+
 #include <qstring.h>
 #include <qstringlist.h>
 #include <qdebug.h>
@@ -235,13 +239,13 @@ bool strToBool( QString val, bool* ok /* = nullptr */ ) {
 
 bool strIsInt( const QString& str ) {
   bool ok;
-  str.toInt( &ok );
-  return ok;
+  const qint64 i = fastStrToInt64( str, &ok );
+  return ( ok && ( std::numeric_limits<int>::min() <= i ) && ( std::numeric_limits<int>::max() >= i ) );
 }
 
 bool strIsDouble( const QString& str ) {
   bool ok;
-  str.toDouble( &ok );
+  fastStrToDouble( str, &ok );
   return ok;
 }
 
@@ -253,18 +257,18 @@ bool strIsNumber( const QString& str ) {
 int strToInt( const QString& str, const int defaultVal ) {
   bool ok;
 
-  int result = str.toInt( &ok );
+  const qint64 i = fastStrToInt64( str, &ok );
 
-  if( !ok )
-    result = defaultVal;
-
-  return result;
+  if( ok && ( std::numeric_limits<int>::min() <= i ) && ( std::numeric_limits<int>::max() >= i ) )
+    return int( i );
+  else
+    return defaultVal;
 }
 
 double strToDouble( const QString& str, const double defaultVal ) {
   bool ok;
 
-  double result = str.toDouble( &ok );
+  double result = fastStrToDouble( str, &ok );
 
   if( !ok )
     result = defaultVal;
@@ -273,6 +277,219 @@ double strToDouble( const QString& str, const double defaultVal ) {
 }
 
 
+namespace {
+  // Every power of ten up to 10^22 is exactly representable as a double.
+  const double exactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  // C is char for bytes or ushort for UTF-16.  Anything that isn't a digit gives a value above 9.
+  template <typename C>
+  inline unsigned int digitValue( const C c ) {
+    return static_cast<unsigned int>( static_cast<typename std::make_unsigned<C>::type>( c ) ) - '0';
+  }
+
+  // An optional minus sign and up to 18 digits, which can't overflow.  Anything else (a plus sign, white space,
+  // more digits) is turned down, and left to Qt.
+  template <typename C>
+  bool fastParseInt64( const C* data, const int length, qint64& result ) {
+    int i = ( ( 0 < length ) && ( '-' == data[0] ) ? 1 : 0 );
+
+    if( ( i == length ) || ( 18 < length - i ) )
+      return false;
+
+    qint64 value = 0;
+
+    for( int j = i; j < length; ++j ) {
+      const unsigned int d = digitValue( data[j] );
+      if( 9 < d )
+        return false;
+      value = value * 10 + d;
+    }
+
+    result = ( 1 == i ? -value : value );
+    return true;
+  }
+
+  // Plain decimal and scientific notation, e.g. "-12.5" or "6.02e23", converted with Clinger's fast path: when the digits
+  // fit in the 53 bits of a double's mantissa and the power of ten is exact, one multiplication or division gives the
+  // correctly rounded result.  Anything else (more digits, larger exponents, "inf", white space, a plus sign, a point
+  // without a digit on each side, negative zero) is turned down, and left to Qt.
+  template <typename C>
+  bool fastParseDouble( const C* data, const int length, double& result ) {
+#if defined( FLT_EVAL_METHOD ) && ( 0 != FLT_EVAL_METHOD )
+    // With extended precision arithmetic (e.g., the x87 FPU), the multiplication could be rounded twice.
+    Q_UNUSED( data );
+    Q_UNUSED( length );
+    Q_UNUSED( result );
+    return false;
+#else
+    const bool negative = ( ( 0 < length ) && ( '-' == data[0] ) );
+    int i = ( negative ? 1 : 0 );
+
+    quint64 mantissa = 0;
+    int nDigits = 0; // Significant digits in the mantissa: leading zeros don't count.
+    int exponent = 0;
+    unsigned int d;
+
+    const int intStart = i;
+    for( ; ( i < length ) && ( 9 >= ( d = digitValue( data[i] ) ) ); ++i ) {
+      if( ( 0 < nDigits ) || ( 0 != d ) ) {
+        if( 19 == nDigits )
+          return false;
+        mantissa = mantissa * 10 + d;
+        ++nDigits;
+      }
+    }
+
+    if( i == intStart )
+      return false;
+
+    if( ( i < length ) && ( '.' == data[i] ) ) {
+      ++i;
+      const int fracStart = i;
+
+      for( ; ( i < length ) && ( 9 >= ( d = digitValue( data[i] ) ) ); ++i ) {
+        if( ( 0 < nDigits ) || ( 0 != d ) ) {
+          if( 19 == nDigits )
+            return false;
+          mantissa = mantissa * 10 + d;
+          ++nDigits;
+        }
+        --exponent;
+      }
+
+      if( i == fracStart )
+        return false;
+    }
+
+    if( ( i < length ) && ( ( 'e' == data[i] ) || ( 'E' == data[i] ) ) ) {
+      ++i;
+
+      const bool negativeExponent = ( ( i < length ) && ( '-' == data[i] ) );
+      if( ( i < length ) && ( ( '-' == data[i] ) || ( '+' == data[i] ) ) )
+        ++i;
+
+      const int expStart = i;
+      int e = 0;
+
+      for( ; ( i < length ) && ( 9 >= ( d = digitValue( data[i] ) ) ); ++i ) {
+        if( 1000 > e )
+          e = e * 10 + int( d );
+      }
+
+      if( i == expStart )
+        return false;
+
+      exponent = exponent + ( negativeExponent ? -e : e );
+    }
+
+    if( ( i != length ) || ( ( quint64( 1 ) << 53 ) < mantissa ) )
+      return false;
+
+    if( 0 == mantissa ) {
+      if( negative )
+        return false;
+      result = 0.0;
+    }
+    else if( ( -22 > exponent ) || ( 22 < exponent ) ) {
+      return false;
+    }
+    else if( 0 > exponent ) {
+      result = double( mantissa ) / exactPowersOfTen[-exponent];
+    }
+    else {
+      result = double( mantissa ) * exactPowersOfTen[exponent];
+    }
+
+    if( negative )
+      result = -result;
+
+    return true;
+#endif
+  }
+}
+
+
+qint64 fastStrToInt64( const QString& str, bool* ok /* = nullptr */ ) {
+  qint64 result;
+
+  if( fastParseInt64( str.utf16(), str.length(), result ) ) {
+    if( nullptr != ok )
+      *ok = true;
+    return result;
+  }
+
+  return str.toLongLong( ok );
+}
+
+
+double fastStrToDouble( const QString& str, bool* ok /* = nullptr */ ) {
+  double result;
+
+  if( fastParseDouble( str.utf16(), str.length(), result ) ) {
+    if( nullptr != ok )
+      *ok = true;
+    return result;
+  }
+
+  return str.toDouble( ok );
+}
+
+
+qint64 fastStrToInt64( const QStringRef& str, bool* ok /* = nullptr */ ) {
+  qint64 result;
+
+  if( fastParseInt64( reinterpret_cast<const ushort*>( str.unicode() ), str.length(), result ) ) {
+    if( nullptr != ok )
+      *ok = true;
+    return result;
+  }
+
+  return str.toLongLong( ok );
+}
+
+
+double fastStrToDouble( const QStringRef& str, bool* ok /* = nullptr */ ) {
+  double result;
+
+  if( fastParseDouble( reinterpret_cast<const ushort*>( str.unicode() ), str.length(), result ) ) {
+    if( nullptr != ok )
+      *ok = true;
+    return result;
+  }
+
+  return str.toDouble( ok );
+}
+
+
+qint64 bytesToInt64( const char* data, const int length, bool* ok /* = nullptr */ ) {
+  qint64 result;
+
+  if( fastParseInt64( data, length, result ) ) {
+    if( nullptr != ok )
+      *ok = true;
+    return result;
+  }
+
+  return QByteArray::fromRawData( data, length ).toLongLong( ok );
+}
+
+
+double bytesToDouble( const char* data, const int length, bool* ok /* = nullptr */ ) {
+  double result;
+
+  if( fastParseDouble( data, length, result ) ) {
+    if( nullptr != ok )
+      *ok = true;
+    return result;
+  }
+
+  return QByteArray::fromRawData( data, length ).toDouble( ok );
+}
+
+
 bool isNullOrEmpty( const QVariant& v ) {
   if( v.isNull() )
     return true;
@@ -383,6 +383,10 @@ bool CXlCsv::setFieldFormatXl( const int fieldIdx, const ColumnFormat fmt ) {
 
     QDate date;
 
+    // Excel date serials are rewritten in place as strings.
+    useRowStorage();
+    invalidateIndexes();
+
     if( DateFormat == fmt ) {
       for( int row = 0; row < this->rowCount(); ++row ) {
         QString str = _data.at(row).at(fieldIdx);